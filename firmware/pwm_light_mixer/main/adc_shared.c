@@ -0,0 +1,41 @@
+/**
+ * @file adc_shared.c
+ * @brief Shared ADC oneshot unit handles
+ *
+ * The oneshot driver allows one handle per ADC unit, while several sensor
+ * modules sample channels of the same unit. Each unit is created on first
+ * use and handed out to every later caller.
+ *
+ * Called from module init during boot only (single task), so no locking.
+ */
+
+#include "adc_shared.h"
+#include "esp_log.h"
+
+static const char *TAG = "ADC_SHARED";
+
+static adc_oneshot_unit_handle_t unit_handles[ADC_UNIT_2 + 1] = {NULL};
+
+/**
+ * @brief Get the oneshot handle of an ADC unit, creating it on first use
+ */
+int adc_shared_get_unit(adc_unit_t unit, adc_oneshot_unit_handle_t *handle)
+{
+    if (unit > ADC_UNIT_2 || handle == NULL) {
+        ESP_LOGE(TAG, "Invalid ADC unit or handle pointer");
+        return -1;
+    }
+
+    if (unit_handles[unit] == NULL) {
+        adc_oneshot_unit_init_cfg_t unit_config = {
+            .unit_id = unit,
+        };
+        if (adc_oneshot_new_unit(&unit_config, &unit_handles[unit]) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create ADC unit %d", unit + 1);
+            return -1;
+        }
+    }
+
+    *handle = unit_handles[unit];
+    return 0;
+}
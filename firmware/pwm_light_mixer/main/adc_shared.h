@@ -0,0 +1,8 @@
+#ifndef ADC_SHARED_H
+#define ADC_SHARED_H
+
+#include "esp_adc/adc_oneshot.h"
+
+int adc_shared_get_unit(adc_unit_t unit, adc_oneshot_unit_handle_t *handle);
+
+#endif
@@ -0,0 +1,352 @@
+/**
+ * @file bam.c
+ * @brief Binary code modulation output engine on the I2S parallel bus
+ *
+ * Drives CONFIG_BAM_CHANNELS outputs, one per data line of the I2S
+ * peripheral in parallel (i80/LCD) mode, with binary code modulation at
+ * CONFIG_BAM_BITS resolution. A period buffer holds 2^bits bus samples laid
+ * out by bam_planes; the DMA streams it at CONFIG_BAM_PCLK_HZ, so the PWM
+ * itself costs no CPU.
+ *
+ * Two period buffers: transfers are queued from the active one while the
+ * spare one is rebuilt. A rebuild happens only after a commit with changed
+ * duties, rewrites only the changed bit planes, and swaps buffers once the
+ * spare one has drained from the DMA queue, so a frame never tears.
+ *
+ * esp_lcd has no circular DMA mode, so each buffer holds
+ * CONFIG_BAM_PERIODS_PER_TRANSFER periods and a feeder task keeps
+ * CONFIG_BAM_QUEUE_DEPTH transfers in flight; the CPU sees one completion
+ * interrupt per transfer, not per period.
+ *
+ * The bus holds its last sample in the gap between queued transfers, so
+ * every transfer ends on one all-off word: a gap only stretches off time,
+ * instead of extending the MSB plane of every channel at 50 % or more.
+ */
+
+#include "bam.h"
+#include "bam_planes.h"
+#include "config.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char *TAG = "BAM";
+
+_Static_assert(CONFIG_BAM_CHANNELS == 8 || CONFIG_BAM_CHANNELS == 16,
+               "The i80 bus is 8 or 16 lines wide");
+_Static_assert(CONFIG_BAM_BITS <= BAM_PLANES_MAX_BITS, "Too many bit planes");
+
+static const int BAM_DATA_PINS[CONFIG_BAM_CHANNELS] = CONFIG_BAM_DATA_PINS;
+
+#define BAM_TAIL_BYTES                4                  ///< Off word ending every transfer
+
+/**
+ * ============================================================================
+ * STATE
+ * ============================================================================
+ */
+
+static esp_lcd_i80_bus_handle_t bus_handle = NULL;
+static esp_lcd_panel_io_handle_t io_handle = NULL;
+static TaskHandle_t feeder_task_handle = NULL;
+static StackType_t feeder_task_stack[CONFIG_BAM_TASK_STACK];
+static StaticTask_t feeder_task_buffer;
+
+static uint8_t *buffers[2] = { NULL, NULL };
+static bam_planes_t layouts[2];
+static size_t period_bytes = 0;
+static size_t buffer_bytes = 0;
+static uint32_t active_buffer = 0;
+
+// Transfers in flight per buffer; they complete in queue order
+static uint32_t queued_buffers[CONFIG_BAM_QUEUE_DEPTH];
+static uint32_t queue_head = 0;
+static volatile uint32_t queue_tail = 0;
+static volatile uint32_t in_flight[2] = { 0, 0 };
+
+static uint16_t staged[CONFIG_BAM_CHANNELS];
+static bool staged_dirty = false;
+
+static bam_stats_t stats = {0};
+static portMUX_TYPE bam_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+// Serializes staged duties between callers and the feeder task
+static SemaphoreHandle_t bam_mutex = NULL;
+static StaticSemaphore_t bam_mutex_buffer;
+
+/**
+ * @brief Transfer complete callback (DMA ISR context)
+ */
+static bool IRAM_ATTR bam_transfer_done(esp_lcd_panel_io_handle_t io,
+                                        esp_lcd_panel_io_event_data_t *event, void *arg)
+{
+    BaseType_t woken = pdFALSE;
+
+    portENTER_CRITICAL_ISR(&bam_spinlock);
+    in_flight[queued_buffers[queue_tail % CONFIG_BAM_QUEUE_DEPTH]]--;
+    queue_tail++;
+    stats.transfers++;
+    portEXIT_CRITICAL_ISR(&bam_spinlock);
+
+    vTaskNotifyGiveFromISR(feeder_task_handle, &woken);
+    return woken == pdTRUE;
+}
+
+/**
+ * ============================================================================
+ * FEEDER
+ * ============================================================================
+ */
+
+/**
+ * @brief Rebuild the spare buffer from the staged duties and make it active
+ *
+ * Deferred while transfers from the spare buffer are still queued.
+ */
+static void bam_rebuild(void)
+{
+    uint32_t spare = active_buffer ^ 1;
+    uint32_t planes[BAM_PLANES_MAX_BITS];
+
+    xSemaphoreTake(bam_mutex, portMAX_DELAY);
+    if (!staged_dirty) {
+        xSemaphoreGive(bam_mutex);
+        return;
+    }
+    if (in_flight[spare] != 0) {
+        stats.deferred++;
+        xSemaphoreGive(bam_mutex);
+        return;
+    }
+    bam_planes_pack(&layouts[spare], staged, planes);
+    staged_dirty = false;
+    xSemaphoreGive(bam_mutex);
+
+    uint32_t rewritten = bam_planes_fill(&layouts[spare], planes, buffers[spare]);
+    if (rewritten > 0) {
+        for (uint32_t i = 1; i < CONFIG_BAM_PERIODS_PER_TRANSFER; i++) {
+            memcpy(buffers[spare] + i * period_bytes, buffers[spare], period_bytes);
+        }
+    } else if (memcmp(layouts[spare].planes, layouts[active_buffer].planes,
+                      sizeof(layouts[spare].planes)) == 0) {
+        // Change below the plane resolution: the active buffer is current
+        return;
+    }
+
+    active_buffer = spare;
+    stats.rebuilds++;
+    stats.planes_written += rewritten;
+}
+
+/**
+ * @brief Queue transfers of the active buffer until the queue is full
+ */
+static void bam_top_up(void)
+{
+    while (queue_head - queue_tail < CONFIG_BAM_QUEUE_DEPTH) {
+        uint32_t buffer = active_buffer;
+
+        portENTER_CRITICAL(&bam_spinlock);
+        queued_buffers[queue_head % CONFIG_BAM_QUEUE_DEPTH] = buffer;
+        in_flight[buffer]++;
+        portEXIT_CRITICAL(&bam_spinlock);
+        queue_head++;
+
+        if (esp_lcd_panel_io_tx_color(io_handle, -1, buffers[buffer], buffer_bytes) != ESP_OK) {
+            portENTER_CRITICAL(&bam_spinlock);
+            in_flight[buffer]--;
+            portEXIT_CRITICAL(&bam_spinlock);
+            queue_head--;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Keep the DMA queue full, rebuilding between transfers
+ */
+static void bam_feeder_task(void *arg)
+{
+    bool started = false;
+
+    while (1) {
+        if (started && queue_head == queue_tail) {
+            // The DMA ran dry: outputs held their last sample for a moment
+            stats.underruns++;
+        }
+
+        bam_rebuild();
+        bam_top_up();
+        started = true;
+
+        if (queue_head == queue_tail) {
+            // Nothing could be queued; retry without waiting for a completion
+            vTaskDelay(1);
+            continue;
+        }
+
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+/**
+ * ============================================================================
+ * PUBLIC API
+ * ============================================================================
+ */
+
+/**
+ * @brief Set up the parallel bus, period buffers and feeder task
+ */
+int bam_init(void)
+{
+    bam_planes_init(&layouts[0], CONFIG_BAM_CHANNELS, CONFIG_BAM_BITS);
+    bam_planes_init(&layouts[1], CONFIG_BAM_CHANNELS, CONFIG_BAM_BITS);
+    period_bytes = bam_planes_period_bytes(&layouts[0]);
+    buffer_bytes = period_bytes * CONFIG_BAM_PERIODS_PER_TRANSFER + BAM_TAIL_BYTES;
+
+    ESP_LOGI(TAG, "Initializing %d channels, %d-bit, %lu Hz refresh, 2 x %u byte buffers",
+             CONFIG_BAM_CHANNELS, CONFIG_BAM_BITS,
+             (uint32_t)(CONFIG_BAM_PCLK_HZ >> CONFIG_BAM_BITS), (unsigned)buffer_bytes);
+
+    bam_mutex = xSemaphoreCreateMutexStatic(&bam_mutex_buffer);
+    if (bam_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex");
+        return -1;
+    }
+
+    // Zeroed, which also sets the off tail; rebuilds never touch it
+    for (int i = 0; i < 2; i++) {
+        buffers[i] = heap_caps_calloc(1, buffer_bytes, MALLOC_CAP_DMA | MALLOC_CAP_32BIT);
+        if (buffers[i] == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate DMA buffer");
+            return -1;
+        }
+    }
+
+    esp_lcd_i80_bus_config_t bus_config = {
+        .clk_src = LCD_CLK_SRC_DEFAULT,
+        .dc_gpio_num = CONFIG_BAM_DC_PIN,
+        .wr_gpio_num = CONFIG_BAM_WR_PIN,
+        .bus_width = CONFIG_BAM_CHANNELS,
+        .max_transfer_bytes = buffer_bytes,
+    };
+    for (int i = 0; i < CONFIG_BAM_CHANNELS; i++) {
+        bus_config.data_gpio_nums[i] = BAM_DATA_PINS[i];
+    }
+    if (esp_lcd_new_i80_bus(&bus_config, &bus_handle) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create parallel bus");
+        return -1;
+    }
+
+    esp_lcd_panel_io_i80_config_t io_config = {
+        .cs_gpio_num = -1,
+        .pclk_hz = CONFIG_BAM_PCLK_HZ,
+        .trans_queue_depth = CONFIG_BAM_QUEUE_DEPTH,
+        .on_color_trans_done = bam_transfer_done,
+        .user_ctx = NULL,
+        .lcd_cmd_bits = 8,
+        .lcd_param_bits = 8,
+    };
+    if (esp_lcd_new_panel_io_i80(bus_handle, &io_config, &io_handle) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create bus I/O");
+        return -1;
+    }
+
+    // All channels off until the first frame
+    uint32_t planes[BAM_PLANES_MAX_BITS] = {0};
+    bam_planes_fill(&layouts[0], planes, buffers[0]);
+    bam_planes_fill(&layouts[1], planes, buffers[1]);
+
+    feeder_task_handle = xTaskCreateStaticPinnedToCore(bam_feeder_task, "bam_feeder",
+                                                       CONFIG_BAM_TASK_STACK, NULL,
+                                                       CONFIG_BAM_TASK_PRIORITY, feeder_task_stack,
+                                                       &feeder_task_buffer, CONFIG_OUTPUT_CORE);
+    if (feeder_task_handle == NULL) {
+        ESP_LOGE(TAG, "Failed to create feeder task");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Get transfer and rebuild counters
+ */
+int bam_get_stats(bam_stats_t *out)
+{
+    if (out == NULL) {
+        ESP_LOGE(TAG, "Invalid stats pointer");
+        return -1;
+    }
+
+    portENTER_CRITICAL(&bam_spinlock);
+    *out = stats;
+    portEXIT_CRITICAL(&bam_spinlock);
+    return 0;
+}
+
+/**
+ * ============================================================================
+ * OUTPUT DRIVER
+ * ============================================================================
+ */
+
+static int bam_output_init(void *ctx)
+{
+    return bam_init();
+}
+
+static void bam_output_get_caps(void *ctx, output_caps_t *caps)
+{
+    caps->channel_count = CONFIG_BAM_CHANNELS;
+    caps->resolution_bits = CONFIG_BAM_BITS;
+    caps->max_refresh_hz = 0;
+}
+
+static int bam_output_stage(void *ctx, const uint16_t *duty, uint32_t count)
+{
+    xSemaphoreTake(bam_mutex, portMAX_DELAY);
+    for (uint32_t i = 0; i < count && i < CONFIG_BAM_CHANNELS; i++) {
+        if (staged[i] != duty[i]) {
+            staged[i] = duty[i];
+            staged_dirty = true;
+        }
+    }
+    xSemaphoreGive(bam_mutex);
+
+    return 0;
+}
+
+/**
+ * @brief Hand the staged frame to the feeder task without waiting
+ */
+static int bam_output_commit(void *ctx)
+{
+    if (staged_dirty) {
+        xTaskNotifyGive(feeder_task_handle);
+    }
+    return 0;
+}
+
+static const output_driver_t bam_driver = {
+    .name = "bam",
+    .init = bam_output_init,
+    .get_caps = bam_output_get_caps,
+    .stage = bam_output_stage,
+    .commit = bam_output_commit,
+    .ctx = NULL,
+};
+
+/**
+ * @brief BAM engine driver instance for output registration
+ */
+const output_driver_t *bam_output_driver(void)
+{
+    return &bam_driver;
+}
@@ -0,0 +1,22 @@
+#ifndef BAM_H
+#define BAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "output_driver.h"
+
+typedef struct {
+    uint32_t transfers;             ///< DMA transfers completed
+    uint32_t rebuilds;              ///< Frames written into a period buffer
+    uint32_t planes_written;        ///< Bit planes rewritten over all rebuilds
+    uint32_t deferred;              ///< Rebuilds postponed while the spare buffer was busy
+    uint32_t underruns;             ///< Times the DMA queue ran empty
+} bam_stats_t;
+
+int bam_init(void);
+
+int bam_get_stats(bam_stats_t *stats);
+
+const output_driver_t *bam_output_driver(void);
+
+#endif
@@ -0,0 +1,143 @@
+/**
+ * @file bam_planes.c
+ * @brief Binary code modulation bit-plane packing
+ *
+ * One BAM period is a buffer of 2^bits bus samples, each sample holding
+ * one bit per channel. Bit plane k (the k-th duty bit of every channel,
+ * packed into one plane word) is repeated 2^k times, so a channel is on
+ * for exactly its duty code in samples. Layout:
+ *
+ *   sample 0            plane 0
+ *   sample 1            off (pads the period to 2^bits samples)
+ *   samples 2^k..2^k+1-1 plane k, for k >= 1
+ *
+ * Every plane from k = 1 (16/32-bit samples) or k = 2 (8-bit samples) is
+ * 32-bit aligned, so it is filled with word stores of the replicated plane
+ * word. Only the planes whose word changed since the last fill of the same
+ * buffer are rewritten: an LSB change touches a few bytes, and a duty
+ * change below the plane resolution touches nothing.
+ *
+ * Samples only ever move within a period, so hardware that swaps samples
+ * inside a 32-bit word (ESP32 I2S in 8/16-bit LCD mode) keeps every
+ * channel's on time unchanged.
+ */
+
+#include "bam_planes.h"
+#include <string.h>
+
+/**
+ * @brief Set up a layout; the first fill writes the whole period
+ */
+void bam_planes_init(bam_planes_t *layout, uint32_t channels, uint32_t bits)
+{
+    memset(layout, 0, sizeof(*layout));
+    layout->channels = (channels > BAM_PLANES_MAX_CHANNELS) ? BAM_PLANES_MAX_CHANNELS : channels;
+    layout->bits = (bits > BAM_PLANES_MAX_BITS) ? BAM_PLANES_MAX_BITS : (bits < 2 ? 2 : bits);
+    layout->sample_bytes = (layout->channels <= 8) ? 1 : (layout->channels <= 16) ? 2 : 4;
+}
+
+/**
+ * @brief Size of one period buffer
+ */
+size_t bam_planes_period_bytes(const bam_planes_t *layout)
+{
+    return ((size_t)1 << layout->bits) * layout->sample_bytes;
+}
+
+/**
+ * @brief Transpose 16-bit duties into plane words
+ *
+ * Duties are rounded to the plane resolution; each channel costs one step
+ * per set bit of its duty code.
+ */
+void bam_planes_pack(const bam_planes_t *layout, const uint16_t *duty, uint32_t *planes)
+{
+    uint32_t max_code = (1u << layout->bits) - 1;
+
+    memset(planes, 0, layout->bits * sizeof(planes[0]));
+
+    for (uint32_t ch = 0; ch < layout->channels; ch++) {
+        uint32_t code = ((uint32_t)duty[ch] * max_code + 32767u) / 65535u;
+        uint32_t mask = 1u << ch;
+
+        while (code != 0) {
+            planes[__builtin_ctz(code)] |= mask;
+            code &= code - 1;
+        }
+    }
+}
+
+/**
+ * @brief Plane word replicated over a 32-bit bus word
+ */
+static uint32_t bam_planes_replicate(uint32_t plane, uint32_t sample_bytes)
+{
+    if (sample_bytes == 1) {
+        return (plane & 0xFFu) * 0x01010101u;
+    }
+    if (sample_bytes == 2) {
+        return (plane & 0xFFFFu) * 0x00010001u;
+    }
+    return plane;
+}
+
+/**
+ * @brief Store one sample at an index
+ */
+static void bam_planes_store(void *period, uint32_t sample_bytes, uint32_t index, uint32_t value)
+{
+    if (sample_bytes == 1) {
+        ((uint8_t *)period)[index] = (uint8_t)value;
+    } else if (sample_bytes == 2) {
+        ((uint16_t *)period)[index] = (uint16_t)value;
+    } else {
+        ((uint32_t *)period)[index] = value;
+    }
+}
+
+/**
+ * @brief Write the changed planes into a period buffer
+ *
+ * @param layout Layout of this buffer; its plane cache is updated
+ * @param period Buffer of bam_planes_period_bytes(), 32-bit aligned
+ * @return Number of planes rewritten (0 = buffer already up to date)
+ */
+uint32_t bam_planes_fill(bam_planes_t *layout, const uint32_t *planes, void *period)
+{
+    uint32_t sample_bytes = layout->sample_bytes;
+    uint32_t rewritten = 0;
+
+    if (!layout->valid) {
+        // Pad sample, then force every plane to be written
+        bam_planes_store(period, sample_bytes, 1, 0);
+    }
+
+    for (uint32_t k = 0; k < layout->bits; k++) {
+        if (layout->valid && layout->planes[k] == planes[k]) {
+            continue;
+        }
+
+        uint32_t first = (k == 0) ? 0 : (1u << k);
+        uint32_t count = 1u << k;
+
+        if (count * sample_bytes < sizeof(uint32_t)) {
+            for (uint32_t i = 0; i < count; i++) {
+                bam_planes_store(period, sample_bytes, first + i, planes[k]);
+            }
+        } else {
+            uint32_t word = bam_planes_replicate(planes[k], sample_bytes);
+            uint32_t *out = (uint32_t *)((uint8_t *)period + first * sample_bytes);
+            uint32_t words = count * sample_bytes / sizeof(uint32_t);
+
+            for (uint32_t i = 0; i < words; i++) {
+                out[i] = word;
+            }
+        }
+
+        layout->planes[k] = planes[k];
+        rewritten++;
+    }
+
+    layout->valid = true;
+    return rewritten;
+}
@@ -0,0 +1,27 @@
+#ifndef BAM_PLANES_H
+#define BAM_PLANES_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define BAM_PLANES_MAX_BITS           12
+#define BAM_PLANES_MAX_CHANNELS       32
+
+typedef struct {
+    uint32_t channels;              ///< Parallel outputs, one bus line each
+    uint32_t bits;                  ///< Duty resolution = number of bit planes
+    uint32_t sample_bytes;          ///< Bytes per bus sample (1, 2 or 4)
+    uint32_t planes[BAM_PLANES_MAX_BITS];  ///< Plane words currently in the buffer
+    bool valid;                     ///< planes[] describes the buffer contents
+} bam_planes_t;
+
+void bam_planes_init(bam_planes_t *layout, uint32_t channels, uint32_t bits);
+
+size_t bam_planes_period_bytes(const bam_planes_t *layout);
+
+void bam_planes_pack(const bam_planes_t *layout, const uint16_t *duty, uint32_t *planes);
+
+uint32_t bam_planes_fill(bam_planes_t *layout, const uint32_t *planes, void *period);
+
+#endif
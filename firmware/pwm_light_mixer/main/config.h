@@ -11,6 +11,7 @@
 
 #include "driver/gpio.h"
 #include "driver/ledc.h"
+#include "hal/adc_types.h"
 
 /**
  * ============================================================================
@@ -29,6 +30,20 @@
 #define CONFIG_ENCODER_SW_PIN         GPIO_NUM_32    ///< Encoder button pin
 
 #define CONFIG_TOUCH_SENSOR_PIN       GPIO_NUM_15    ///< Touch sensor input pin
+
+#define CONFIG_PCA9685_SDA_PIN        GPIO_NUM_21    ///< Expander I2C data
+#define CONFIG_PCA9685_SCL_PIN        GPIO_NUM_22    ///< Expander I2C clock
+#define CONFIG_WS2812_PIN             GPIO_NUM_18    ///< Addressable strip data
+
+#define CONFIG_BAM_DATA_PINS          { 4, 5, 27, 13, 14, 16, 17, 19 }  ///< BAM bus, channel order
+#define CONFIG_BAM_WR_PIN             GPIO_NUM_23    ///< BAM sample clock (latch strobe)
+#define CONFIG_BAM_DC_PIN             GPIO_NUM_12    ///< Required by the bus; leave unconnected,
+                                                     ///< MTDI strap must stay low at reset
+
+// No GPIO is left with every output variant enabled: the sigma-delta outputs
+// share the expander bus pins, so CONFIG_ENABLE_SDM excludes CONFIG_ENABLE_PCA9685
+#define CONFIG_SDM_PIN_1              GPIO_NUM_21    ///< Sigma-delta indicator LED
+#define CONFIG_SDM_PIN_2              GPIO_NUM_22    ///< Sigma-delta 0-10 V output (RC filter)
 /** @} */
 
 /**
@@ -40,16 +55,259 @@
 /** @defgroup PWM_Config PWM Hardware Configuration
  * @{
  */
-#define CONFIG_LEDC_TIMER             LEDC_TIMER_0
-#define CONFIG_LEDC_MODE              LEDC_HIGH_SPEED_MODE
-#define CONFIG_LEDC_CHANNEL_1         LEDC_CHANNEL_0
-#define CONFIG_LEDC_CHANNEL_2         LEDC_CHANNEL_1
-#define CONFIG_LEDC_DUTY_RES          LEDC_TIMER_8_BIT   ///< 8-bit resolution (0-255)
-#define CONFIG_LEDC_FREQUENCY         5000               ///< PWM frequency in Hz
+#define CONFIG_PWM_PROFILE_STANDARD   0                  ///< 5 kHz at full LEDC resolution
+#define CONFIG_PWM_PROFILE_CAMERA_SAFE 1                 ///< 25 kHz, dithered up to the target bits
+#define CONFIG_PWM_PROFILE            CONFIG_PWM_PROFILE_STANDARD  ///< Default group profile
+#define CONFIG_LEDC_FREQUENCY         ((CONFIG_PWM_PROFILE == CONFIG_PWM_PROFILE_CAMERA_SAFE) ? \
+                                       25000 : 5000)     ///< Default group PWM frequency in Hz
+#define CONFIG_LEDC_MIN_RESOLUTION    8                  ///< Default group minimum duty bits
+#define CONFIG_LEDC_GROUP_FREQUENCIES { CONFIG_LEDC_FREQUENCY }       ///< Hz, per channel group
+#define CONFIG_LEDC_GROUP_MIN_BITS    { CONFIG_LEDC_MIN_RESOLUTION }  ///< Min duty bits, per group
+#define CONFIG_LEDC_TARGET_BITS       12                 ///< Effective duty bits, via LEDC dithering
+#define CONFIG_LEDC_MIN_DITHER_HZ     2000               ///< Slowest allowed dither pattern rate
+#define CONFIG_LEDC_SPREAD_PERMILLE   50                 ///< Spread band half-width, per mille
+#define CONFIG_LEDC_SPREAD_STEPS      16                 ///< Frequencies in the spread band
+#define CONFIG_LEDC_SPREAD_RETUNE_US  1000               ///< Time spent on each frequency
+#define CONFIG_LEDC_FAST_BENCHMARK    0                  ///< Log driver vs fast path update cycles
+#define CONFIG_LEDC_CH1_GROUP         0                  ///< Group of LED 1
+#define CONFIG_LEDC_CH2_GROUP         0                  ///< Group of LED 2
 #define CONFIG_PWM_MIN_DUTY           0                  ///< Minimum PWM duty
 #define CONFIG_PWM_MAX_DUTY           255                ///< Maximum PWM duty (8-bit)
 /** @} */
 
+/**
+ * ============================================================================
+ * PCA9685 EXPANDER CONFIGURATION
+ * ============================================================================
+ */
+
+/** @defgroup PCA9685_Config I2C PWM Expander Configuration
+ * @{
+ */
+#define CONFIG_PCA9685_I2C_PORT       0                  ///< I2C controller
+#define CONFIG_PCA9685_I2C_FREQUENCY  400000             ///< SCL in Hz (Fm); 1000000 (Fm+) needs external pull-ups
+#define CONFIG_PCA9685_CHIP_COUNT     2                  ///< Chips on the bus, 16 channels each
+#define CONFIG_PCA9685_BASE_ADDRESS   0x40               ///< Address of chip 0, others follow
+#define CONFIG_PCA9685_PWM_FREQUENCY  1000               ///< Output PWM frequency in Hz
+#define CONFIG_PCA9685_QUEUE_DEPTH    16                 ///< Async transactions per frame
+#define CONFIG_PCA9685_MERGE_GAP      0                  ///< Clean channels bridged in a burst
+#define CONFIG_PCA9685_TIMEOUT_MS     10                 ///< Blocking init write timeout
+#define CONFIG_PCA9685_REFRESH_HZ     200                ///< Frame rate cap (32 ch frame ~1.2 ms)
+/** @} */
+
+/**
+ * ============================================================================
+ * ADDRESSABLE LED CONFIGURATION
+ * ============================================================================
+ */
+
+/** @defgroup WS2812_Config WS2812/SK6812 Strip Configuration
+ * @{
+ */
+#define CONFIG_WS2812_PIXEL_COUNT     60                 ///< Pixels on the strip
+#define CONFIG_WS2812_BYTES_PER_PIXEL 3                  ///< 3 = WS2812 GRB, 4 = SK6812 GRBW
+#define CONFIG_WS2812_RESOLUTION_HZ   10000000           ///< RMT tick rate (0.1 us)
+#define CONFIG_WS2812_T0H_NS          400                ///< 0 bit high time (SK6812: 300)
+#define CONFIG_WS2812_T0L_NS          850                ///< 0 bit low time (SK6812: 900)
+#define CONFIG_WS2812_T1H_NS          800                ///< 1 bit high time (SK6812: 600)
+#define CONFIG_WS2812_T1L_NS          450                ///< 1 bit low time (SK6812: 600)
+#define CONFIG_WS2812_RESET_US        300                ///< Latch time (newer WS2812B need >280)
+#define CONFIG_WS2812_MEM_BLOCK_SYMBOLS 64               ///< RMT memory (DMA: buffer size)
+#define CONFIG_WS2812_USE_DMA         0                  ///< RMT DMA, ESP32-S3 and later only
+#define CONFIG_WS2812_REFRESH_HZ      100                ///< Frame rate cap (60 px frame ~2.1 ms)
+/** @} */
+
+/**
+ * ============================================================================
+ * BAM ENGINE CONFIGURATION
+ * ============================================================================
+ */
+
+/** @defgroup BAM_Config Binary Code Modulation Engine Configuration
+ * @{
+ */
+#define CONFIG_BAM_CHANNELS           8                  ///< Bus width: 8 or 16 (list 16 data pins)
+#define CONFIG_BAM_BITS               10                 ///< Duty resolution, 2^bits samples per period
+#define CONFIG_BAM_PCLK_HZ            2500000            ///< Sample clock; refresh = PCLK / 2^bits
+#define CONFIG_BAM_PERIODS_PER_TRANSFER 4                ///< Periods per DMA transfer
+#define CONFIG_BAM_QUEUE_DEPTH        3                  ///< Transfers kept in flight
+/** @} */
+
+/**
+ * ============================================================================
+ * SIGMA-DELTA OUTPUT CONFIGURATION
+ * ============================================================================
+ */
+
+/** @defgroup SDM_Config Sigma-Delta Output Configuration
+ * Calibration: measured pulse density (-128..127) giving 0, 25, 50, 75
+ * and 100% output on each channel.
+ * @{
+ */
+#define CONFIG_SDM_SAMPLE_RATE_HZ     1000000            ///< Modulator rate (min 312500)
+#define CONFIG_SDM_CH1_CALIBRATION    { -128, -64, 0, 64, 127 }  ///< Indicator: linear
+#define CONFIG_SDM_CH1_OFF_AT_ZERO    1                  ///< Indicator fully dark at 0
+#define CONFIG_SDM_CH2_CALIBRATION    { -125, -62, 1, 63, 124 }  ///< 0-10 V stage offset/gain
+#define CONFIG_SDM_CH2_OFF_AT_ZERO    0                  ///< Keep the calibrated 0 V
+/** @} */
+
+/**
+ * ============================================================================
+ * OUTPUT CONFIGURATION
+ * ============================================================================
+ */
+
+/** @defgroup Output_Config Output Driver Mapping
+ * @{
+ */
+#define CONFIG_OUTPUT_PCA9685_BASE_CHANNEL 0             ///< Expander channel driven by LED 1
+#define CONFIG_OUTPUT_WS2812_BASE_CHANNEL  0             ///< Strip component driven by LED 1
+#define CONFIG_OUTPUT_BAM_BASE_CHANNEL     0             ///< BAM line driven by LED 1
+#define CONFIG_OUTPUT_SDM_BASE_CHANNEL     0             ///< Sigma-delta channel driven by LED 1
+/** @} */
+
+/**
+ * ============================================================================
+ * POWER BUDGET CONFIGURATION
+ * ============================================================================
+ */
+
+/** @defgroup Power_Config Supply Power Budget Configuration
+ * @{
+ */
+#define CONFIG_PWM_CH1_FULL_SCALE_MW  12000              ///< LED 1 power at 100% duty (mW)
+#define CONFIG_PWM_CH2_FULL_SCALE_MW  12000              ///< LED 2 power at 100% duty (mW)
+#define CONFIG_PWM_CH1_PRIORITY       1                  ///< LED 1 limiting priority (higher first)
+#define CONFIG_PWM_CH2_PRIORITY       1                  ///< LED 2 limiting priority (higher first)
+#define CONFIG_PWM_POWER_BUDGET_MW    24000              ///< Supply cap across all channels (mW), default never limits
+#define CONFIG_PWM_POWER_LIMIT_BY_PRIORITY 0             ///< 0 = proportional, 1 = by priority
+/** @} */
+
+/**
+ * ============================================================================
+ * ENERGY METERING CONFIGURATION
+ * ============================================================================
+ */
+
+/** @defgroup Energy_Config Energy Metering and LED Lifetime Configuration
+ * @{
+ */
+#define CONFIG_ENERGY_PERSIST_INTERVAL_MS 3600000        ///< Energy totals flash write period while lit
+#define CONFIG_LED_RATED_L70_HOURS    50000              ///< LED L70 life at full drive below 45 C
+/** @} */
+
+/**
+ * ============================================================================
+ * POWER-ON SOFT START CONFIGURATION
+ * ============================================================================
+ */
+
+/** @defgroup SoftStart_Config Power-On Soft Start Configuration
+ * @{
+ */
+#define CONFIG_SOFTSTART_RAMP_MS      1500               ///< Power-on ramp duration in ms
+#define CONFIG_SOFTSTART_STAGGER_MAX_MS 1000             ///< Max device-specific start offset in ms
+#define CONFIG_SOFTSTART_STEP_MS      10                 ///< Ramp update period in ms
+/** @} */
+
+/**
+ * ============================================================================
+ * THERMAL DERATING CONFIGURATION
+ * ============================================================================
+ */
+
+/** @defgroup Thermal_Config NTC Thermal Derating Configuration
+ * @{
+ */
+#define CONFIG_THERMAL_ADC_UNIT       ADC_UNIT_1
+#define CONFIG_THERMAL_ADC_CHANNEL    ADC_CHANNEL_0      ///< GPIO 36 (VP), NTC divider
+#define CONFIG_THERMAL_NTC_R25_OHM    10000              ///< NTC resistance at 25 C
+#define CONFIG_THERMAL_NTC_BETA       3950               ///< NTC Beta constant
+#define CONFIG_THERMAL_SERIES_R_OHM   10000              ///< Divider resistor to 3V3
+#define CONFIG_THERMAL_SAMPLES        8                  ///< ADC conversions averaged per period
+#define CONFIG_THERMAL_PERIOD_MS      1000               ///< Sampling period in ms
+#define CONFIG_THERMAL_START_DC       650                ///< Derating starts (0.1 C)
+#define CONFIG_THERMAL_FULL_DC        850                ///< Minimum level reached (0.1 C)
+#define CONFIG_THERMAL_HYSTERESIS_DC  50                 ///< Recovery hysteresis (0.1 C)
+#define CONFIG_THERMAL_MIN_LEVEL_PCT  30                 ///< Output floor when fully derated
+#define CONFIG_THERMAL_MAX_STEP_PCT   2                  ///< Max level change per period
+/** @} */
+
+/**
+ * ============================================================================
+ * DAYLIGHT HARVESTING CONFIGURATION
+ * ============================================================================
+ */
+
+/** @defgroup Daylight_Config Ambient Light Control Loop Configuration
+ * @{
+ */
+#define CONFIG_DAYLIGHT_ADC_UNIT      ADC_UNIT_1         ///< Shared with the NTC
+#define CONFIG_DAYLIGHT_ADC_CHANNEL   ADC_CHANNEL_3      ///< GPIO 39 (VN), photodiode amplifier
+#define CONFIG_DAYLIGHT_FULL_SCALE_LUX 2000              ///< Illuminance at ADC full scale
+#define CONFIG_DAYLIGHT_SAMPLES       8                  ///< ADC conversions averaged per period
+#define CONFIG_DAYLIGHT_PERIOD_MS     1000               ///< Control period in ms
+#define CONFIG_DAYLIGHT_TARGET_LUX    500                ///< Illuminance to hold at the sensor
+#define CONFIG_DAYLIGHT_DEADBAND_LUX  10                 ///< Ignored tracking error
+#define CONFIG_DAYLIGHT_FILTER_SHIFT  3                  ///< Low-pass over ~8 periods
+#define CONFIG_DAYLIGHT_KP_Q16        24                 ///< Proportional gain (Q16 per lux)
+#define CONFIG_DAYLIGHT_KI_Q16        4                  ///< Integral gain (Q16 per lux per period)
+#define CONFIG_DAYLIGHT_MIN_LEVEL_PCT 10                 ///< Trim floor in full daylight
+#define CONFIG_DAYLIGHT_MAX_STEP_Q16  328                ///< Max trim change per period (0.5%)
+/** @} */
+
+/**
+ * ============================================================================
+ * LED CURRENT SENSE CONFIGURATION
+ * ============================================================================
+ */
+
+/** @defgroup Sense_Config PWM-Synchronized Current Sense Configuration
+ * @{
+ */
+#define CONFIG_SENSE_ADC_UNIT         ADC_UNIT_2         ///< ADC2 is unusable while Wi-Fi runs
+#define CONFIG_SENSE_ADC_CHANNEL_1    ADC_CHANNEL_8      ///< GPIO 25, LED 1 low-side shunt
+#define CONFIG_SENSE_ADC_CHANNEL_2    ADC_CHANNEL_9      ///< GPIO 26, LED 2 low-side shunt
+#define CONFIG_SENSE_ADC_FULL_SCALE_MV 950               ///< ADC input range at 0 dB attenuation
+#define CONFIG_SENSE_SHUNT_MOHM       100                ///< Shunt resistor in milliohm
+#define CONFIG_SENSE_MIN_WINDOW_US    40                 ///< Shortest phase that can be sampled
+#define CONFIG_SENSE_SAMPLES_PER_WINDOW 8                ///< On/off sample pairs per average
+#define CONFIG_SENSE_INTERVAL_MS      250                ///< Pause between averaging rounds
+#define CONFIG_SENSE_OPEN_MIN_DUTY    32                 ///< Open check needs at least this duty (0-255 API scale)
+#define CONFIG_SENSE_OPEN_MA          20                 ///< On-current below this is an open string
+#define CONFIG_SENSE_SHORT_OFF_MA     100                ///< Off-current above this is a short
+#define CONFIG_SENSE_OVERCURRENT_MA   4000               ///< On-current above this is overcurrent
+#define CONFIG_SENSE_FAULT_STRIKES    3                  ///< Consecutive bad averages to flag a fault
+/** @} */
+
+/**
+ * ============================================================================
+ * METRICS CONFIGURATION
+ * ============================================================================
+ */
+
+/** @defgroup Metrics_Config Runtime Metrics Configuration
+ * @{
+ */
+#define CONFIG_METRICS_LOG_INTERVAL_MS 60000             ///< Snapshot log period (0 = off)
+/** @} */
+
+/**
+ * ============================================================================
+ * DEADLINE MONITOR CONFIGURATION
+ * ============================================================================
+ */
+
+/** @defgroup Deadline_Config Deadline Monitor Configuration
+ * @{
+ */
+#define CONFIG_DEADLINE_MAIN_LOOP_BUDGET_MS 25           ///< Main loop pass budget, also start slack
+#define CONFIG_DEADLINE_COMMIT_BUDGET_US    2000         ///< Output task wake-to-commit budget
+#define CONFIG_DEADLINE_STALL_OVERRUNS      20           ///< Overruns in a row that stop the watchdog feed
+#define CONFIG_DEADLINE_STALL_MS            1000         ///< Run time that counts as a stall
+#define CONFIG_DEADLINE_REPORT_INTERVAL_MS  10000        ///< Minimum time between overrun reports
+/** @} */
+
 /**
  * ============================================================================
  * ENCODER CONFIGURATION
@@ -91,9 +349,14 @@
 #define CONFIG_NVS_NAMESPACE          "led_ctrl"         ///< NVS namespace for LED state
 #define CONFIG_NVS_KEY_PWM_ENABLED    "pwm_en"           ///< Key for PWM enabled flag
 #define CONFIG_NVS_KEY_PWM_VALUE      "pwm_val"          ///< Key for PWM value
-#define CONFIG_FLASH_WRITE_DEBOUNCE   5000               ///< Flash write debounce in ms
+#define CONFIG_NVS_KEY_ENERGY         "energy"           ///< Key for the energy totals blob
+#define CONFIG_FLASH_WRITE_DEBOUNCE   5000               ///< Base idle time before a commit in ms
+#define CONFIG_NVS_MAX_STALENESS_MS   60000              ///< Hard upper bound on unsaved age in ms
+#define CONFIG_NVS_DAILY_WRITE_BUDGET 500                ///< Target flash commits per 24 h
+#define CONFIG_NVS_COMMITS_PER_PAGE   63                 ///< NVS key-pair commits per 4 KB page
 #define CONFIG_NVS_DEFAULT_PWM_VALUE  CONFIG_ENCODER_INITIAL_POS ///< Default PWM value
 #define CONFIG_NVS_DEFAULT_PWM_ENABLE true               ///< Default PWM enabled state
+#define CONFIG_JOURNAL_PARTITION_LABEL "journal"         ///< Raw partition for the state journal
 /** @} */
 
 /**
@@ -105,10 +368,17 @@
 /** @defgroup Task_Config RTOS Task Configuration
  * @{
  */
-#define CONFIG_ENCODER_TASK_STACK     2048               ///< Encoder task stack size
-#define CONFIG_ENCODER_TASK_PRIORITY  5                  ///< Encoder task priority
-#define CONFIG_TOUCH_TASK_STACK       2048               ///< Touch sensor task stack size
-#define CONFIG_TOUCH_TASK_PRIORITY    5                  ///< Touch sensor task priority
+#define CONFIG_INPUT_EVENT_QUEUE_LEN  16                 ///< Input events queued for the main loop
+#define CONFIG_SENSE_TASK_STACK       2048               ///< Current sense task stack size
+#define CONFIG_SENSE_TASK_PRIORITY    3                  ///< Current sense task priority
+#define CONFIG_BAM_TASK_STACK         2048               ///< BAM feeder task stack size
+#define CONFIG_BAM_TASK_PRIORITY      10                 ///< BAM feeder task priority (above inputs)
+#define CONFIG_OUTPUT_TASK_STACK      4096               ///< Output commit task stack size
+#define CONFIG_OUTPUT_TASK_PRIORITY   8                  ///< Output commit task priority (below BAM feeder)
+#define CONFIG_INPUT_CORE             0                  ///< Core for the main loop and sensing tasks
+#define CONFIG_OUTPUT_CORE            1                  ///< Core for output commits and feeders
+#define CONFIG_OUTPUT_RING_DEPTH      8                  ///< Frames queued to the output task (power of two)
+#define CONFIG_OUTPUT_FRAME_CHANNELS  8                  ///< Largest frame passed to the output task
 #define CONFIG_MAIN_LOOP_INTERVAL     50                 ///< Main loop polling in ms
 /** @} */
 
@@ -136,6 +406,20 @@
  */
 #define CONFIG_ENABLE_NVS_STORAGE     1                  ///< Enable persistent storage
 #define CONFIG_ENABLE_TOUCH_TOGGLE    1                  ///< Enable touch sensor toggle
+#define CONFIG_ENABLE_STATE_JOURNAL   1                  ///< Persist state in the flash journal
+#define CONFIG_ENABLE_SOFT_START      1                  ///< Ramp up and stagger at power-on
+#define CONFIG_ENABLE_POWER_LIMIT     1                  ///< Scale outputs to the power budget
+#define CONFIG_ENABLE_THERMAL_DERATING 1                 ///< Derate output from the NTC
+#define CONFIG_ENABLE_CURRENT_SENSE   1                  ///< Phase-locked LED current sensing
+#define CONFIG_ENABLE_DAYLIGHT        1                  ///< Trim output to hold a target lux
+#define CONFIG_ENABLE_ENERGY_METER    1                  ///< Meter energy and LED usage
+#define CONFIG_ENABLE_PCA9685         0                  ///< PCA9685 expander output variant
+#define CONFIG_ENABLE_WS2812          0                  ///< Addressable strip output variant
+#define CONFIG_ENABLE_BAM             0                  ///< I2S parallel BAM output variant
+#define CONFIG_ENABLE_SDM             0                  ///< Sigma-delta indicator / 0-10 V outputs
+#define CONFIG_ENABLE_SPREAD_SPECTRUM 0                  ///< Sweep LEDC frequency to spread EMI
+#define CONFIG_ENABLE_OUTPUT_TASK     1                  ///< Commit outputs from a task on CONFIG_OUTPUT_CORE
+#define CONFIG_ENABLE_DEADLINE_MONITOR 1                 ///< Deadline monitor, watchdog reset on stalls
 /** @} */
 
 #endif // CONFIG_H
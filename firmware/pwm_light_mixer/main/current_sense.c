@@ -0,0 +1,362 @@
+/**
+ * @file current_sense.c
+ * @brief LED current sensing locked to the LEDC PWM period
+ *
+ * ADC conversions at random points in the PWM period are meaningless for
+ * a pulsed LED current, so every conversion is placed at a fixed phase:
+ * the middle of the on-phase or the middle of the off-phase.
+ *
+ * Sequence for one conversion:
+ * 1. The sense task arms a measurement (channel, phase offset) and enables
+ *    the LEDC timer overflow interrupt.
+ * 2. The overflow ISR fires at the start of the next PWM period (hpoint 0,
+ *    output rising), disables itself and starts a one-shot GPTimer alarm at
+ *    the phase offset.
+ * 3. The GPTimer ISR runs the ADC conversion and notifies the task.
+ *
+ * The task accumulates per-channel on/off averages, converts them to mA via
+ * the shunt value and flags open or shorted LED strings.
+ *
+ * Offsets come from the nominal period. With spread spectrum the real
+ * period drifts by up to the band edge, moving the phase edges against the
+ * offset, so a phase must be that much wider on both sides to be sampled.
+ */
+
+#include "current_sense.h"
+#include "config.h"
+#include "driver/ledc.h"
+#include "driver/gptimer.h"
+#include "adc_shared.h"
+#include "output_ledc.h"
+#include "spread_spectrum.h"
+#include "soc/ledc_struct.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+
+static const char *TAG = "CURRENT_SENSE";
+
+/**
+ * ============================================================================
+ * CONFIGURATION AND STATE
+ * ============================================================================
+ */
+
+#define SENSE_ADC_MAX                 4095
+
+typedef enum {
+    SENSE_PHASE_ON,
+    SENSE_PHASE_OFF,
+} sense_phase_t;
+
+typedef struct {
+    adc_channel_t adc_channel;
+    uint32_t period_us;             ///< PWM period of the LED's LEDC timer
+    uint32_t drift_us;              ///< Longest period minus period_us (spread spectrum)
+    uint32_t overflow_bit;          ///< LEDC interrupt bit of that timer
+    uint32_t on_sum;
+    uint32_t on_count;
+    uint32_t off_sum;
+    uint32_t off_count;
+    uint32_t open_strikes;
+    uint32_t short_strikes;
+    current_sense_channel_t result;
+} sense_channel_t;
+
+static sense_channel_t sense_channels[PWM_CHANNEL_COUNT] = {
+    { .adc_channel = CONFIG_SENSE_ADC_CHANNEL_1 },
+    { .adc_channel = CONFIG_SENSE_ADC_CHANNEL_2 },
+};
+
+static adc_oneshot_unit_handle_t adc_handle = NULL;
+static gptimer_handle_t phase_timer = NULL;
+static TaskHandle_t sense_task_handle = NULL;
+static StackType_t sense_task_stack[CONFIG_SENSE_TASK_STACK];
+static StaticTask_t sense_task_buffer;
+
+// Measurement handed from the task to the ISRs
+static volatile adc_channel_t armed_adc_channel;
+static volatile uint32_t armed_overflow_bit;
+static volatile uint32_t armed_offset_us;
+static volatile int armed_raw;
+static volatile bool armed_ok;
+
+/**
+ * ============================================================================
+ * INTERRUPT HANDLERS
+ * ============================================================================
+ */
+
+/**
+ * @brief LEDC timer overflow: PWM period start, launch the phase timer
+ */
+static void IRAM_ATTR current_sense_ledc_isr(void *arg)
+{
+    uint32_t status = LEDC.int_st.val;
+
+    uint32_t overflow_bit = armed_overflow_bit;
+
+    if (!(status & overflow_bit)) {
+        return;
+    }
+
+    LEDC.int_ena.val &= ~overflow_bit;
+    LEDC.int_clr.val = overflow_bit;
+
+    gptimer_alarm_config_t alarm = {
+        .alarm_count = armed_offset_us,
+    };
+    gptimer_set_raw_count(phase_timer, 0);
+    gptimer_set_alarm_action(phase_timer, &alarm);
+    gptimer_start(phase_timer);
+}
+
+/**
+ * @brief Phase offset reached: convert and hand the result to the task
+ */
+static bool IRAM_ATTR current_sense_phase_isr(gptimer_handle_t timer,
+                                              const gptimer_alarm_event_data_t *event,
+                                              void *arg)
+{
+    BaseType_t woken = pdFALSE;
+    int raw = 0;
+
+    gptimer_stop(timer);
+    armed_ok = (adc_oneshot_read_isr(adc_handle, armed_adc_channel, &raw) == ESP_OK);
+    armed_raw = raw;
+
+    vTaskNotifyGiveFromISR(sense_task_handle, &woken);
+    return woken == pdTRUE;
+}
+
+/**
+ * ============================================================================
+ * MEASUREMENT
+ * ============================================================================
+ */
+
+/**
+ * @brief Convert an averaged ADC code to shunt current in mA
+ */
+static uint32_t current_sense_raw_to_ma(uint32_t raw)
+{
+    uint32_t mv = (raw * CONFIG_SENSE_ADC_FULL_SCALE_MV) / SENSE_ADC_MAX;
+    return (mv * 1000) / CONFIG_SENSE_SHUNT_MOHM;
+}
+
+/**
+ * @brief Take one conversion at a fixed phase of the next PWM period
+ *
+ * @return true if a sample was taken
+ */
+static bool current_sense_measure(uint32_t channel, sense_phase_t phase)
+{
+    sense_channel_t *sense = &sense_channels[channel];
+    uint32_t duty = pwm_controller_get_output(channel);
+    uint32_t on_us = (uint32_t)(((uint64_t)sense->period_us * duty) / (OUTPUT_DUTY_MAX + 1));
+    uint32_t off_us = sense->period_us - on_us;
+    uint32_t window_us = (phase == SENSE_PHASE_ON) ? on_us : off_us;
+
+    // Conversion plus interrupt latency must fit inside the phase, wherever
+    // the sweep has moved its edges
+    if (window_us < CONFIG_SENSE_MIN_WINDOW_US + 2 * sense->drift_us) {
+        sense->result.skipped++;
+        return false;
+    }
+
+    armed_adc_channel = sense->adc_channel;
+    armed_overflow_bit = sense->overflow_bit;
+    armed_offset_us = (phase == SENSE_PHASE_ON) ? on_us / 2 : on_us + off_us / 2;
+    armed_ok = false;
+
+    LEDC.int_clr.val = sense->overflow_bit;
+    LEDC.int_ena.val |= sense->overflow_bit;
+
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10)) == 0 || !armed_ok) {
+        LEDC.int_ena.val &= ~sense->overflow_bit;
+        sense->result.skipped++;
+        return false;
+    }
+
+    if (phase == SENSE_PHASE_ON) {
+        sense->on_sum += (uint32_t)armed_raw;
+        sense->on_count++;
+    } else {
+        sense->off_sum += (uint32_t)armed_raw;
+        sense->off_count++;
+    }
+    sense->result.samples++;
+    return true;
+}
+
+/**
+ * @brief Close an averaging window: update currents and fault state
+ */
+static void current_sense_evaluate(uint32_t channel)
+{
+    sense_channel_t *sense = &sense_channels[channel];
+    current_sense_channel_t *result = &sense->result;
+    uint32_t duty = pwm_controller_get_output(channel);
+
+    if (sense->on_count > 0) {
+        result->on_ma = current_sense_raw_to_ma(sense->on_sum / sense->on_count);
+    } else if (duty == 0) {
+        result->on_ma = 0;
+    }
+    if (sense->off_count > 0) {
+        result->off_ma = current_sense_raw_to_ma(sense->off_sum / sense->off_count);
+    } else if (duty >= OUTPUT_DUTY_MAX) {
+        result->off_ma = 0;
+    }
+    result->average_ma = (uint32_t)(((uint64_t)result->on_ma * duty) / OUTPUT_DUTY_MAX);
+
+    // Output levels are 16-bit, the threshold is on the 0..255 API scale
+    bool open = sense->on_count > 0 &&
+                duty >= CONFIG_SENSE_OPEN_MIN_DUTY * (OUTPUT_DUTY_MAX / CONFIG_PWM_MAX_DUTY) &&
+                result->on_ma < CONFIG_SENSE_OPEN_MA;
+    bool shorted = (sense->off_count > 0 && result->off_ma > CONFIG_SENSE_SHORT_OFF_MA) ||
+                   result->on_ma > CONFIG_SENSE_OVERCURRENT_MA;
+
+    sense->open_strikes = open ? sense->open_strikes + 1 : 0;
+    sense->short_strikes = shorted ? sense->short_strikes + 1 : 0;
+
+    current_sense_fault_t fault = CURRENT_SENSE_OK;
+    if (sense->short_strikes >= CONFIG_SENSE_FAULT_STRIKES) {
+        fault = CURRENT_SENSE_FAULT_SHORT;
+    } else if (sense->open_strikes >= CONFIG_SENSE_FAULT_STRIKES) {
+        fault = CURRENT_SENSE_FAULT_OPEN;
+    }
+
+    if (fault != result->fault) {
+        if (fault == CURRENT_SENSE_OK) {
+            ESP_LOGI(TAG, "LED %lu fault cleared", channel + 1);
+        } else {
+            ESP_LOGW(TAG, "LED %lu %s: on=%lu mA off=%lu mA duty=%lu", channel + 1,
+                     fault == CURRENT_SENSE_FAULT_OPEN ? "open string" : "short/overcurrent",
+                     result->on_ma, result->off_ma, duty);
+        }
+        result->fault = fault;
+    }
+
+    sense->on_sum = 0;
+    sense->on_count = 0;
+    sense->off_sum = 0;
+    sense->off_count = 0;
+}
+
+/**
+ * @brief Sense task: round-robin phase-locked sampling of all channels
+ */
+static void current_sense_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "Current sense task started");
+
+    while (1) {
+        for (uint32_t channel = 0; channel < PWM_CHANNEL_COUNT; channel++) {
+            for (int i = 0; i < CONFIG_SENSE_SAMPLES_PER_WINDOW; i++) {
+                current_sense_measure(channel, SENSE_PHASE_ON);
+                current_sense_measure(channel, SENSE_PHASE_OFF);
+            }
+            current_sense_evaluate(channel);
+        }
+
+        vTaskDelay(CONFIG_SENSE_INTERVAL_MS / portTICK_PERIOD_MS);
+    }
+}
+
+/**
+ * ============================================================================
+ * PUBLIC API
+ * ============================================================================
+ */
+
+/**
+ * @brief Initialize ADC, phase timer and LEDC overflow interrupt
+ */
+int current_sense_init(void)
+{
+    ESP_LOGI(TAG, "Initializing current sensing");
+
+    // Sampling follows each LED's own timer, as placed by the LEDC allocator
+    for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+        output_ledc_timing_t timing;
+        if (output_ledc_get_timing(i, &timing) != 0 || timing.freq_hz == 0) {
+            ESP_LOGE(TAG, "No LEDC timing for LED %lu", i + 1);
+            return -1;
+        }
+        sense_channels[i].period_us = 1000000 / timing.freq_hz;
+        if (CONFIG_ENABLE_SPREAD_SPECTRUM) {
+            uint32_t low_hz = spread_spectrum_min_hz(timing.freq_hz, CONFIG_LEDC_SPREAD_PERMILLE);
+            sense_channels[i].drift_us = (1000000 + low_hz - 1) / low_hz -
+                                         sense_channels[i].period_us;
+        }
+        sense_channels[i].overflow_bit =
+            1u << (timing.timer + (timing.speed_mode == LEDC_HIGH_SPEED_MODE ? 0 : 4));
+        ESP_LOGI(TAG, "  LED %lu: PWM period %lu us (+/- %lu us)", i + 1,
+                 sense_channels[i].period_us, sense_channels[i].drift_us);
+    }
+
+    if (adc_shared_get_unit(CONFIG_SENSE_ADC_UNIT, &adc_handle) != 0) {
+        ESP_LOGE(TAG, "Failed to get ADC unit");
+        return -1;
+    }
+
+    adc_oneshot_chan_cfg_t channel_config = {
+        .atten = ADC_ATTEN_DB_0,
+        .bitwidth = ADC_BITWIDTH_12,
+    };
+    for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+        if (adc_oneshot_config_channel(adc_handle, sense_channels[i].adc_channel,
+                                       &channel_config) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to configure ADC channel for LED %lu", i + 1);
+            return -1;
+        }
+    }
+
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = 1000000,   // 1 us per tick
+    };
+    gptimer_event_callbacks_t callbacks = {
+        .on_alarm = current_sense_phase_isr,
+    };
+    if (gptimer_new_timer(&timer_config, &phase_timer) != ESP_OK ||
+        gptimer_register_event_callbacks(phase_timer, &callbacks, NULL) != ESP_OK ||
+        gptimer_enable(phase_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up phase timer");
+        return -1;
+    }
+
+    if (ledc_isr_register(current_sense_ledc_isr, NULL, ESP_INTR_FLAG_IRAM, NULL) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register LEDC interrupt");
+        return -1;
+    }
+
+    sense_task_handle = xTaskCreateStaticPinnedToCore(current_sense_task, "current_sense_task",
+                                                      CONFIG_SENSE_TASK_STACK, NULL,
+                                                      CONFIG_SENSE_TASK_PRIORITY, sense_task_stack,
+                                                      &sense_task_buffer, CONFIG_INPUT_CORE);
+    if (sense_task_handle == NULL) {
+        ESP_LOGE(TAG, "Failed to create sense task");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Get the latest measurement of one channel
+ */
+int current_sense_get_channel(uint32_t channel, current_sense_channel_t *result)
+{
+    if (channel >= PWM_CHANNEL_COUNT || result == NULL) {
+        ESP_LOGE(TAG, "Invalid channel or result pointer");
+        return -1;
+    }
+
+    *result = sense_channels[channel].result;
+    return 0;
+}
@@ -0,0 +1,27 @@
+#ifndef CURRENT_SENSE_H
+#define CURRENT_SENSE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pwm_controller.h"
+
+typedef enum {
+    CURRENT_SENSE_OK = 0,
+    CURRENT_SENSE_FAULT_OPEN,       ///< No current during the on-phase
+    CURRENT_SENSE_FAULT_SHORT,      ///< Current during the off-phase or overcurrent
+} current_sense_fault_t;
+
+typedef struct {
+    uint32_t on_ma;                 ///< Average LED current in the on-phase
+    uint32_t off_ma;                ///< Average current in the off-phase
+    uint32_t average_ma;            ///< Period-average current (on_ma x duty)
+    uint32_t samples;               ///< Completed phase-locked conversions
+    uint32_t skipped;               ///< Phases too short to sample
+    current_sense_fault_t fault;
+} current_sense_channel_t;
+
+int current_sense_init(void);
+
+int current_sense_get_channel(uint32_t channel, current_sense_channel_t *result);
+
+#endif
@@ -0,0 +1,150 @@
+/**
+ * @file daylight.c
+ * @brief Closed-loop daylight harvesting
+ *
+ * Samples an ambient light sensor from a low-rate esp_timer, converts the
+ * averaged reading to lux and runs the PI controller that trims the
+ * pwm_controller master level so the illuminance at the sensor holds a
+ * target. The user's set point stays the upper bound: daylight can only
+ * dim the fixture, never drive it above what the user selected.
+ *
+ * Sensor: photodiode with a transimpedance amplifier whose output spans
+ * the ADC range over 0..CONFIG_DAYLIGHT_FULL_SCALE_LUX. It shares ADC1
+ * with the NTC; both are sampled from the esp_timer task, so conversions
+ * never overlap.
+ */
+
+#include "daylight.h"
+#include "daylight_pi.h"
+#include "config.h"
+#include "pwm_controller.h"
+#include "adc_shared.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "DAYLIGHT";
+
+#define DAYLIGHT_ADC_MAX              4095
+
+static adc_oneshot_unit_handle_t adc_handle = NULL;
+static esp_timer_handle_t daylight_timer = NULL;
+static daylight_pi_t controller;
+static daylight_status_t status = {0};
+static uint32_t last_logged_level = DAYLIGHT_PI_UNITY_Q16;
+
+/**
+ * @brief Read and average CONFIG_DAYLIGHT_SAMPLES conversions
+ *
+ * @return 0 on success, -1 on ADC error
+ */
+static int daylight_read_lux(uint32_t *lux)
+{
+    uint32_t sum = 0;
+
+    for (int i = 0; i < CONFIG_DAYLIGHT_SAMPLES; i++) {
+        int raw = 0;
+        if (adc_oneshot_read(adc_handle, CONFIG_DAYLIGHT_ADC_CHANNEL, &raw) != ESP_OK) {
+            return -1;
+        }
+        sum += (uint32_t)raw;
+    }
+
+    *lux = ((sum / CONFIG_DAYLIGHT_SAMPLES) * CONFIG_DAYLIGHT_FULL_SCALE_LUX) / DAYLIGHT_ADC_MAX;
+    return 0;
+}
+
+/**
+ * @brief Periodic control callback (esp_timer task)
+ *
+ * A failed read holds the current trim and is counted in the status.
+ */
+static void daylight_timer_callback(void *arg)
+{
+    uint32_t lux;
+
+    status.samples++;
+
+    if (daylight_read_lux(&lux) != 0) {
+        if (status.sensor_faults++ == 0) {
+            ESP_LOGW(TAG, "Light sensor read failed, holding output trim");
+        }
+        return;
+    }
+
+    status.level_q16 = daylight_pi_update(&controller, lux);
+    status.lux = daylight_pi_filtered_lux(&controller);
+
+    pwm_controller_set_master_scale(PWM_SCALE_DAYLIGHT, status.level_q16);
+
+    // Log once per 5% of trim change; the loop moves slowly by design
+    uint32_t delta = (status.level_q16 > last_logged_level) ?
+                     status.level_q16 - last_logged_level : last_logged_level - status.level_q16;
+    if (delta >= DAYLIGHT_PI_UNITY_Q16 / 20) {
+        last_logged_level = status.level_q16;
+        ESP_LOGI(TAG, "%lu lux -> trim %lu%%", status.lux,
+                 (status.level_q16 * 100) / DAYLIGHT_PI_UNITY_Q16);
+    }
+}
+
+/**
+ * @brief Initialize the light sensor channel and start the control loop
+ */
+int daylight_init(void)
+{
+    ESP_LOGI(TAG, "Initializing daylight harvesting on ADC channel %d",
+             CONFIG_DAYLIGHT_ADC_CHANNEL);
+
+    const daylight_pi_config_t pi_config = {
+        .target_lux = CONFIG_DAYLIGHT_TARGET_LUX,
+        .deadband_lux = CONFIG_DAYLIGHT_DEADBAND_LUX,
+        .filter_shift = CONFIG_DAYLIGHT_FILTER_SHIFT,
+        .kp_q16 = CONFIG_DAYLIGHT_KP_Q16,
+        .ki_q16 = CONFIG_DAYLIGHT_KI_Q16,
+        .min_level_q16 = (CONFIG_DAYLIGHT_MIN_LEVEL_PCT * DAYLIGHT_PI_UNITY_Q16) / 100,
+        .max_step_q16 = CONFIG_DAYLIGHT_MAX_STEP_Q16
+    };
+    daylight_pi_init(&controller, &pi_config);
+    status.level_q16 = DAYLIGHT_PI_UNITY_Q16;
+
+    if (adc_shared_get_unit(CONFIG_DAYLIGHT_ADC_UNIT, &adc_handle) != 0) {
+        ESP_LOGE(TAG, "Failed to get ADC unit");
+        return -1;
+    }
+
+    adc_oneshot_chan_cfg_t channel_config = {
+        .atten = ADC_ATTEN_DB_12,
+        .bitwidth = ADC_BITWIDTH_12,
+    };
+    if (adc_oneshot_config_channel(adc_handle, CONFIG_DAYLIGHT_ADC_CHANNEL, &channel_config) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure ADC channel");
+        return -1;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = daylight_timer_callback,
+        .name = "daylight"
+    };
+    if (esp_timer_create(&timer_args, &daylight_timer) != ESP_OK ||
+        esp_timer_start_periodic(daylight_timer, CONFIG_DAYLIGHT_PERIOD_MS * 1000ULL) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start daylight timer");
+        return -1;
+    }
+
+    ESP_LOGI(TAG, "Holding %d lux, trim floor %d%%, period %d ms",
+             CONFIG_DAYLIGHT_TARGET_LUX, CONFIG_DAYLIGHT_MIN_LEVEL_PCT, CONFIG_DAYLIGHT_PERIOD_MS);
+    return 0;
+}
+
+/**
+ * @brief Get the latest illuminance and output trim
+ */
+int daylight_get_status(daylight_status_t *out)
+{
+    if (out == NULL) {
+        ESP_LOGE(TAG, "Invalid status pointer");
+        return -1;
+    }
+
+    *out = status;
+    return 0;
+}
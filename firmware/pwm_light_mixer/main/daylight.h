@@ -0,0 +1,18 @@
+#ifndef DAYLIGHT_H
+#define DAYLIGHT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    uint32_t lux;                   ///< Filtered illuminance at the sensor
+    uint32_t level_q16;             ///< Applied output trim (65536 = 100%)
+    uint32_t samples;               ///< Completed control periods
+    uint32_t sensor_faults;         ///< Periods with an ADC read error
+} daylight_status_t;
+
+int daylight_init(void);
+
+int daylight_get_status(daylight_status_t *status);
+
+#endif
@@ -0,0 +1,108 @@
+/**
+ * @file daylight_pi.c
+ * @brief Fixed-point PI controller for daylight harvesting
+ *
+ * Trims the output scale so the illuminance at the sensor (daylight plus
+ * the fixture's own light) holds a target. The reading is low-passed first
+ * so passing shadows do not reach the controller; the output is clamped to
+ * [min level, 100%] and slew-limited so changes stay below perception.
+ *
+ * The integrator is back-calculated from the applied level whenever the
+ * clamp or the slew limit is active, so it never winds up while the
+ * output is saturated (e.g. at night, when the target cannot be reached).
+ *
+ * Pure integer logic, driven by the daylight module on target and by
+ * scripted daylight curves on the host.
+ */
+
+#include "daylight_pi.h"
+
+/**
+ * @brief Clamp a Q16 value into the allowed output range
+ */
+static int32_t daylight_pi_clamp(const daylight_pi_config_t *config, int32_t value_q16)
+{
+    if (value_q16 > (int32_t)DAYLIGHT_PI_UNITY_Q16) {
+        return (int32_t)DAYLIGHT_PI_UNITY_Q16;
+    }
+    if (value_q16 < (int32_t)config->min_level_q16) {
+        return (int32_t)config->min_level_q16;
+    }
+    return value_q16;
+}
+
+/**
+ * @brief Initialize a controller instance at full output
+ */
+void daylight_pi_init(daylight_pi_t *pi, const daylight_pi_config_t *config)
+{
+    pi->config = *config;
+    if (pi->config.min_level_q16 > DAYLIGHT_PI_UNITY_Q16) {
+        pi->config.min_level_q16 = DAYLIGHT_PI_UNITY_Q16;
+    }
+    if (pi->config.max_step_q16 == 0) {
+        pi->config.max_step_q16 = DAYLIGHT_PI_UNITY_Q16;
+    }
+    pi->filtered_lux_q4 = 0;
+    pi->integral_q16 = (int32_t)DAYLIGHT_PI_UNITY_Q16;
+    pi->level_q16 = DAYLIGHT_PI_UNITY_Q16;
+    pi->primed = false;
+}
+
+/**
+ * @brief Feed a new sensor reading and get the updated output scale
+ */
+uint32_t daylight_pi_update(daylight_pi_t *pi, uint32_t lux)
+{
+    const daylight_pi_config_t *config = &pi->config;
+    int32_t lux_q4 = (int32_t)(lux << DAYLIGHT_PI_LUX_SHIFT);
+
+    if (!pi->primed) {
+        pi->filtered_lux_q4 = lux_q4;
+        pi->primed = true;
+    } else {
+        pi->filtered_lux_q4 += (lux_q4 - pi->filtered_lux_q4) >> config->filter_shift;
+    }
+
+    // Positive error: too dark, more artificial light needed
+    int32_t error_q4 = (int32_t)(config->target_lux << DAYLIGHT_PI_LUX_SHIFT) - pi->filtered_lux_q4;
+    int32_t deadband_q4 = (int32_t)(config->deadband_lux << DAYLIGHT_PI_LUX_SHIFT);
+
+    if (error_q4 > deadband_q4) {
+        error_q4 -= deadband_q4;
+    } else if (error_q4 < -deadband_q4) {
+        error_q4 += deadband_q4;
+    } else {
+        error_q4 = 0;
+    }
+
+    int32_t p_term = (int32_t)(((int64_t)config->kp_q16 * error_q4) >> DAYLIGHT_PI_LUX_SHIFT);
+    int32_t i_step = (int32_t)(((int64_t)config->ki_q16 * error_q4) >> DAYLIGHT_PI_LUX_SHIFT);
+    pi->integral_q16 = daylight_pi_clamp(config, pi->integral_q16 + i_step);
+
+    int32_t wanted = daylight_pi_clamp(config, pi->integral_q16 + p_term);
+    int32_t level = (int32_t)pi->level_q16;
+    int32_t max_step = (int32_t)config->max_step_q16;
+
+    if (wanted > level + max_step) {
+        wanted = level + max_step;
+    } else if (wanted < level - max_step) {
+        wanted = level - max_step;
+    }
+
+    // Back-calculation: keep the integrator consistent with the applied level
+    if (wanted != pi->integral_q16 + p_term) {
+        pi->integral_q16 = daylight_pi_clamp(config, wanted - p_term);
+    }
+
+    pi->level_q16 = (uint32_t)wanted;
+    return pi->level_q16;
+}
+
+/**
+ * @brief Current low-passed sensor reading in lux
+ */
+uint32_t daylight_pi_filtered_lux(const daylight_pi_t *pi)
+{
+    return pi->filtered_lux_q4 < 0 ? 0 : (uint32_t)pi->filtered_lux_q4 >> DAYLIGHT_PI_LUX_SHIFT;
+}
@@ -0,0 +1,34 @@
+#ifndef DAYLIGHT_PI_H
+#define DAYLIGHT_PI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DAYLIGHT_PI_UNITY_Q16         65536u             ///< Full output
+#define DAYLIGHT_PI_LUX_SHIFT         4                  ///< Filtered lux is kept in Q4
+
+typedef struct {
+    uint32_t target_lux;            ///< Illuminance to hold at the sensor
+    uint32_t deadband_lux;          ///< Errors within this band are ignored
+    uint32_t filter_shift;          ///< Low-pass: filtered += (raw - filtered) >> shift
+    int32_t kp_q16;                 ///< Level change (Q16) per lux of error
+    int32_t ki_q16;                 ///< Integrator change (Q16) per lux of error per update
+    uint32_t min_level_q16;         ///< Output floor, however bright the daylight
+    uint32_t max_step_q16;          ///< Largest level change per update
+} daylight_pi_config_t;
+
+typedef struct {
+    daylight_pi_config_t config;
+    int32_t filtered_lux_q4;        ///< Low-passed sensor reading
+    int32_t integral_q16;           ///< Integrator state
+    uint32_t level_q16;             ///< Current output scale
+    bool primed;                    ///< Filter seeded with a first reading
+} daylight_pi_t;
+
+void daylight_pi_init(daylight_pi_t *pi, const daylight_pi_config_t *config);
+
+uint32_t daylight_pi_update(daylight_pi_t *pi, uint32_t lux);
+
+uint32_t daylight_pi_filtered_lux(const daylight_pi_t *pi);
+
+#endif
@@ -0,0 +1,208 @@
+/**
+ * @file deadline.c
+ * @brief Deadline accounting for periodic and aperiodic jobs
+ *
+ * Each job declares a budget. A run (begin to end) longer than the budget
+ * is an overrun; a periodic job also overruns when it starts more than its
+ * budget after its period, i.e. something held it up between runs.
+ * Blocking reported while the job runs, or between runs, is added up per
+ * cause (mutex, flash, log) and the largest share is blamed for an
+ * overrun; with nothing reported the job simply computed or was preempted.
+ *
+ * The last DEADLINE_HISTORY overruns are kept with a timestamp. Pure logic
+ * with caller-supplied time, no locking; the firmware wrapper is
+ * deadline_monitor.c.
+ */
+
+#include "deadline.h"
+#include <stddef.h>
+#include <string.h>
+
+static const char *CAUSE_NAMES[DEADLINE_CAUSE_COUNT] = { "cpu", "mutex", "flash", "log" };
+
+/**
+ * @brief Largest blocking share of a job
+ */
+static deadline_cause_t deadline_main_cause(const deadline_job_t *job)
+{
+    deadline_cause_t cause = DEADLINE_CAUSE_CPU;
+
+    for (int i = DEADLINE_CAUSE_MUTEX; i < DEADLINE_CAUSE_COUNT; i++) {
+        if (job->blocked_us[i] > job->blocked_us[cause]) {
+            cause = (deadline_cause_t)i;
+        }
+    }
+    return cause;
+}
+
+/**
+ * @brief Record an overrun and blame the largest blocking share
+ */
+static void deadline_record(deadline_t *deadline, uint32_t index, bool late_start,
+                            uint32_t elapsed_us, int64_t now_us)
+{
+    deadline_job_t *job = &deadline->jobs[index];
+    deadline_cause_t cause = deadline_main_cause(job);
+
+    job->stats.overruns++;
+    if (elapsed_us > job->stats.worst_us) {
+        job->stats.worst_us = elapsed_us;
+        job->stats.worst_cause = cause;
+    }
+
+    deadline->history[deadline->overruns % DEADLINE_HISTORY] = (deadline_overrun_t){
+        .time_us = now_us,
+        .job = index,
+        .cause = cause,
+        .late_start = late_start,
+        .elapsed_us = elapsed_us,
+        .budget_us = job->budget_us,
+        .blocked_us = job->blocked_us[cause],
+    };
+    deadline->overruns++;
+}
+
+/**
+ * @brief Reset to no jobs and no overruns
+ */
+void deadline_init(deadline_t *deadline)
+{
+    memset(deadline, 0, sizeof(*deadline));
+}
+
+/**
+ * @brief Declare a job
+ *
+ * @param name      Job name, must stay valid
+ * @param period_us Period of a periodic job, 0 for an aperiodic one
+ * @param budget_us Longest acceptable run (and start slack)
+ * @return Job index, -1 if the table is full or the budget is 0
+ */
+int deadline_register(deadline_t *deadline, const char *name, uint32_t period_us,
+                      uint32_t budget_us)
+{
+    if (deadline->count >= DEADLINE_MAX_JOBS || budget_us == 0) {
+        return -1;
+    }
+
+    deadline_job_t *job = &deadline->jobs[deadline->count];
+    memset(job, 0, sizeof(*job));
+    job->name = name;
+    job->period_us = period_us;
+    job->budget_us = budget_us;
+
+    return (int)deadline->count++;
+}
+
+/**
+ * @brief Start a run, checking the start deadline of periodic jobs
+ *
+ * @param now_us Start of the run; may be earlier than the call, e.g. the
+ *               time a frame was staged for a commit job
+ */
+void deadline_begin(deadline_t *deadline, uint32_t job_index, int64_t now_us)
+{
+    deadline_job_t *job = &deadline->jobs[job_index];
+
+    job->late = false;
+    if (job->period_us > 0 && job->last_start_us != 0) {
+        int64_t delay_us = now_us - job->last_start_us - job->period_us;
+        if (delay_us > job->budget_us) {
+            job->late = true;
+            deadline_record(deadline, job_index, true, (uint32_t)delay_us, now_us);
+        }
+    }
+
+    job->last_start_us = now_us;
+    job->start_us = now_us;
+    job->active = true;
+    memset(job->blocked_us, 0, sizeof(job->blocked_us));
+}
+
+/**
+ * @brief End a run, checking it against the budget
+ *
+ * @return true if the run started and finished on time
+ */
+bool deadline_end(deadline_t *deadline, uint32_t job_index, int64_t now_us)
+{
+    deadline_job_t *job = &deadline->jobs[job_index];
+
+    if (!job->active) {
+        return true;
+    }
+
+    uint32_t elapsed_us = (uint32_t)(now_us - job->start_us);
+    bool over = (elapsed_us > job->budget_us);
+    if (over) {
+        deadline_record(deadline, job_index, false, elapsed_us, now_us);
+    }
+
+    job->stats.runs++;
+    job->stats.consecutive = (over || job->late) ? job->stats.consecutive + 1 : 0;
+    job->active = false;
+    memset(job->blocked_us, 0, sizeof(job->blocked_us));
+
+    return !(over || job->late);
+}
+
+/**
+ * @brief Add blocking time of a known cause to the job's current run or gap
+ */
+void deadline_note_block(deadline_t *deadline, uint32_t job_index, deadline_cause_t cause,
+                         uint32_t blocked_us)
+{
+    if (job_index >= deadline->count || cause >= DEADLINE_CAUSE_COUNT) {
+        return;
+    }
+
+    deadline->jobs[job_index].blocked_us[cause] += blocked_us;
+}
+
+/**
+ * @brief Get a recorded overrun, age 0 being the newest
+ *
+ * @return The overrun, or NULL if it is older than the history
+ */
+const deadline_overrun_t *deadline_get_overrun(const deadline_t *deadline, uint32_t age)
+{
+    if (age >= deadline->overruns || age >= DEADLINE_HISTORY) {
+        return NULL;
+    }
+
+    return &deadline->history[(deadline->overruns - 1 - age) % DEADLINE_HISTORY];
+}
+
+/**
+ * @brief Job whose worst overrun exceeded its budget by the largest factor
+ *
+ * @return Job index, -1 if no job overran
+ */
+int deadline_worst_offender(const deadline_t *deadline)
+{
+    int worst = -1;
+    uint64_t worst_ratio_q8 = 0;
+
+    for (uint32_t i = 0; i < deadline->count; i++) {
+        const deadline_job_t *job = &deadline->jobs[i];
+        if (job->stats.overruns == 0) {
+            continue;
+        }
+
+        uint64_t ratio_q8 = ((uint64_t)job->stats.worst_us << 8) / job->budget_us;
+        if (worst < 0 || ratio_q8 > worst_ratio_q8) {
+            worst = (int)i;
+            worst_ratio_q8 = ratio_q8;
+        }
+    }
+
+    return worst;
+}
+
+/**
+ * @brief Short name of a blocking cause
+ */
+const char *deadline_cause_name(deadline_cause_t cause)
+{
+    return (cause < DEADLINE_CAUSE_COUNT) ? CAUSE_NAMES[cause] : "?";
+}
@@ -0,0 +1,73 @@
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DEADLINE_MAX_JOBS             4
+#define DEADLINE_HISTORY              8                  ///< Overruns kept with their details
+
+typedef enum {
+    DEADLINE_CAUSE_CPU,             ///< No recorded blocking: computation or preemption
+    DEADLINE_CAUSE_MUTEX,           ///< Waiting for a mutex
+    DEADLINE_CAUSE_FLASH,           ///< Flash erase or write
+    DEADLINE_CAUSE_LOG,             ///< Log output
+    DEADLINE_CAUSE_COUNT
+} deadline_cause_t;
+
+typedef struct {
+    uint32_t runs;
+    uint32_t overruns;              ///< Late starts plus runs over budget
+    uint32_t consecutive;           ///< Overrunning runs in a row (0 after a run on time)
+    uint32_t worst_us;              ///< Longest run or start delay
+    deadline_cause_t worst_cause;
+} deadline_job_stats_t;
+
+typedef struct {
+    const char *name;
+    uint32_t period_us;             ///< 0 = aperiodic, no start deadline
+    uint32_t budget_us;             ///< Longest run, and slack on the start of periodic jobs
+    bool active;                    ///< Between begin and end
+    bool late;                      ///< Current run started late
+    int64_t start_us;
+    int64_t last_start_us;          ///< Previous start (periodic jobs), 0 before the first run
+    uint32_t blocked_us[DEADLINE_CAUSE_COUNT]; ///< Blocking since the last begin or end
+    deadline_job_stats_t stats;
+} deadline_job_t;
+
+typedef struct {
+    int64_t time_us;                ///< When the overrun was detected
+    uint32_t job;
+    deadline_cause_t cause;         ///< Largest blocking share
+    bool late_start;                ///< Start delay rather than run time
+    uint32_t elapsed_us;            ///< Run time, or start delay beyond the period
+    uint32_t budget_us;
+    uint32_t blocked_us;            ///< Time attributed to the cause
+} deadline_overrun_t;
+
+typedef struct {
+    deadline_job_t jobs[DEADLINE_MAX_JOBS];
+    uint32_t count;
+    deadline_overrun_t history[DEADLINE_HISTORY];
+    uint32_t overruns;              ///< Overruns recorded in total
+} deadline_t;
+
+void deadline_init(deadline_t *deadline);
+
+int deadline_register(deadline_t *deadline, const char *name, uint32_t period_us,
+                      uint32_t budget_us);
+
+void deadline_begin(deadline_t *deadline, uint32_t job, int64_t now_us);
+
+bool deadline_end(deadline_t *deadline, uint32_t job, int64_t now_us);
+
+void deadline_note_block(deadline_t *deadline, uint32_t job, deadline_cause_t cause,
+                         uint32_t blocked_us);
+
+const deadline_overrun_t *deadline_get_overrun(const deadline_t *deadline, uint32_t age);
+
+int deadline_worst_offender(const deadline_t *deadline);
+
+const char *deadline_cause_name(deadline_cause_t cause);
+
+#endif
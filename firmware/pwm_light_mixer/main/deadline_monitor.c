@@ -0,0 +1,398 @@
+/**
+ * @file deadline_monitor.c
+ * @brief Deadline monitoring of periodic jobs, task watchdog recovery
+ *
+ * Jobs (the main loop pass, the output task's frame commit) declare a
+ * budget and bracket each run with begin/end; deadline.c records overruns
+ * with a timestamp and the blocking cause. Causes are reported from the
+ * places that block: deadline_monitor_take() for contended mutexes, the
+ * flash commits in nvs_manager, and a vprintf hook timing every log line.
+ * Blocking is charged to the job owned by the calling task.
+ *
+ * Every job is a task watchdog user. deadline_monitor_periodic(), called
+ * from the main loop, feeds the users of healthy jobs and rate-limits the
+ * overrun report (newest overrun and worst offender). A job that overruns
+ * CONFIG_DEADLINE_STALL_OVERRUNS times in a row, or runs longer than
+ * CONFIG_DEADLINE_STALL_MS, is no longer fed; a stalled main loop feeds
+ * nothing. The task watchdog then resets the chip (CONFIG_ESP_TASK_WDT_PANIC).
+ *
+ * The LED state is mirrored in RTC memory that survives the reset, so
+ * app_main restores the light as it was instead of the last flash commit.
+ */
+
+#include "deadline_monitor.h"
+#include "config.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "esp_system.h"
+#include "esp_task_wdt.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include <stddef.h>
+#include <string.h>
+
+static const char *TAG = "DEADLINE";
+
+#define RECOVERY_MAGIC                0x444C4D31u        ///< "DLM1"
+#define RECOVERY_NAME_LEN             16
+
+// Zero-initialized, as deadline_init() leaves it
+static deadline_t deadline;
+static TaskHandle_t owners[DEADLINE_MAX_JOBS];
+static esp_task_wdt_user_handle_t wdt_users[DEADLINE_MAX_JOBS];
+static bool stall_reported[DEADLINE_MAX_JOBS];
+static bool started = false;
+
+// Guards deadline and owners; jobs run on both cores
+static portMUX_TYPE deadline_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+static vprintf_like_t previous_vprintf = NULL;
+static volatile bool reporting = false;
+
+static uint32_t reported_overruns = 0;
+static int64_t last_report_us = 0;
+
+/** State kept across a watchdog reset (not cleared at boot) */
+typedef struct {
+    uint32_t magic;
+    nvs_led_state_t led;
+    char stalled_job[RECOVERY_NAME_LEN]; ///< Job that stopped feeding the watchdog, "" if none
+    uint32_t stalled_cause;
+    uint32_t crc;
+} deadline_recovery_t;
+
+static RTC_NOINIT_ATTR deadline_recovery_t recovery;
+
+/**
+ * ============================================================================
+ * RECOVERY STATE
+ * ============================================================================
+ */
+
+static uint32_t deadline_recovery_crc(const deadline_recovery_t *record)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)record, offsetof(deadline_recovery_t, crc));
+}
+
+static void deadline_recovery_store(const nvs_led_state_t *led, const char *stalled_job,
+                                    deadline_cause_t cause)
+{
+    deadline_recovery_t record;
+
+    memset(&record, 0, sizeof(record));
+    record.magic = RECOVERY_MAGIC;
+    record.led = *led;
+    if (stalled_job != NULL) {
+        strncpy(record.stalled_job, stalled_job, RECOVERY_NAME_LEN - 1);
+        record.stalled_cause = cause;
+    }
+    record.crc = deadline_recovery_crc(&record);
+
+    memcpy(&recovery, &record, sizeof(record));
+}
+
+static bool deadline_recovery_valid(void)
+{
+    return recovery.magic == RECOVERY_MAGIC && recovery.crc == deadline_recovery_crc(&recovery);
+}
+
+/**
+ * @brief Mirror the LED state in RTC memory (call on every change)
+ */
+void deadline_monitor_keep_led_state(const nvs_led_state_t *state)
+{
+    if (!CONFIG_ENABLE_DEADLINE_MONITOR || state == NULL) {
+        return;
+    }
+
+    if (!deadline_recovery_valid()) {
+        deadline_recovery_store(state, NULL, DEADLINE_CAUSE_CPU);
+        return;
+    }
+
+    // Keep a stalled job recorded until the reset
+    if (recovery.led.pwm_enabled != state->pwm_enabled ||
+        recovery.led.pwm_value != state->pwm_value) {
+        deadline_recovery_store(state, recovery.stalled_job[0] ? recovery.stalled_job : NULL,
+                                recovery.stalled_cause);
+    }
+}
+
+/**
+ * @brief LED state from before a watchdog or panic reset
+ *
+ * @return 0 if the state survived the reset, -1 after a power-on or
+ *         without a valid record
+ */
+int deadline_monitor_recover_led_state(nvs_led_state_t *state)
+{
+    esp_reset_reason_t reason = esp_reset_reason();
+
+    if (!CONFIG_ENABLE_DEADLINE_MONITOR || state == NULL || !deadline_recovery_valid() ||
+        (reason != ESP_RST_TASK_WDT && reason != ESP_RST_INT_WDT && reason != ESP_RST_WDT &&
+         reason != ESP_RST_PANIC && reason != ESP_RST_SW)) {
+        return -1;
+    }
+
+    *state = recovery.led;
+    if (recovery.stalled_job[0] != '\0') {
+        ESP_LOGW(TAG, "Reset after %s stalled (%s), LED state kept: enabled=%d, pwm=%lu",
+                 recovery.stalled_job, deadline_cause_name(recovery.stalled_cause),
+                 state->pwm_enabled, state->pwm_value);
+    } else {
+        ESP_LOGW(TAG, "Reset (reason %d), LED state kept: enabled=%d, pwm=%lu", reason,
+                 state->pwm_enabled, state->pwm_value);
+    }
+
+    // Report a stall once
+    deadline_recovery_store(state, NULL, DEADLINE_CAUSE_CPU);
+    return 0;
+}
+
+/**
+ * ============================================================================
+ * BLOCKING CAUSES
+ * ============================================================================
+ */
+
+/**
+ * @brief Charge blocking since start_us to the calling task's job
+ */
+void deadline_monitor_note_block(deadline_cause_t cause, int64_t start_us)
+{
+    if (!started) {
+        return;
+    }
+
+    uint32_t blocked_us = (uint32_t)(esp_timer_get_time() - start_us);
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+
+    portENTER_CRITICAL(&deadline_spinlock);
+    for (uint32_t i = 0; i < deadline.count; i++) {
+        if (owners[i] == task) {
+            deadline_note_block(&deadline, i, cause, blocked_us);
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&deadline_spinlock);
+}
+
+/**
+ * @brief Take a mutex, charging any wait to the caller's job
+ */
+void deadline_monitor_take(SemaphoreHandle_t mutex)
+{
+    if (xSemaphoreTake(mutex, 0) == pdTRUE) {
+        return;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    deadline_monitor_note_block(DEADLINE_CAUSE_MUTEX, start_us);
+}
+
+/**
+ * @brief Log output hook, times every line
+ */
+static int deadline_monitor_vprintf(const char *format, va_list args)
+{
+    int64_t start_us = esp_timer_get_time();
+    int result = previous_vprintf(format, args);
+
+    // The monitor's own report is not blamed on the job it runs in
+    if (!reporting) {
+        deadline_monitor_note_block(DEADLINE_CAUSE_LOG, start_us);
+    }
+    return result;
+}
+
+/**
+ * ============================================================================
+ * JOBS
+ * ============================================================================
+ */
+
+/**
+ * @brief Declare a job with its budget
+ *
+ * Jobs may be declared during init, before deadline_monitor_start().
+ *
+ * @param name      Job name, must stay valid
+ * @param period_us Period of a periodic job, 0 for an aperiodic one
+ * @param budget_us Longest acceptable run (and start slack)
+ * @return Job handle, -1 if monitoring is disabled or the table is full
+ */
+int deadline_monitor_register(const char *name, uint32_t period_us, uint32_t budget_us)
+{
+    if (!CONFIG_ENABLE_DEADLINE_MONITOR) {
+        return -1;
+    }
+
+    portENTER_CRITICAL(&deadline_spinlock);
+    int job = deadline_register(&deadline, name, period_us, budget_us);
+    portEXIT_CRITICAL(&deadline_spinlock);
+
+    if (job < 0) {
+        ESP_LOGE(TAG, "Cannot monitor %s", name);
+        return -1;
+    }
+
+    ESP_LOGI(TAG, "  %s: budget %lu us, period %lu us", name, budget_us, period_us);
+    return job;
+}
+
+/**
+ * @brief Subscribe the declared jobs to the task watchdog and hook log output
+ *
+ * Call at the end of boot, right before the main loop starts feeding.
+ *
+ * @return 0 on success, -1 if a job could not be subscribed
+ */
+int deadline_monitor_start(void)
+{
+    if (!CONFIG_ENABLE_DEADLINE_MONITOR) {
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < deadline.count; i++) {
+        if (esp_task_wdt_add_user(deadline.jobs[i].name, &wdt_users[i]) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to add %s to the task watchdog", deadline.jobs[i].name);
+            return -1;
+        }
+    }
+
+    previous_vprintf = esp_log_set_vprintf(deadline_monitor_vprintf);
+    started = true;
+
+    ESP_LOGI(TAG, "Monitoring %lu jobs, reset after %d overruns in a row or a %d ms stall",
+             deadline.count, CONFIG_DEADLINE_STALL_OVERRUNS, CONFIG_DEADLINE_STALL_MS);
+    return 0;
+}
+
+/**
+ * @brief Start a run of a job (the calling task becomes its owner)
+ */
+void deadline_monitor_begin(int job)
+{
+    if (job < 0) {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+
+    portENTER_CRITICAL(&deadline_spinlock);
+    owners[job] = task;
+    deadline_begin(&deadline, (uint32_t)job, now_us);
+    portEXIT_CRITICAL(&deadline_spinlock);
+}
+
+/**
+ * @brief End a run of a job
+ */
+void deadline_monitor_end(int job)
+{
+    if (job < 0) {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&deadline_spinlock);
+    deadline_end(&deadline, (uint32_t)job, now_us);
+    portEXIT_CRITICAL(&deadline_spinlock);
+}
+
+/**
+ * @brief Get name and counters of a job
+ */
+int deadline_monitor_get_job(uint32_t index, const char **name, deadline_job_stats_t *stats)
+{
+    if (name == NULL || stats == NULL || index >= deadline.count) {
+        return -1;
+    }
+
+    portENTER_CRITICAL(&deadline_spinlock);
+    *name = deadline.jobs[index].name;
+    *stats = deadline.jobs[index].stats;
+    portEXIT_CRITICAL(&deadline_spinlock);
+
+    return 0;
+}
+
+/**
+ * @brief Log the newest overrun and the worst offender
+ */
+static void deadline_monitor_report(int64_t now_us)
+{
+    deadline_overrun_t newest;
+    deadline_job_t worst_job;
+    uint32_t overruns;
+
+    portENTER_CRITICAL(&deadline_spinlock);
+    overruns = deadline.overruns;
+    newest = *deadline_get_overrun(&deadline, 0);
+    int worst = deadline_worst_offender(&deadline);
+    worst_job = deadline.jobs[(worst < 0) ? newest.job : (uint32_t)worst];
+    const char *newest_name = deadline.jobs[newest.job].name;
+    portEXIT_CRITICAL(&deadline_spinlock);
+
+    reporting = true;
+    ESP_LOGW(TAG, "%lu overruns (+%lu), newest %s at %lld ms: %s %lu/%lu us, %s %lu us",
+             overruns, overruns - reported_overruns, newest_name, newest.time_us / 1000,
+             newest.late_start ? "late by" : "ran", newest.elapsed_us, newest.budget_us,
+             deadline_cause_name(newest.cause), newest.blocked_us);
+    ESP_LOGW(TAG, "Worst offender %s: %lu us against %lu us budget (%s), %lu of %lu runs",
+             worst_job.name, worst_job.stats.worst_us, worst_job.budget_us,
+             deadline_cause_name(worst_job.stats.worst_cause), worst_job.stats.overruns,
+             worst_job.stats.runs);
+    reporting = false;
+
+    reported_overruns = overruns;
+    last_report_us = now_us;
+}
+
+/**
+ * @brief Feed the watchdog for healthy jobs and report overruns
+ *
+ * Called from the main loop, outside the main loop job's run.
+ */
+void deadline_monitor_periodic(void)
+{
+    if (!started) {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+
+    for (uint32_t i = 0; i < deadline.count; i++) {
+        portENTER_CRITICAL(&deadline_spinlock);
+        const deadline_job_t *job = &deadline.jobs[i];
+        bool stalled = job->active &&
+                       now_us - job->start_us > (int64_t)CONFIG_DEADLINE_STALL_MS * 1000;
+        bool healthy = !stalled && job->stats.consecutive < CONFIG_DEADLINE_STALL_OVERRUNS;
+        deadline_cause_t cause = job->stats.worst_cause;
+        portEXIT_CRITICAL(&deadline_spinlock);
+
+        if (healthy) {
+            esp_task_wdt_reset_user(wdt_users[i]);
+            stall_reported[i] = false;
+            continue;
+        }
+
+        if (!stall_reported[i]) {
+            stall_reported[i] = true;
+            ESP_LOGE(TAG, "%s %s, no longer feeding the task watchdog", job->name,
+                     stalled ? "stalled" : "keeps overrunning");
+            if (deadline_recovery_valid()) {
+                deadline_recovery_store(&recovery.led, job->name, cause);
+            }
+        }
+    }
+
+    if (deadline.overruns != reported_overruns &&
+        now_us - last_report_us >= (int64_t)CONFIG_DEADLINE_REPORT_INTERVAL_MS * 1000) {
+        deadline_monitor_report(now_us);
+    }
+}
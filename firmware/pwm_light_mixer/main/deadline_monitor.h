@@ -0,0 +1,31 @@
+#ifndef DEADLINE_MONITOR_H
+#define DEADLINE_MONITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "deadline.h"
+#include "nvs_manager.h"
+
+int deadline_monitor_register(const char *name, uint32_t period_us, uint32_t budget_us);
+
+int deadline_monitor_start(void);
+
+void deadline_monitor_begin(int job);
+
+void deadline_monitor_end(int job);
+
+void deadline_monitor_note_block(deadline_cause_t cause, int64_t start_us);
+
+void deadline_monitor_take(SemaphoreHandle_t mutex);
+
+void deadline_monitor_periodic(void);
+
+int deadline_monitor_get_job(uint32_t index, const char **name, deadline_job_stats_t *stats);
+
+void deadline_monitor_keep_led_state(const nvs_led_state_t *state);
+
+int deadline_monitor_recover_led_state(nvs_led_state_t *state);
+
+#endif
@@ -1,9 +1,13 @@
 #include "encoder.h"
 #include "config.h"
+#include "input_events.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/semphr.h"
+#include "esp_attr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "hal/gpio_ll.h"
+#include "soc/gpio_struct.h"
 #include <stdio.h>
 
 static const char *TAG = "ENCODER";
@@ -19,9 +23,9 @@ static const char *TAG = "ENCODER";
 #define ENCODER_POS_MAX               255
 #define ENCODER_INITIAL_POS           CONFIG_ENCODER_INITIAL_POS
 
-// Scale factors for acceleration
-static const uint32_t SCALE_FACTORS[] = CONFIG_ENCODER_SCALE_FACTORS;
-static const uint32_t NUM_SCALES = CONFIG_ENCODER_NUM_SCALES;
+// Scale factors for acceleration (in DRAM, read from the timer ISR)
+static DRAM_ATTR const uint32_t SCALE_FACTORS[] = CONFIG_ENCODER_SCALE_FACTORS;
+static DRAM_ATTR const uint32_t NUM_SCALES = CONFIG_ENCODER_NUM_SCALES;
 
 // Encoder state variables
 static volatile int32_t encoder_position = ENCODER_INITIAL_POS;
@@ -31,31 +35,33 @@ static volatile int last_clk_state = 0;
 static volatile int last_dt_state = 0;
 static volatile uint32_t current_scale_index = 0;
 
-// Thread synchronization
-static SemaphoreHandle_t encoder_mutex = NULL;
+// Guards the state above; the sampling callback may run in the timer ISR
+static portMUX_TYPE encoder_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+static esp_timer_handle_t sample_timer = NULL;
 
 /**
  * @brief Read current button state (active low)
  */
-static bool encoder_read_button(void)
+static IRAM_ATTR bool encoder_read_button(void)
 {
-    return gpio_get_level(CONFIG_ENCODER_SW_PIN) == 0;
+    return gpio_ll_get_level(&GPIO, CONFIG_ENCODER_SW_PIN) == 0;
 }
 
 /**
  * @brief Read current CLK pin state
  */
-static int encoder_read_clk(void)
+static IRAM_ATTR int encoder_read_clk(void)
 {
-    return gpio_get_level(CONFIG_ENCODER_CLK_PIN);
+    return gpio_ll_get_level(&GPIO, CONFIG_ENCODER_CLK_PIN);
 }
 
 /**
  * @brief Read current DT pin state
  */
-static int encoder_read_dt(void)
+static IRAM_ATTR int encoder_read_dt(void)
 {
-    return gpio_get_level(CONFIG_ENCODER_DT_PIN);
+    return gpio_ll_get_level(&GPIO, CONFIG_ENCODER_DT_PIN);
 }
 
 /**
@@ -68,7 +74,7 @@ static int encoder_read_dt(void)
  * CW:  00->01->11->10->00
  * CCW: 00->10->11->01->00
  */
-static void encoder_update_position(void)
+static IRAM_ATTR void encoder_update_position(void)
 {
     int clk_state = encoder_read_clk();
     int dt_state = encoder_read_dt();
@@ -105,8 +111,7 @@ static void encoder_update_position(void)
             direction = 0;
         }
         
-        // Update position with mutex protection
-        xSemaphoreTake(encoder_mutex, portMAX_DELAY);
+        portENTER_CRITICAL_SAFE(&encoder_spinlock);
         
         int32_t old_pos = encoder_position;
         
@@ -124,15 +129,13 @@ static void encoder_update_position(void)
             }
         }
         
-        if (encoder_position != old_pos) {
-            ESP_LOGI(TAG, "%s: %d->%d | pos %ld->%ld (scale=%lu)", 
-                     direction > 0 ? "CW" : "CCW", 
-                     prev_state, curr_state, old_pos, encoder_position, scale);
-        } else if (direction == 0) {
-            ESP_LOGD(TAG, "Invalid: %d->%d", prev_state, curr_state);
-        }
+        int32_t new_pos = encoder_position;
+        portEXIT_CRITICAL_SAFE(&encoder_spinlock);
         
-        xSemaphoreGive(encoder_mutex);
+        // No logging here, this may run in the timer ISR; the main loop logs
+        if (new_pos != old_pos) {
+            input_events_post(INPUT_EVENT_ENCODER, new_pos);
+        }
     }
     
     last_clk_state = clk_state;
@@ -140,81 +143,65 @@ static void encoder_update_position(void)
 }
 
 /**
- * @brief RTOS task for encoder reading
+ * @brief Sampling timer callback (timer ISR or esp_timer task)
  * 
- * Monitors encoder CLK/DT pins and button state. Updates position on
- * quadrature state changes and counts button press events.
+ * Samples the button and the CLK/DT pins every CONFIG_ENCODER_POLL_INTERVAL.
+ * Counts button presses, cycling the scale factor, and updates the position
+ * on quadrature state changes, posting an input event for each change.
  * 
- * @param pvParameters Task parameters (unused)
+ * @param arg Timer argument (unused)
  */
-static void encoder_task(void *pvParameters)
+static IRAM_ATTR void encoder_sample_callback(void *arg)
 {
-    ESP_LOGI(TAG, "Encoder task started");
+    static bool last_button_state = false;
     
-    bool last_button_state = false;
-    int32_t last_logged_position = encoder_position;
-    uint32_t log_counter = 0;
+    bool current_button_state = encoder_read_button();
     
-    while (1) {
-        // Read button state
-        bool current_button_state = encoder_read_button();
-        
-        if (current_button_state && !last_button_state) {
-            // Button pressed (falling edge)
-            xSemaphoreTake(encoder_mutex, portMAX_DELAY);
-            button_press_count++;
-            button_pressed = true;
-            
-            // Cycle scale factor
-            current_scale_index = (current_scale_index + 1) % NUM_SCALES;
-            uint32_t new_scale = SCALE_FACTORS[current_scale_index];
-            
-            ESP_LOGI(TAG, "Button pressed! Count: %lu | Scale factor changed to: %lu", 
-                     button_press_count, new_scale);
-            xSemaphoreGive(encoder_mutex);
-        } else if (!current_button_state && last_button_state) {
-            // Button released
-            xSemaphoreTake(encoder_mutex, portMAX_DELAY);
-            button_pressed = false;
-            ESP_LOGI(TAG, "Button released");
-            xSemaphoreGive(encoder_mutex);
-        }
-        
-        last_button_state = current_button_state;
+    if (current_button_state && !last_button_state) {
+        // Button pressed (falling edge), cycle scale factor
+        portENTER_CRITICAL_SAFE(&encoder_spinlock);
+        button_press_count++;
+        button_pressed = true;
+        current_scale_index = (current_scale_index + 1) % NUM_SCALES;
+        uint32_t count = button_press_count;
+        portEXIT_CRITICAL_SAFE(&encoder_spinlock);
         
-        // Update encoder position
-        encoder_update_position();
-        
-        // Log position periodically if it changes
-        if (++log_counter >= 50) {  // Log every 500ms (50 * 10ms)
-            log_counter = 0;
-            int32_t current_pos = encoder_get_position();
-            if (current_pos != last_logged_position) {
-                ESP_LOGI(TAG, "Position changed: %ld", current_pos);
-                last_logged_position = current_pos;
-            }
-        }
-        
-        // Polling interval (set in config, typically 10ms)
-        vTaskDelay(CONFIG_ENCODER_POLL_INTERVAL / portTICK_PERIOD_MS);
+        input_events_post(INPUT_EVENT_BUTTON, (int32_t)count);
+    } else if (!current_button_state && last_button_state) {
+        // Button released
+        portENTER_CRITICAL_SAFE(&encoder_spinlock);
+        button_pressed = false;
+        portEXIT_CRITICAL_SAFE(&encoder_spinlock);
     }
+    
+    last_button_state = current_button_state;
+    
+    // Update encoder position
+    encoder_update_position();
 }
 
 /**
  * @brief Initialize the rotary encoder
  * 
- * Configures GPIO pins for CLK, DT, and SW with pull-ups.
- * Creates synchronization mutex for thread-safe state access.
+ * Configures GPIO pins for CLK, DT, and SW with pull-ups and creates the
+ * sampling timer. Sampling starts with encoder_start().
+ *
+ * @return 0 on success, -1 if the sampling timer could not be created (the
+ *         other encoder functions must not be called then)
  */
-void encoder_init(void)
+int encoder_init(void)
 {
     ESP_LOGI(TAG, "Initializing rotary encoder");
     
-    // Create mutex for thread-safe access
-    encoder_mutex = xSemaphoreCreateMutex();
-    if (encoder_mutex == NULL) {
-        ESP_LOGE(TAG, "Failed to create mutex");
-        return;
+    const esp_timer_create_args_t timer_args = {
+        .callback = encoder_sample_callback,
+        .dispatch_method = INPUT_TIMER_DISPATCH,
+        .name = "encoder_sample",
+        .skip_unhandled_events = true
+    };
+    if (esp_timer_create(&timer_args, &sample_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create sampling timer");
+        return -1;
     }
     
     // Configure GPIO for CLK pin
@@ -259,25 +246,26 @@ void encoder_init(void)
     ESP_LOGI(TAG, "Encoder initial state: CLK=%d, DT=%d", last_clk_state, last_dt_state);
     ESP_LOGI(TAG, "Encoder polling interval: %d ms", CONFIG_ENCODER_POLL_INTERVAL);
     ESP_LOGI(TAG, "Starting position: %ld / 255", encoder_position);
+    return 0;
 }
 
 /**
- * @brief Start the encoder RTOS task
+ * @brief Start sampling the encoder
  * 
- * Creates and starts the background task that continuously monitors
- * encoder position and button events.
+ * Starts the periodic timer that monitors encoder position and button
+ * events. Changes are posted to the input event queue.
+ *
+ * @return 0 on success, -1 on failure
  */
-void encoder_task_start(void)
+int encoder_start(void)
 {
-    xTaskCreate(
-        encoder_task,                      // Task function
-        "encoder_task",                    // Task name
-        CONFIG_ENCODER_TASK_STACK,         // Stack size
-        NULL,                              // Task parameters
-        CONFIG_ENCODER_TASK_PRIORITY,      // Priority
-        NULL                               // Task handle
-    );
-    ESP_LOGI(TAG, "Encoder RTOS task created");
+    if (esp_timer_start_periodic(sample_timer, CONFIG_ENCODER_POLL_INTERVAL * 1000) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start sampling timer");
+        return -1;
+    }
+
+    ESP_LOGI(TAG, "Encoder sampling started");
+    return 0;
 }
 
 /**
@@ -286,9 +274,9 @@ void encoder_task_start(void)
 int32_t encoder_get_position(void)
 {
     int32_t pos;
-    xSemaphoreTake(encoder_mutex, portMAX_DELAY);
+    portENTER_CRITICAL(&encoder_spinlock);
     pos = encoder_position;
-    xSemaphoreGive(encoder_mutex);
+    portEXIT_CRITICAL(&encoder_spinlock);
     return pos;
 }
 
@@ -297,10 +285,10 @@ int32_t encoder_get_position(void)
  */
 void encoder_reset_position(void)
 {
-    xSemaphoreTake(encoder_mutex, portMAX_DELAY);
+    portENTER_CRITICAL(&encoder_spinlock);
     encoder_position = 0;
+    portEXIT_CRITICAL(&encoder_spinlock);
     ESP_LOGI(TAG, "Encoder position reset to 0");
-    xSemaphoreGive(encoder_mutex);
 }
 
 /**
@@ -309,9 +297,9 @@ void encoder_reset_position(void)
 uint32_t encoder_get_button_press_count(void)
 {
     uint32_t count;
-    xSemaphoreTake(encoder_mutex, portMAX_DELAY);
+    portENTER_CRITICAL(&encoder_spinlock);
     count = button_press_count;
-    xSemaphoreGive(encoder_mutex);
+    portEXIT_CRITICAL(&encoder_spinlock);
     return count;
 }
 
@@ -321,9 +309,9 @@ uint32_t encoder_get_button_press_count(void)
 bool encoder_is_button_pressed(void)
 {
     bool pressed;
-    xSemaphoreTake(encoder_mutex, portMAX_DELAY);
+    portENTER_CRITICAL(&encoder_spinlock);
     pressed = button_pressed;
-    xSemaphoreGive(encoder_mutex);
+    portEXIT_CRITICAL(&encoder_spinlock);
     return pressed;
 }
 
@@ -332,10 +320,10 @@ bool encoder_is_button_pressed(void)
  */
 void encoder_reset_button_count(void)
 {
-    xSemaphoreTake(encoder_mutex, portMAX_DELAY);
+    portENTER_CRITICAL(&encoder_spinlock);
     button_press_count = 0;
+    portEXIT_CRITICAL(&encoder_spinlock);
     ESP_LOGI(TAG, "Button press count reset");
-    xSemaphoreGive(encoder_mutex);
 }
 
 /**
@@ -343,7 +331,7 @@ void encoder_reset_button_count(void)
  */
 void encoder_set_position(int32_t position)
 {
-    xSemaphoreTake(encoder_mutex, portMAX_DELAY);
+    portENTER_CRITICAL(&encoder_spinlock);
     
     // Clamp position to valid range
     if (position < ENCODER_POS_MIN) {
@@ -353,9 +341,10 @@ void encoder_set_position(int32_t position)
     } else {
         encoder_position = position;
     }
+    position = encoder_position;
     
-    ESP_LOGI(TAG, "Encoder position set to %ld", encoder_position);
-    xSemaphoreGive(encoder_mutex);
+    portEXIT_CRITICAL(&encoder_spinlock);
+    ESP_LOGI(TAG, "Encoder position set to %ld", position);
 }
 
 /**
@@ -363,12 +352,12 @@ void encoder_set_position(int32_t position)
  */
 void encoder_get_state(encoder_state_t *state)
 {
-    xSemaphoreTake(encoder_mutex, portMAX_DELAY);
+    portENTER_CRITICAL(&encoder_spinlock);
     state->position = encoder_position;
     state->button_press_count = button_press_count;
     state->button_pressed = button_pressed;
     state->scale_factor = SCALE_FACTORS[current_scale_index];
-    xSemaphoreGive(encoder_mutex);
+    portEXIT_CRITICAL(&encoder_spinlock);
 }
 /**
  * @brief Diagnostic: Get raw pin states
@@ -401,9 +390,9 @@ void encoder_log_diagnostic(void)
 uint32_t encoder_get_scale_factor(void)
 {
     uint32_t scale;
-    xSemaphoreTake(encoder_mutex, portMAX_DELAY);
+    portENTER_CRITICAL(&encoder_spinlock);
     scale = SCALE_FACTORS[current_scale_index];
-    xSemaphoreGive(encoder_mutex);
+    portEXIT_CRITICAL(&encoder_spinlock);
     return scale;
 }
 
@@ -412,9 +401,9 @@ uint32_t encoder_get_scale_factor(void)
  */
 void encoder_cycle_scale_factor(void)
 {
-    xSemaphoreTake(encoder_mutex, portMAX_DELAY);
+    portENTER_CRITICAL(&encoder_spinlock);
     current_scale_index = (current_scale_index + 1) % NUM_SCALES;
     uint32_t new_scale = SCALE_FACTORS[current_scale_index];
+    portEXIT_CRITICAL(&encoder_spinlock);
     ESP_LOGI(TAG, "Scale factor cycled to: %lu", new_scale);
-    xSemaphoreGive(encoder_mutex);
 }
@@ -11,9 +11,9 @@ typedef struct {
     uint32_t scale_factor;
 } encoder_state_t;
 
-void encoder_init(void);
+int encoder_init(void);
 
-void encoder_task_start(void);
+int encoder_start(void);
 
 int32_t encoder_get_position(void);
 
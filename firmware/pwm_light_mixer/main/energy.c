@@ -0,0 +1,164 @@
+/**
+ * @file energy.c
+ * @brief Energy metering and LED lifetime estimation
+ *
+ * Owns the energy meter. The pwm_controller frame commit reports every new
+ * set of outputs, so energy and on-time are integrated incrementally with
+ * no polling; the thermal module supplies the temperature for the usage
+ * histogram.
+ *
+ * Totals are persisted through nvs_manager, whose commit policy bounds the
+ * write rate (at most one write per CONFIG_ENERGY_PERSIST_INTERVAL_MS while
+ * the light is on, none while it is off). A power cut loses at most that
+ * interval of metering.
+ */
+
+#include "energy.h"
+#include "config.h"
+#include "pwm_controller.h"
+#include "nvs_manager.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "ENERGY";
+
+_Static_assert(ENERGY_METER_CHANNELS == PWM_CHANNEL_COUNT,
+               "Energy meter must cover every PWM channel");
+
+static energy_meter_t meter;
+
+// Serializes frame updates (pwm_controller) against readers
+static SemaphoreHandle_t energy_mutex = NULL;
+static StaticSemaphore_t energy_mutex_buffer;
+
+/**
+ * @brief Initialize an empty meter
+ *
+ * Must run before pwm_controller_init() so the first frame is metered;
+ * persisted totals are merged later by energy_load().
+ */
+int energy_init(void)
+{
+    energy_mutex = xSemaphoreCreateMutexStatic(&energy_mutex_buffer);
+    if (energy_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex");
+        return -1;
+    }
+
+    energy_meter_init(&meter, OUTPUT_DUTY_MAX);
+    return 0;
+}
+
+/**
+ * @brief Merge persisted totals into the meter (storage must be up)
+ */
+int energy_load(void)
+{
+    energy_meter_data_t saved;
+
+    if (energy_mutex == NULL) {
+        return -1;
+    }
+
+    if (nvs_manager_load_energy(&saved) != 0) {
+        ESP_LOGI(TAG, "No saved energy totals, starting from zero");
+        return 0;
+    }
+
+    xSemaphoreTake(energy_mutex, portMAX_DELAY);
+    energy_meter_restore(&meter, &saved);
+    xSemaphoreGive(energy_mutex);
+
+    for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+        energy_summary_t summary;
+        energy_get_summary(i, &summary);
+        ESP_LOGI(TAG, "LED %lu: %lu Wh, %lu h on, %lu ppm of rated life used",
+                 i + 1, summary.energy_wh, summary.on_hours, summary.life_used_ppm);
+    }
+    return 0;
+}
+
+/**
+ * @brief Report the outputs of a committed frame
+ *
+ * Called by pwm_controller with its own mutex held.
+ */
+void energy_note_frame(const uint32_t *duty, const uint32_t *power_mw)
+{
+    if (energy_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(energy_mutex, portMAX_DELAY);
+    energy_meter_set_outputs(&meter, esp_timer_get_time(), duty, power_mw);
+    xSemaphoreGive(energy_mutex);
+}
+
+/**
+ * @brief Report the current fixture temperature
+ */
+void energy_note_temperature(int32_t temp_dc)
+{
+    if (energy_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(energy_mutex, portMAX_DELAY);
+    energy_meter_advance(&meter, esp_timer_get_time());
+    energy_meter_set_temperature(&meter, temp_dc);
+    xSemaphoreGive(energy_mutex);
+}
+
+/**
+ * @brief Get the full usage data, including the running interval
+ */
+int energy_get_data(energy_meter_data_t *data)
+{
+    if (data == NULL || energy_mutex == NULL) {
+        return -1;
+    }
+
+    xSemaphoreTake(energy_mutex, portMAX_DELAY);
+    energy_meter_advance(&meter, esp_timer_get_time());
+    *data = meter.data;
+    xSemaphoreGive(energy_mutex);
+
+    return 0;
+}
+
+/**
+ * @brief Get energy, on-time and life estimate of one channel
+ */
+int energy_get_summary(uint32_t channel, energy_summary_t *summary)
+{
+    if (channel >= PWM_CHANNEL_COUNT || summary == NULL || energy_mutex == NULL) {
+        return -1;
+    }
+
+    xSemaphoreTake(energy_mutex, portMAX_DELAY);
+    energy_meter_advance(&meter, esp_timer_get_time());
+    const energy_meter_channel_t *data = &meter.data.channels[channel];
+    summary->energy_wh = (uint32_t)(data->energy_uj / 3600000000ULL);
+    summary->on_hours = data->on_time_s / 3600;
+    summary->life_used_ppm = energy_meter_life_used_ppm(data, CONFIG_LED_RATED_L70_HOURS);
+    xSemaphoreGive(energy_mutex);
+
+    return 0;
+}
+
+/**
+ * @brief Queue the current totals for a policy-paced flash write
+ *
+ * Called periodically from the main loop.
+ */
+int energy_persist(void)
+{
+    energy_meter_data_t data;
+
+    if (energy_get_data(&data) != 0) {
+        return -1;
+    }
+    return nvs_manager_save_energy(&data);
+}
@@ -0,0 +1,28 @@
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "energy_meter.h"
+
+typedef struct {
+    uint32_t energy_wh;             ///< Cumulative energy in watt-hours
+    uint32_t on_hours;              ///< Cumulative time at non-zero duty
+    uint32_t life_used_ppm;         ///< Estimated share of rated L70 life used
+} energy_summary_t;
+
+int energy_init(void);
+
+int energy_load(void);
+
+void energy_note_frame(const uint32_t *duty, const uint32_t *power_mw);
+
+void energy_note_temperature(int32_t temp_dc);
+
+int energy_get_data(energy_meter_data_t *data);
+
+int energy_get_summary(uint32_t channel, energy_summary_t *summary);
+
+int energy_persist(void);
+
+#endif
@@ -0,0 +1,160 @@
+/**
+ * @file energy_meter.c
+ * @brief Per-channel energy integration and LED usage histogram
+ *
+ * Outputs are piecewise constant between frame commits, so energy is
+ * integrated exactly by closing the running interval (power x elapsed time)
+ * whenever the outputs change. On-time is binned by duty and temperature;
+ * the histogram feeds a lumen-depreciation estimate that weights each bin
+ * by its average drive and a temperature acceleration factor.
+ *
+ * Pure logic with caller-supplied microsecond timestamps, so the same code
+ * runs on target and in host simulations.
+ */
+
+#include "energy_meter.h"
+#include <string.h>
+
+#define ENERGY_US_PER_S               1000000u
+
+/** Upper temperature bound of each bin but the last (0.1 °C) */
+static const int32_t TEMP_BIN_EDGES_DC[ENERGY_METER_TEMP_BINS - 1] = {
+    450, 550, 650, 750, 850
+};
+
+/** Depreciation acceleration per temperature bin (Q8): life halves every 20 C */
+static const uint32_t TEMP_BIN_WEIGHT_Q8[ENERGY_METER_TEMP_BINS] = {
+    256, 362, 512, 724, 1024, 1448
+};
+
+/**
+ * @brief Temperature bin of the current reading
+ */
+static uint32_t energy_meter_temp_bin(int32_t temp_dc)
+{
+    uint32_t bin = 0;
+    while (bin < ENERGY_METER_TEMP_BINS - 1 && temp_dc >= TEMP_BIN_EDGES_DC[bin]) {
+        bin++;
+    }
+    return bin;
+}
+
+/**
+ * @brief Initialize an empty meter (25 °C until a temperature is supplied)
+ */
+void energy_meter_init(energy_meter_t *meter, uint32_t max_duty)
+{
+    memset(meter, 0, sizeof(*meter));
+    meter->max_duty = max_duty;
+    meter->temp_dc = 250;
+}
+
+/**
+ * @brief Add previously persisted totals to the running meter
+ *
+ * Usage accumulated since boot (before storage was up) is kept.
+ */
+void energy_meter_restore(energy_meter_t *meter, const energy_meter_data_t *saved)
+{
+    for (uint32_t ch = 0; ch < ENERGY_METER_CHANNELS; ch++) {
+        energy_meter_channel_t *dst = &meter->data.channels[ch];
+        const energy_meter_channel_t *src = &saved->channels[ch];
+
+        dst->energy_uj += src->energy_uj;
+        dst->on_time_s += src->on_time_s;
+        for (uint32_t t = 0; t < ENERGY_METER_TEMP_BINS; t++) {
+            for (uint32_t d = 0; d < ENERGY_METER_DUTY_BINS; d++) {
+                dst->histogram_s[t][d] += src->histogram_s[t][d];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Set the temperature used for binning from now on
+ */
+void energy_meter_set_temperature(energy_meter_t *meter, int32_t temp_dc)
+{
+    meter->temp_dc = temp_dc;
+}
+
+/**
+ * @brief Close the running interval up to now, keeping the outputs
+ */
+void energy_meter_advance(energy_meter_t *meter, int64_t now_us)
+{
+    if (!meter->started || now_us <= meter->last_us) {
+        meter->started = true;
+        meter->last_us = now_us;
+        return;
+    }
+
+    uint64_t elapsed_us = (uint64_t)(now_us - meter->last_us);
+    uint32_t temp_bin = energy_meter_temp_bin(meter->temp_dc);
+    meter->last_us = now_us;
+
+    for (uint32_t ch = 0; ch < ENERGY_METER_CHANNELS; ch++) {
+        energy_meter_channel_t *channel = &meter->data.channels[ch];
+
+        if (meter->duty[ch] == 0) {
+            continue;
+        }
+
+        // mW x us = nJ
+        channel->energy_uj += ((uint64_t)meter->power_mw[ch] * elapsed_us) / 1000u;
+
+        meter->pending_us[ch] += elapsed_us;
+        if (meter->pending_us[ch] >= ENERGY_US_PER_S) {
+            uint32_t seconds = (uint32_t)(meter->pending_us[ch] / ENERGY_US_PER_S);
+            uint32_t duty_bin = (uint32_t)(((uint64_t)meter->duty[ch] * ENERGY_METER_DUTY_BINS) /
+                                           (meter->max_duty + 1));
+
+            channel->histogram_s[temp_bin][duty_bin] += seconds;
+            channel->on_time_s += seconds;
+            meter->pending_us[ch] -= (uint64_t)seconds * ENERGY_US_PER_S;
+        }
+    }
+}
+
+/**
+ * @brief Close the running interval and start a new one with new outputs
+ */
+void energy_meter_set_outputs(energy_meter_t *meter, int64_t now_us,
+                              const uint32_t *duty, const uint32_t *power_mw)
+{
+    energy_meter_advance(meter, now_us);
+
+    for (uint32_t ch = 0; ch < ENERGY_METER_CHANNELS; ch++) {
+        meter->duty[ch] = duty[ch];
+        meter->power_mw[ch] = power_mw[ch];
+    }
+}
+
+/**
+ * @brief Estimated share of the rated L70 life already used, in ppm
+ *
+ * Each histogram bin counts as (time x bin-centre duty x temperature
+ * weight) hours at the rating conditions (full drive, below 45 °C).
+ */
+uint32_t energy_meter_life_used_ppm(const energy_meter_channel_t *channel, uint32_t rated_hours)
+{
+    uint64_t weighted = 0;
+
+    if (rated_hours == 0) {
+        return 0;
+    }
+
+    for (uint32_t t = 0; t < ENERGY_METER_TEMP_BINS; t++) {
+        for (uint32_t d = 0; d < ENERGY_METER_DUTY_BINS; d++) {
+            // Bin centre duty as (2d + 1) / (2 x bins)
+            weighted += (uint64_t)channel->histogram_s[t][d] * (2 * d + 1) * TEMP_BIN_WEIGHT_Q8[t];
+        }
+    }
+
+    // weighted = seconds x (2 x bins) x 256 at rating conditions
+    uint64_t rated = (uint64_t)rated_hours * 3600u * (2 * ENERGY_METER_DUTY_BINS) * 256u;
+
+    // Split to keep weighted x 10^6 from overflowing after years of use
+    uint64_t ppm = (weighted / rated) * 1000000u + ((weighted % rated) * 1000000u) / rated;
+    return ppm > UINT32_MAX ? UINT32_MAX : (uint32_t)ppm;
+}
@@ -0,0 +1,46 @@
+#ifndef ENERGY_METER_H
+#define ENERGY_METER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ENERGY_METER_CHANNELS         2
+#define ENERGY_METER_DUTY_BINS        8                  ///< Equal-width duty ranges
+#define ENERGY_METER_TEMP_BINS        6                  ///< <45, 45-55, ..., >=85 C
+
+/** Persisted per-channel usage; survives reboots */
+typedef struct {
+    uint64_t energy_uj;             ///< Cumulative electrical energy in microjoule
+    uint32_t on_time_s;             ///< Time spent at non-zero duty
+    uint32_t histogram_s[ENERGY_METER_TEMP_BINS][ENERGY_METER_DUTY_BINS];
+} energy_meter_channel_t;
+
+typedef struct {
+    energy_meter_channel_t channels[ENERGY_METER_CHANNELS];
+} energy_meter_data_t;
+
+typedef struct {
+    energy_meter_data_t data;
+    uint32_t max_duty;
+    uint32_t duty[ENERGY_METER_CHANNELS];       ///< Output of the running interval
+    uint32_t power_mw[ENERGY_METER_CHANNELS];   ///< Power of the running interval
+    uint64_t pending_us[ENERGY_METER_CHANNELS]; ///< On-time not yet in the histogram
+    int32_t temp_dc;
+    int64_t last_us;
+    bool started;
+} energy_meter_t;
+
+void energy_meter_init(energy_meter_t *meter, uint32_t max_duty);
+
+void energy_meter_restore(energy_meter_t *meter, const energy_meter_data_t *saved);
+
+void energy_meter_set_temperature(energy_meter_t *meter, int32_t temp_dc);
+
+void energy_meter_advance(energy_meter_t *meter, int64_t now_us);
+
+void energy_meter_set_outputs(energy_meter_t *meter, int64_t now_us,
+                              const uint32_t *duty, const uint32_t *power_mw);
+
+uint32_t energy_meter_life_used_ppm(const energy_meter_channel_t *channel, uint32_t rated_hours);
+
+#endif
@@ -0,0 +1,274 @@
+/**
+ * @file flicker_metrics.c
+ * @brief Flicker quality metrics for simulated light output
+ *
+ * Takes a light waveform as a timeline of edges (level held until the next
+ * edge), as produced from simulated PWM output, and computes over the window
+ * from the first edge to end_ns:
+ *
+ * - Percent flicker and flicker index (IES): exact, from the segments
+ * - SVM, the stroboscopic visibility measure of IEC TR 63158, as the worst
+ *   of consecutive svm_window_ms windows (or the whole waveform if it is
+ *   shorter): each window is box-filtered into sample_ns samples, every Fourier component from
+ *   80 Hz to 2 kHz is evaluated with rotating phasors (the box filter's
+ *   attenuation is divided out), and each relative amplitude C_m is
+ *   weighed against the visibility threshold
+ *   T(f) = 1 / (1 + exp(-0.00518 (f - 306.6))) + 20 exp(-f / 10);
+ *   SVM = (sum (C_m / T_m)^3.7)^(1 / 3.7), 1 being just visible
+ * - Step visibility for fades: the mean level over consecutive
+ *   step_window_us windows, counting steps whose relative size exceeds
+ *   step_threshold; windows should span whole PWM periods so the carrier
+ *   itself does not show up as steps
+ *
+ * Plain PWM is 100 % flicker by the first two measures whatever its
+ * frequency; SVM and the step metric are the ones that separate carrier
+ * frequency, dithering and fade quality.
+ *
+ * Host-only: uses floating point and static scratch arrays, and is not part
+ * of the firmware build.
+ */
+
+#include "flicker_metrics.h"
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define FLICKER_PI                    3.14159265358979323846
+#define FLICKER_RENORMALIZE           1024               ///< Samples between phasor renormalization
+
+typedef struct {
+    const flicker_edge_t *edges;
+    uint32_t count;
+    uint32_t index;                 ///< Segment containing pos_ns
+    int64_t end_ns;
+    int64_t pos_ns;
+} flicker_cursor_t;
+
+// SVM accumulators and phasors, one per harmonic
+static double acc_re[FLICKER_MAX_BINS], acc_im[FLICKER_MAX_BINS];
+static double rot_re[FLICKER_MAX_BINS], rot_im[FLICKER_MAX_BINS];
+static double step_re[FLICKER_MAX_BINS], step_im[FLICKER_MAX_BINS];
+
+/**
+ * @brief Integrate the level from the cursor up to a time (in level x ns)
+ */
+static double flicker_integrate(flicker_cursor_t *cursor, int64_t until_ns)
+{
+    double area = 0.0;
+
+    while (cursor->pos_ns < until_ns) {
+        while (cursor->index + 1 < cursor->count &&
+               cursor->edges[cursor->index + 1].time_ns <= cursor->pos_ns) {
+            cursor->index++;
+        }
+
+        int64_t segment_end = (cursor->index + 1 < cursor->count) ?
+                              cursor->edges[cursor->index + 1].time_ns : cursor->end_ns;
+        if (segment_end > until_ns) {
+            segment_end = until_ns;
+        }
+
+        area += cursor->edges[cursor->index].level * (double)(segment_end - cursor->pos_ns);
+        cursor->pos_ns = segment_end;
+    }
+
+    return area;
+}
+
+static void flicker_cursor_init(flicker_cursor_t *cursor, const flicker_edge_t *edges,
+                                uint32_t count, int64_t end_ns)
+{
+    cursor->edges = edges;
+    cursor->count = count;
+    cursor->index = 0;
+    cursor->end_ns = end_ns;
+    cursor->pos_ns = edges[0].time_ns;
+}
+
+/**
+ * @brief Stroboscopic visibility threshold at a frequency
+ */
+static double flicker_svm_threshold(double freq_hz)
+{
+    return 1.0 / (1.0 + exp(-0.00518 * (freq_hz - 306.6))) + 20.0 * exp(-freq_hz / 10.0);
+}
+
+/**
+ * @brief SVM over one window
+ *
+ * @return SVM, or -1 if the window holds more harmonics than FLICKER_MAX_BINS
+ */
+static double flicker_svm(const flicker_edge_t *edges, uint32_t count, int64_t start_ns,
+                          int64_t end_ns, uint32_t sample_ns)
+{
+    uint64_t samples = (uint64_t)(end_ns - start_ns) / sample_ns;
+    double window_s = (double)(samples * sample_ns) * 1e-9;
+    uint32_t first = (uint32_t)ceil(FLICKER_SVM_MIN_HZ * window_s);
+    uint32_t last = (uint32_t)floor(FLICKER_SVM_MAX_HZ * window_s);
+
+    if (samples == 0 || last < first) {
+        return 0.0;
+    }
+    if (last - first + 1 > FLICKER_MAX_BINS) {
+        return -1.0;
+    }
+
+    uint32_t bins = last - first + 1;
+    double sample_s = sample_ns * 1e-9;
+    for (uint32_t b = 0; b < bins; b++) {
+        double omega = 2.0 * FLICKER_PI * (first + b) / window_s;
+        acc_re[b] = 0.0;
+        acc_im[b] = 0.0;
+        rot_re[b] = cos(-omega * 0.5 * sample_s);     // Sample centers
+        rot_im[b] = sin(-omega * 0.5 * sample_s);
+        step_re[b] = cos(-omega * sample_s);
+        step_im[b] = sin(-omega * sample_s);
+    }
+
+    flicker_cursor_t cursor;
+    flicker_cursor_init(&cursor, edges, count, end_ns);
+    flicker_integrate(&cursor, start_ns);
+
+    double total = 0.0;
+    for (uint64_t n = 0; n < samples; n++) {
+        double x = flicker_integrate(&cursor, start_ns + (int64_t)((n + 1) * sample_ns)) /
+                   sample_ns;
+        total += x;
+        bool renormalize = ((n + 1) % FLICKER_RENORMALIZE) == 0;
+
+        for (uint32_t b = 0; b < bins; b++) {
+            acc_re[b] += x * rot_re[b];
+            acc_im[b] += x * rot_im[b];
+
+            double re = rot_re[b] * step_re[b] - rot_im[b] * step_im[b];
+            double im = rot_re[b] * step_im[b] + rot_im[b] * step_re[b];
+            if (renormalize) {
+                double norm = sqrt(re * re + im * im);
+                re /= norm;
+                im /= norm;
+            }
+            rot_re[b] = re;
+            rot_im[b] = im;
+        }
+    }
+
+    double mean_level = total / samples;
+    if (mean_level <= 0.0) {
+        return 0.0;
+    }
+
+    double sum = 0.0;
+    for (uint32_t b = 0; b < bins; b++) {
+        double freq_hz = (first + b) / window_s;
+        double box = FLICKER_PI * freq_hz * sample_s;
+        double amplitude = 2.0 * sqrt(acc_re[b] * acc_re[b] + acc_im[b] * acc_im[b]) / samples;
+        double relative = amplitude / (sin(box) / box) / mean_level;
+
+        sum += pow(relative / flicker_svm_threshold(freq_hz), 3.7);
+    }
+
+    return pow(sum, 1.0 / 3.7);
+}
+
+/**
+ * @brief Defaults: 1 s SVM windows of 10 us samples, 20 ms step windows,
+ * 1 % step threshold
+ */
+void flicker_metrics_default_config(flicker_config_t *config)
+{
+    config->sample_ns = 10000;
+    config->svm_window_ms = 1000;
+    config->step_window_us = 20000;
+    config->step_threshold = 0.01;
+}
+
+/**
+ * @brief Compute all metrics over the window from edges[0] to end_ns
+ *
+ * @return 0 on success, -1 on an empty window or one too long for SVM
+ */
+int flicker_metrics_analyze(const flicker_edge_t *edges, uint32_t count, int64_t end_ns,
+                            const flicker_config_t *config, flicker_result_t *result)
+{
+    memset(result, 0, sizeof(*result));
+
+    if (count == 0 || end_ns <= edges[0].time_ns || config->sample_ns == 0 ||
+        config->svm_window_ms == 0 || config->step_window_us == 0) {
+        return -1;
+    }
+
+    // Percent flicker, mean
+    double min_level = edges[0].level;
+    double max_level = edges[0].level;
+    for (uint32_t i = 0; i < count && edges[i].time_ns < end_ns; i++) {
+        if (edges[i].level < min_level) {
+            min_level = edges[i].level;
+        }
+        if (edges[i].level > max_level) {
+            max_level = edges[i].level;
+        }
+    }
+
+    flicker_cursor_t cursor;
+    flicker_cursor_init(&cursor, edges, count, end_ns);
+    double duration_ns = (double)(end_ns - edges[0].time_ns);
+    double total_area = flicker_integrate(&cursor, end_ns);
+
+    result->mean_level = total_area / duration_ns;
+    if (max_level + min_level > 0.0) {
+        result->percent_flicker = 100.0 * (max_level - min_level) / (max_level + min_level);
+    }
+
+    // Flicker index
+    if (total_area > 0.0) {
+        double above = 0.0;
+        for (uint32_t i = 0; i < count && edges[i].time_ns < end_ns; i++) {
+            int64_t segment_end = (i + 1 < count && edges[i + 1].time_ns < end_ns) ?
+                                  edges[i + 1].time_ns : end_ns;
+            if (edges[i].level > result->mean_level) {
+                above += (edges[i].level - result->mean_level) *
+                         (double)(segment_end - edges[i].time_ns);
+            }
+        }
+        result->flicker_index = above / total_area;
+    }
+
+    // SVM, worst window
+    int64_t svm_window_ns = (int64_t)config->svm_window_ms * 1000000;
+    int64_t start = edges[0].time_ns;
+    do {
+        int64_t stop = (end_ns - start < svm_window_ns) ? end_ns : start + svm_window_ns;
+        double svm = flicker_svm(edges, count, start, stop, config->sample_ns);
+        if (svm < 0.0) {
+            return -1;
+        }
+        if (svm > result->svm) {
+            result->svm = svm;
+        }
+        start = stop;
+    } while (end_ns - start >= svm_window_ns);
+
+    // Fade steps
+    int64_t window_ns = (int64_t)config->step_window_us * 1000;
+    double previous = -1.0;
+    flicker_cursor_init(&cursor, edges, count, end_ns);
+    for (int64_t start = edges[0].time_ns; start + window_ns <= end_ns; start += window_ns) {
+        double level = flicker_integrate(&cursor, start + window_ns) / window_ns;
+
+        if (previous >= 0.0 && fabs(level - previous) > 1e-9) {
+            double larger = (level > previous) ? level : previous;
+            double relative = fabs(level - previous) / larger;
+
+            result->steps++;
+            if (relative > result->max_step) {
+                result->max_step = relative;
+            }
+            if (relative > config->step_threshold) {
+                result->visible_steps++;
+            }
+        }
+        previous = level;
+    }
+
+    return 0;
+}
@@ -0,0 +1,38 @@
+#ifndef FLICKER_METRICS_H
+#define FLICKER_METRICS_H
+
+#include <stdint.h>
+
+#define FLICKER_SVM_MIN_HZ            80                 ///< SVM harmonic range (IEC TR 63158)
+#define FLICKER_SVM_MAX_HZ            2000
+#define FLICKER_MAX_BINS              8192               ///< SVM harmonics per window
+
+/** Light output from time_ns until the next edge (or the end of the window) */
+typedef struct {
+    int64_t time_ns;
+    float level;                    ///< Relative light output, 0..1
+} flicker_edge_t;
+
+typedef struct {
+    uint32_t sample_ns;             ///< Box-filter sample period for the SVM spectrum
+    uint32_t svm_window_ms;         ///< SVM window, up to FLICKER_MAX_BINS / 2 kHz long
+    uint32_t step_window_us;        ///< Averaging window for fade steps (whole PWM periods)
+    double step_threshold;          ///< Relative step counted as visible
+} flicker_config_t;
+
+typedef struct {
+    double mean_level;
+    double percent_flicker;         ///< 100 (max - min) / (max + min)
+    double flicker_index;           ///< Area above the mean / total area
+    double svm;                     ///< Stroboscopic visibility measure (worst window), 1 = threshold
+    double max_step;                ///< Largest relative step between windows
+    uint32_t steps;                 ///< Windows whose level changed
+    uint32_t visible_steps;         ///< Steps above step_threshold
+} flicker_result_t;
+
+void flicker_metrics_default_config(flicker_config_t *config);
+
+int flicker_metrics_analyze(const flicker_edge_t *edges, uint32_t count, int64_t end_ns,
+                            const flicker_config_t *config, flicker_result_t *result);
+
+#endif
@@ -0,0 +1,150 @@
+/**
+ * @file heap_guard.c
+ * @brief Boot heap audit and late allocation guard
+ *
+ * Every task, mutex and timer of the application is created during init,
+ * the RTOS objects from static buffers. Once init is done the heap should
+ * stay untouched, so a long-running fixture keeps the memory layout it
+ * booted with. heap_guard_arm() logs the heap state at the end of boot and
+ * from then on every allocation is counted as a late allocation and
+ * reported from the main loop.
+ *
+ * Allocations are seen through the heap allocation hook, which needs
+ * CONFIG_HEAP_USE_HOOKS in sdkconfig.defaults; without it only the boot
+ * audit is logged. The audit also lists the stack high-water mark of every
+ * task (CONFIG_FREERTOS_USE_TRACE_FACILITY), to size the static stacks.
+ */
+
+#include "heap_guard.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "HEAP_GUARD";
+
+#define HEAP_GUARD_MAX_TASKS          16
+
+// Updated from the allocation hook, any core and any context
+static portMUX_TYPE heap_guard_spinlock = portMUX_INITIALIZER_UNLOCKED;
+static bool armed = false;
+static uint32_t boot_allocs = 0;
+static uint32_t boot_bytes = 0;
+static uint32_t late_allocs = 0;
+static uint32_t late_bytes = 0;
+static uint32_t largest_late_alloc = 0;
+
+// Late allocations already reported
+static uint32_t reported_late_allocs = 0;
+
+/**
+ * @brief Heap allocation hook, called by the heap component for every allocation
+ *
+ * Runs inside the allocator, possibly from an ISR with the flash cache
+ * disabled, so it only counts.
+ */
+void IRAM_ATTR esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    if (ptr == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL_SAFE(&heap_guard_spinlock);
+    if (armed) {
+        late_allocs++;
+        late_bytes += size;
+        if (size > largest_late_alloc) {
+            largest_late_alloc = size;
+        }
+    } else {
+        boot_allocs++;
+        boot_bytes += size;
+    }
+    portEXIT_CRITICAL_SAFE(&heap_guard_spinlock);
+}
+
+/**
+ * @brief Get heap state and allocation counters
+ */
+void heap_guard_get_stats(heap_guard_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    stats->free_bytes = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    stats->minimum_free_bytes = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+    stats->largest_free_block = heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT);
+
+    portENTER_CRITICAL(&heap_guard_spinlock);
+    stats->armed = armed;
+    stats->boot_allocs = boot_allocs;
+    stats->boot_bytes = boot_bytes;
+    stats->late_allocs = late_allocs;
+    stats->late_bytes = late_bytes;
+    stats->largest_late_alloc = largest_late_alloc;
+    portEXIT_CRITICAL(&heap_guard_spinlock);
+}
+
+/**
+ * @brief Log the unused stack of every task
+ */
+void heap_guard_log_stacks(void)
+{
+    static TaskStatus_t tasks[HEAP_GUARD_MAX_TASKS];
+
+    UBaseType_t count = uxTaskGetSystemState(tasks, HEAP_GUARD_MAX_TASKS, NULL);
+    if (count == 0) {
+        ESP_LOGW(TAG, "More than %d tasks, stack report skipped", HEAP_GUARD_MAX_TASKS);
+        return;
+    }
+
+    ESP_LOGI(TAG, "Stack high-water marks (bytes never used):");
+    for (UBaseType_t i = 0; i < count; i++) {
+        ESP_LOGI(TAG, "  %-18s prio %2u  %5lu", tasks[i].pcTaskName,
+                 tasks[i].uxCurrentPriority, (uint32_t)tasks[i].usStackHighWaterMark);
+    }
+}
+
+/**
+ * @brief Log the boot heap audit and start counting late allocations
+ *
+ * Call once, after the last module has been initialized.
+ */
+void heap_guard_arm(void)
+{
+    heap_guard_stats_t stats;
+
+    portENTER_CRITICAL(&heap_guard_spinlock);
+    armed = true;
+    portEXIT_CRITICAL(&heap_guard_spinlock);
+
+    heap_guard_get_stats(&stats);
+    ESP_LOGI(TAG, "Heap at end of boot: %lu free, %lu minimum, %lu largest block",
+             stats.free_bytes, stats.minimum_free_bytes, stats.largest_free_block);
+    heap_guard_log_stacks();
+    if (stats.boot_allocs == 0) {
+        ESP_LOGW(TAG, "Allocation hook inactive (CONFIG_HEAP_USE_HOOKS), late allocations not guarded");
+        return;
+    }
+    ESP_LOGI(TAG, "  %lu allocations, %lu bytes during boot", stats.boot_allocs, stats.boot_bytes);
+}
+
+/**
+ * @brief Report new late allocations (call from the main loop)
+ */
+void heap_guard_periodic(void)
+{
+    heap_guard_stats_t stats;
+
+    heap_guard_get_stats(&stats);
+    if (!stats.armed || stats.late_allocs == reported_late_allocs) {
+        return;
+    }
+
+    ESP_LOGW(TAG, "%lu allocations after init (%lu bytes, largest %lu), %lu free, %lu minimum",
+             stats.late_allocs - reported_late_allocs, stats.late_bytes,
+             stats.largest_late_alloc, stats.free_bytes, stats.minimum_free_bytes);
+    reported_late_allocs = stats.late_allocs;
+}
@@ -0,0 +1,27 @@
+#ifndef HEAP_GUARD_H
+#define HEAP_GUARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    bool armed;
+    uint32_t free_bytes;
+    uint32_t minimum_free_bytes;
+    uint32_t largest_free_block;
+    uint32_t boot_allocs;
+    uint32_t boot_bytes;
+    uint32_t late_allocs;
+    uint32_t late_bytes;
+    uint32_t largest_late_alloc;
+} heap_guard_stats_t;
+
+void heap_guard_arm(void);
+
+void heap_guard_get_stats(heap_guard_stats_t *stats);
+
+void heap_guard_periodic(void);
+
+void heap_guard_log_stacks(void);
+
+#endif
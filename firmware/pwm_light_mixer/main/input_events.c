@@ -0,0 +1,94 @@
+/**
+ * @file input_events.c
+ * @brief Input event queue from the sampling timers to the main loop
+ *
+ * The encoder and touch sensor are sampled from esp_timer callbacks
+ * instead of tasks of their own. The callbacks post an event here for
+ * every change and the main loop blocks on the queue between its periodic
+ * jobs, so input is handled as soon as it happens without a task stack
+ * per input. With ISR dispatch (CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD)
+ * the callbacks run in the timer interrupt and post with the FromISR API.
+ *
+ * Events only wake the main loop; the input state itself is read through
+ * the encoder and touch getters, so a dropped event on a full queue is
+ * caught up on the next pass.
+ */
+
+#include "input_events.h"
+#include "config.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+static const char *TAG = "INPUT_EVENTS";
+
+static QueueHandle_t event_queue = NULL;
+static StaticQueue_t event_queue_buffer;
+static uint8_t event_queue_storage[CONFIG_INPUT_EVENT_QUEUE_LEN * sizeof(input_event_t)];
+
+static volatile uint32_t dropped = 0;
+
+/**
+ * @brief Create the event queue
+ *
+ * @return 0 on success, -1 on failure
+ */
+int input_events_init(void)
+{
+    event_queue = xQueueCreateStatic(CONFIG_INPUT_EVENT_QUEUE_LEN, sizeof(input_event_t),
+                                     event_queue_storage, &event_queue_buffer);
+    if (event_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create event queue");
+        return -1;
+    }
+
+    ESP_LOGI(TAG, "Input timers dispatched from %s",
+             (INPUT_TIMER_DISPATCH == ESP_TIMER_ISR) ? "ISR" : "esp_timer task");
+    return 0;
+}
+
+/**
+ * @brief Post an event (input timer callbacks only, never blocks)
+ */
+void IRAM_ATTR input_events_post(input_event_type_t type, int32_t value)
+{
+    input_event_t event = { .type = type, .value = value };
+
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+    BaseType_t woken = pdFALSE;
+    if (xQueueSendFromISR(event_queue, &event, &woken) != pdTRUE) {
+        dropped++;
+    }
+    if (woken == pdTRUE) {
+        esp_timer_isr_dispatch_need_yield();
+    }
+#else
+    if (xQueueSend(event_queue, &event, 0) != pdTRUE) {
+        dropped++;
+    }
+#endif
+}
+
+/**
+ * @brief Wait for the next event
+ *
+ * The timeout is rounded up to whole ticks, so a wait shorter than a tick
+ * still blocks instead of spinning.
+ *
+ * @return true if an event was received, false on timeout
+ */
+bool input_events_wait(input_event_t *event, uint32_t timeout_ms)
+{
+    TickType_t ticks = (timeout_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+
+    return xQueueReceive(event_queue, event, ticks) == pdTRUE;
+}
+
+/**
+ * @brief Number of events lost to a full queue
+ */
+uint32_t input_events_get_dropped(void)
+{
+    return dropped;
+}
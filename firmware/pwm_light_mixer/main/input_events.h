@@ -0,0 +1,35 @@
+#ifndef INPUT_EVENTS_H
+#define INPUT_EVENTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_timer.h"
+
+/** Input sampling timers run from the timer ISR where esp_timer supports it */
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+#define INPUT_TIMER_DISPATCH          ESP_TIMER_ISR
+#else
+#define INPUT_TIMER_DISPATCH          ESP_TIMER_TASK
+#endif
+
+typedef enum {
+    INPUT_EVENT_ENCODER,            ///< Encoder position changed (value = position)
+    INPUT_EVENT_BUTTON,             ///< Encoder button pressed (value = press count)
+    INPUT_EVENT_TOUCH,              ///< Touch detected (value = touch count)
+} input_event_type_t;
+
+typedef struct {
+    input_event_type_t type;
+    int32_t value;
+} input_event_t;
+
+int input_events_init(void);
+
+void input_events_post(input_event_type_t type, int32_t value);
+
+bool input_events_wait(input_event_t *event, uint32_t timeout_ms);
+
+uint32_t input_events_get_dropped(void);
+
+#endif
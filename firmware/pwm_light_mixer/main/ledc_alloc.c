@@ -0,0 +1,213 @@
+/**
+ * @file ledc_alloc.c
+ * @brief LEDC timer allocation for channel groups
+ *
+ * Every LEDC channel takes frequency and resolution from one of four
+ * timers in its speed mode, and each mode has eight channels. Groups of
+ * channels request a frequency and a minimum resolution; the planner
+ *
+ * - picks the clock source giving the widest duty counter for the
+ *   frequency (counter = clock / (divider x freq), divider 1.0..1023.996
+ *   in 10.8 fixed point, at most 20 bits),
+ * - lets groups at the same frequency share a timer,
+ * - packs timers onto the two speed modes, largest channel count first,
+ *   preferring high speed mode (glitch-free duty updates),
+ * - and reports per group why a request cannot be met.
+ *
+ * Clock sources differ between modes and chips, so the caller supplies
+ * them. On the ESP32 low speed timers share one slow clock; clocks are
+ * chosen per timer here, which only matters for the rarely useful
+ * RC_FAST clock.
+ *
+ * Pure logic, shared by the LEDC output driver and the host planner.
+ */
+
+#include "ledc_alloc.h"
+#include <string.h>
+
+/**
+ * @brief Widest duty counter a clock supports at a frequency
+ *
+ * @param divider_q8 Set to the matching clock divider (10.8), may be NULL
+ * @return Resolution in bits, or 0 if the frequency is out of range
+ */
+uint32_t ledc_alloc_max_bits(uint32_t clock_hz, uint32_t freq_hz, uint32_t *divider_q8)
+{
+    if (freq_hz == 0 || clock_hz < 2 * freq_hz) {
+        return 0;
+    }
+
+    uint32_t bits = 0;
+    while (bits < LEDC_ALLOC_MAX_BITS && ((uint64_t)freq_hz << (bits + 1)) <= clock_hz) {
+        bits++;
+    }
+
+    uint64_t counter_hz = (uint64_t)freq_hz << bits;
+    uint64_t divider = (((uint64_t)clock_hz << 8) + counter_hz / 2) / counter_hz;
+    if (divider < LEDC_ALLOC_DIVIDER_MIN_Q8) {
+        divider = LEDC_ALLOC_DIVIDER_MIN_Q8;
+    }
+    if (divider > LEDC_ALLOC_DIVIDER_MAX_Q8) {
+        return 0;
+    }
+
+    if (divider_q8 != NULL) {
+        *divider_q8 = (uint32_t)divider;
+    }
+    return bits;
+}
+
+/**
+ * @brief Best clock for a frequency in one mode
+ *
+ * @return Clock index, or -1 if none is usable
+ */
+static int ledc_alloc_pick_clock(const ledc_alloc_clock_t *clocks, uint32_t clock_count,
+                                 uint32_t mode, uint32_t freq_hz, uint32_t *bits)
+{
+    int best = -1;
+
+    *bits = 0;
+    for (uint32_t c = 0; c < clock_count; c++) {
+        if (!(clocks[c].mode_mask & (1u << mode))) {
+            continue;
+        }
+        uint32_t candidate = ledc_alloc_max_bits(clocks[c].hz, freq_hz, NULL);
+        if (candidate > *bits) {
+            *bits = candidate;
+            best = (int)c;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * @brief Allocate timers and channels for all groups
+ *
+ * @param groups One result per request
+ * @return 0 if every group was placed, -1 otherwise (see each status)
+ */
+int ledc_alloc_plan(const ledc_alloc_clock_t *clocks, uint32_t clock_count,
+                    const ledc_alloc_request_t *requests, uint32_t count,
+                    ledc_alloc_group_t *groups)
+{
+    uint32_t timers_used[LEDC_ALLOC_MODES] = {0};
+    uint32_t channels_used[LEDC_ALLOC_MODES] = {0};
+    uint32_t leader[LEDC_ALLOC_MAX_GROUPS];      // First group at the same frequency
+    uint32_t timer_channels[LEDC_ALLOC_MAX_GROUPS] = {0};
+    uint32_t order[LEDC_ALLOC_MAX_GROUPS];
+    uint32_t order_count = 0;
+    int result = 0;
+
+    if (count > LEDC_ALLOC_MAX_GROUPS) {
+        return -1;
+    }
+
+    memset(groups, 0, count * sizeof(groups[0]));
+
+    // Groups at the same frequency share their leader's timer
+    for (uint32_t i = 0; i < count; i++) {
+        leader[i] = i;
+        for (uint32_t j = 0; j < i; j++) {
+            if (requests[j].freq_hz == requests[i].freq_hz) {
+                leader[i] = leader[j];
+                break;
+            }
+        }
+        timer_channels[leader[i]] += requests[i].channels;
+        if (leader[i] == i) {
+            order[order_count++] = i;
+        }
+    }
+
+    // Largest timers first, stable for equal sizes
+    for (uint32_t i = 1; i < order_count; i++) {
+        uint32_t key = order[i];
+        uint32_t j = i;
+        while (j > 0 && timer_channels[order[j - 1]] < timer_channels[key]) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = key;
+    }
+
+    for (uint32_t o = 0; o < order_count; o++) {
+        uint32_t lead = order[o];
+        uint32_t min_bits = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            if (leader[i] == lead && requests[i].min_bits > min_bits) {
+                min_bits = requests[i].min_bits;
+            }
+        }
+
+        ledc_alloc_status_t status = LEDC_ALLOC_NO_RESOLUTION;
+        ledc_alloc_group_t placed = {0};
+
+        for (uint32_t mode = 0; mode < LEDC_ALLOC_MODES; mode++) {
+            uint32_t bits;
+            int clock = ledc_alloc_pick_clock(clocks, clock_count, mode,
+                                              requests[lead].freq_hz, &bits);
+            if (clock < 0 || bits < min_bits || bits == 0) {
+                continue;
+            }
+            if (timers_used[mode] >= LEDC_ALLOC_TIMERS_PER_MODE) {
+                status = LEDC_ALLOC_NO_TIMER;
+                continue;
+            }
+            if (channels_used[mode] + timer_channels[lead] > LEDC_ALLOC_CHANNELS_PER_MODE) {
+                if (status != LEDC_ALLOC_NO_TIMER) {
+                    status = LEDC_ALLOC_NO_CHANNEL;
+                }
+                continue;
+            }
+
+            status = LEDC_ALLOC_OK;
+            placed.mode = mode;
+            placed.timer = timers_used[mode]++;
+            placed.clock = (uint32_t)clock;
+            placed.bits = ledc_alloc_max_bits(clocks[clock].hz, requests[lead].freq_hz,
+                                              &placed.divider_q8);
+            placed.actual_hz = (uint32_t)((((uint64_t)clocks[clock].hz << 8) +
+                                           ((uint64_t)placed.divider_q8 << placed.bits) / 2) /
+                                          ((uint64_t)placed.divider_q8 << placed.bits));
+            break;
+        }
+
+        // Place every group of this timer, channels consecutive
+        for (uint32_t i = 0; i < count; i++) {
+            if (leader[i] != lead) {
+                continue;
+            }
+            groups[i] = placed;
+            groups[i].status = status;
+            if (status == LEDC_ALLOC_OK) {
+                groups[i].first_channel = channels_used[placed.mode];
+                channels_used[placed.mode] += requests[i].channels;
+            } else {
+                result = -1;
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Short description of an allocation status
+ */
+const char *ledc_alloc_status_name(ledc_alloc_status_t status)
+{
+    switch (status) {
+    case LEDC_ALLOC_OK:
+        return "ok";
+    case LEDC_ALLOC_NO_RESOLUTION:
+        return "resolution not reachable";
+    case LEDC_ALLOC_NO_TIMER:
+        return "no free timer";
+    case LEDC_ALLOC_NO_CHANNEL:
+        return "no free channels";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef LEDC_ALLOC_H
+#define LEDC_ALLOC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LEDC_ALLOC_MODES              2                  ///< 0 = high speed, 1 = low speed
+#define LEDC_ALLOC_TIMERS_PER_MODE    4
+#define LEDC_ALLOC_CHANNELS_PER_MODE  8
+#define LEDC_ALLOC_MAX_GROUPS         8
+#define LEDC_ALLOC_MAX_BITS           20                 ///< Widest duty counter
+#define LEDC_ALLOC_DIVIDER_MIN_Q8     256                ///< Clock divider 1.0 (10.8 fixed point)
+#define LEDC_ALLOC_DIVIDER_MAX_Q8     0x3FFFF            ///< Clock divider 1023.996
+
+typedef struct {
+    const char *name;
+    uint32_t hz;
+    uint32_t mode_mask;             ///< Bit n set: usable by speed mode n
+} ledc_alloc_clock_t;
+
+typedef struct {
+    uint32_t freq_hz;
+    uint32_t min_bits;              ///< Lowest acceptable duty resolution
+    uint32_t channels;              ///< Channels in the group
+} ledc_alloc_request_t;
+
+typedef enum {
+    LEDC_ALLOC_OK,
+    LEDC_ALLOC_NO_RESOLUTION,       ///< No clock reaches min_bits at this frequency
+    LEDC_ALLOC_NO_TIMER,            ///< All timers of every fitting mode in use
+    LEDC_ALLOC_NO_CHANNEL,          ///< Not enough free channels in any mode
+} ledc_alloc_status_t;
+
+typedef struct {
+    ledc_alloc_status_t status;
+    uint32_t mode;
+    uint32_t timer;
+    uint32_t clock;                 ///< Index into the clock list
+    uint32_t bits;                  ///< Duty resolution, highest the clock allows
+    uint32_t divider_q8;            ///< Clock divider, 10.8 fixed point
+    uint32_t actual_hz;             ///< Frequency after divider rounding
+    uint32_t first_channel;         ///< Channels first_channel.. in mode, consecutive
+} ledc_alloc_group_t;
+
+uint32_t ledc_alloc_max_bits(uint32_t clock_hz, uint32_t freq_hz, uint32_t *divider_q8);
+
+int ledc_alloc_plan(const ledc_alloc_clock_t *clocks, uint32_t clock_count,
+                    const ledc_alloc_request_t *requests, uint32_t count,
+                    ledc_alloc_group_t *groups);
+
+const char *ledc_alloc_status_name(ledc_alloc_status_t status);
+
+#endif
@@ -0,0 +1,306 @@
+/**
+ * @file ledc_model.c
+ * @brief Host model of the ESP32 LEDC peripheral
+ *
+ * Models what decides the LEDC output waveform, period by period:
+ *
+ * - Timers: source clock, 10.8 fractional divider and counter resolution.
+ *   Tick n of a timer falls on source clock cycle floor(n * divider / 256),
+ *   which spreads the fractional divider over periods as the hardware does
+ * - Channels: hpoint, and duty with 4 fractional bits. The output rises at
+ *   hpoint and falls duty ticks later, one tick later in frac of every
+ *   16 periods (duty dithering). A pulse running past the overflow falls
+ *   in the next period, and merges with it when that period rises first
+ * - Shadow registers: duty, hpoint and fade settings are written to a
+ *   shadow and latched at the next overflow of the channel's timer after
+ *   ledc_model_update(), so writes mid-period never glitch the output
+ * - Hardware fades: every `cycle` periods the duty moves by `scale` counts,
+ *   `num` times, then a fade-end event is counted. A plain duty write is a
+ *   one-step fade of scale 0, as ledc_set_duty() programs it
+ *
+ * Since the duty can only change at an overflow, each period's waveform is
+ * fixed when the period starts: the model does a little work per overflow
+ * and none per tick. Level changes go to a per-channel sink, so cost is a
+ * few operations per edge.
+ *
+ * Simplifications: timer and channel configuration take effect at once,
+ * restarting the counter or starting the channel at the next overflow;
+ * high-speed and low-speed modes behave alike (no para_up).
+ *
+ * Host-only; not part of the firmware build.
+ */
+
+#include "ledc_model.h"
+#include <string.h>
+
+#define LEDC_MODEL_MAX_BITS           20
+#define LEDC_MODEL_DIVIDER_MIN_Q8     256
+#define LEDC_MODEL_DIVIDER_MAX_Q8     0x3FFFF
+
+/**
+ * @brief Time of a timer tick, counted from the timer's base
+ */
+static int64_t ledc_model_tick_ps(const ledc_model_timer_t *timer, uint64_t tick)
+{
+    return timer->base_ps + (int64_t)((tick * timer->divider_q8) >> 8) * timer->cycle_ps;
+}
+
+static void ledc_model_set_level(ledc_model_channel_t *channel, int64_t time_ps, bool level)
+{
+    if (channel->level == level) {
+        return;
+    }
+
+    channel->level = level;
+    if (channel->sink != NULL) {
+        channel->sink(channel->sink_arg, time_ps, level);
+    }
+}
+
+/**
+ * @brief Latch or step the duty at an overflow
+ */
+static void ledc_model_overflow(ledc_model_channel_t *channel, uint32_t max_q4)
+{
+    if (channel->update_pending) {
+        channel->active = channel->shadow;
+        channel->update_pending = false;
+        channel->cycle_count = 0;
+        channel->latches++;
+        return;
+    }
+
+    if (channel->active.num == 0 || ++channel->cycle_count < channel->active.cycle) {
+        return;
+    }
+
+    uint32_t step_q4 = channel->active.scale << LEDC_MODEL_FRACTION_BITS;
+    if (channel->active.increase) {
+        channel->active.duty_q4 = (channel->active.duty_q4 + step_q4 > max_q4) ?
+                                  max_q4 : channel->active.duty_q4 + step_q4;
+    } else {
+        channel->active.duty_q4 = (channel->active.duty_q4 < step_q4) ?
+                                  0 : channel->active.duty_q4 - step_q4;
+    }
+
+    channel->cycle_count = 0;
+    if (--channel->active.num == 0) {
+        channel->fades_done++;
+    }
+}
+
+/**
+ * @brief Emit one channel's edges for the period starting at a tick
+ */
+static void ledc_model_emit(ledc_model_channel_t *channel, const ledc_model_timer_t *timer,
+                            uint64_t start_tick)
+{
+    uint32_t period_ticks = 1u << timer->bits;
+    uint32_t hpoint = channel->active.hpoint;
+    uint32_t duty = channel->active.duty_q4 >> LEDC_MODEL_FRACTION_BITS;
+
+    channel->dither_acc += channel->active.duty_q4 & ((1u << LEDC_MODEL_FRACTION_BITS) - 1);
+    if (channel->dither_acc >= (1u << LEDC_MODEL_FRACTION_BITS)) {
+        channel->dither_acc -= (1u << LEDC_MODEL_FRACTION_BITS);
+        duty++;
+    }
+
+    bool pulse = (duty > 0 && hpoint < period_ticks);
+    int64_t rise_ps = ledc_model_tick_ps(timer, start_tick + hpoint);
+
+    // Pulse carried over from the previous period
+    if (channel->carry_fall_ps >= 0) {
+        if (!pulse || channel->carry_fall_ps < rise_ps) {
+            ledc_model_set_level(channel, channel->carry_fall_ps, false);
+        }
+        channel->carry_fall_ps = -1;
+    }
+
+    if (!pulse) {
+        return;
+    }
+
+    ledc_model_set_level(channel, rise_ps, true);
+
+    int64_t fall_ps = ledc_model_tick_ps(timer, start_tick + hpoint + duty);
+    if (hpoint + duty < period_ticks) {
+        ledc_model_set_level(channel, fall_ps, false);
+    } else {
+        channel->carry_fall_ps = fall_ps;
+    }
+}
+
+/**
+ * @brief Start a period on a timer: latch or step its channels, emit edges
+ */
+static void ledc_model_start_period(ledc_model_t *model, uint32_t mode, uint32_t index,
+                                    bool overflow)
+{
+    ledc_model_timer_t *timer = &model->timers[mode][index];
+    uint32_t max_q4 = (1u << timer->bits) << LEDC_MODEL_FRACTION_BITS;
+    uint64_t start_tick = timer->period << timer->bits;
+
+    for (uint32_t c = 0; c < LEDC_MODEL_CHANNELS; c++) {
+        ledc_model_channel_t *channel = &model->channels[mode][c];
+        if (!channel->enabled || channel->timer != index) {
+            continue;
+        }
+
+        if (overflow) {
+            ledc_model_overflow(channel, max_q4);
+        }
+        ledc_model_emit(channel, timer, start_tick);
+    }
+}
+
+/**
+ * @brief Reset the model: all timers stopped, all channels disabled, time 0
+ */
+void ledc_model_init(ledc_model_t *model)
+{
+    memset(model, 0, sizeof(*model));
+
+    for (uint32_t m = 0; m < LEDC_MODEL_MODES; m++) {
+        for (uint32_t c = 0; c < LEDC_MODEL_CHANNELS; c++) {
+            model->channels[m][c].carry_fall_ps = -1;
+        }
+    }
+}
+
+/**
+ * @brief Configure and (re)start a timer at the current time
+ *
+ * @return 0 on success, -1 on invalid parameters
+ */
+int ledc_model_timer_config(ledc_model_t *model, uint32_t mode, uint32_t timer,
+                            uint32_t clock_hz, uint32_t divider_q8, uint32_t bits)
+{
+    if (mode >= LEDC_MODEL_MODES || timer >= LEDC_MODEL_TIMERS || clock_hz == 0 ||
+        bits == 0 || bits > LEDC_MODEL_MAX_BITS || divider_q8 < LEDC_MODEL_DIVIDER_MIN_Q8 ||
+        divider_q8 > LEDC_MODEL_DIVIDER_MAX_Q8) {
+        return -1;
+    }
+
+    ledc_model_timer_t *t = &model->timers[mode][timer];
+    t->running = true;
+    t->cycle_ps = 1000000000000LL / clock_hz;
+    t->divider_q8 = divider_q8;
+    t->bits = bits;
+    t->base_ps = model->now_ps;
+    t->period = 0;
+
+    ledc_model_start_period(model, mode, timer, false);
+    return 0;
+}
+
+/**
+ * @brief Attach a channel to a timer with an initial duty and output sink
+ *
+ * The output starts low and follows the duty from the timer's next overflow.
+ */
+int ledc_model_channel_config(ledc_model_t *model, uint32_t mode, uint32_t channel,
+                              uint32_t timer, uint32_t hpoint, uint32_t duty_q4,
+                              ledc_model_sink_t sink, void *sink_arg)
+{
+    if (mode >= LEDC_MODEL_MODES || channel >= LEDC_MODEL_CHANNELS ||
+        timer >= LEDC_MODEL_TIMERS) {
+        return -1;
+    }
+
+    ledc_model_channel_t *c = &model->channels[mode][channel];
+    memset(c, 0, sizeof(*c));
+    c->enabled = true;
+    c->timer = timer;
+    c->shadow.hpoint = hpoint;
+    c->shadow.duty_q4 = duty_q4;
+    c->active = c->shadow;
+    c->carry_fall_ps = -1;
+    c->sink = sink;
+    c->sink_arg = sink_arg;
+    return 0;
+}
+
+/**
+ * @brief Write hpoint and duty to the shadow registers (plain duty, no fade)
+ */
+int ledc_model_set_duty(ledc_model_t *model, uint32_t mode, uint32_t channel,
+                        uint32_t hpoint, uint32_t duty_q4)
+{
+    if (ledc_model_set_fade(model, mode, channel, duty_q4, true, 1, 1, 0) != 0) {
+        return -1;
+    }
+
+    model->channels[mode][channel].shadow.hpoint = hpoint;
+    return 0;
+}
+
+/**
+ * @brief Write a start duty and fade settings to the shadow registers
+ */
+int ledc_model_set_fade(ledc_model_t *model, uint32_t mode, uint32_t channel,
+                        uint32_t duty_q4, bool increase, uint32_t num, uint32_t cycle,
+                        uint32_t scale)
+{
+    if (mode >= LEDC_MODEL_MODES || channel >= LEDC_MODEL_CHANNELS ||
+        !model->channels[mode][channel].enabled || cycle == 0) {
+        return -1;
+    }
+
+    ledc_model_duty_t *shadow = &model->channels[mode][channel].shadow;
+    shadow->duty_q4 = duty_q4;
+    shadow->increase = increase;
+    shadow->num = num;
+    shadow->cycle = cycle;
+    shadow->scale = scale;
+    return 0;
+}
+
+/**
+ * @brief Latch the shadow registers at the next overflow (duty_start)
+ */
+int ledc_model_update(ledc_model_t *model, uint32_t mode, uint32_t channel)
+{
+    if (mode >= LEDC_MODEL_MODES || channel >= LEDC_MODEL_CHANNELS ||
+        !model->channels[mode][channel].enabled) {
+        return -1;
+    }
+
+    model->channels[mode][channel].update_pending = true;
+    return 0;
+}
+
+/**
+ * @brief Duty in use by the hardware (duty_rd), with fractional bits
+ */
+uint32_t ledc_model_get_duty(const ledc_model_t *model, uint32_t mode, uint32_t channel)
+{
+    return model->channels[mode][channel].active.duty_q4;
+}
+
+/**
+ * @brief Advance time, processing every overflow up to and including until_ps
+ *
+ * Edges of a period are emitted when it starts, so sinks may see edges up
+ * to one period beyond until_ps.
+ */
+void ledc_model_run(ledc_model_t *model, int64_t until_ps)
+{
+    for (uint32_t m = 0; m < LEDC_MODEL_MODES; m++) {
+        for (uint32_t t = 0; t < LEDC_MODEL_TIMERS; t++) {
+            ledc_model_timer_t *timer = &model->timers[m][t];
+            if (!timer->running) {
+                continue;
+            }
+
+            while (ledc_model_tick_ps(timer, (timer->period + 1) << timer->bits) <= until_ps) {
+                timer->period++;
+                timer->overflows++;
+                ledc_model_start_period(model, m, t, true);
+            }
+        }
+    }
+
+    if (until_ps > model->now_ps) {
+        model->now_ps = until_ps;
+    }
+}
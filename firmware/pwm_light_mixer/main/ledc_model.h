@@ -0,0 +1,78 @@
+#ifndef LEDC_MODEL_H
+#define LEDC_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LEDC_MODEL_MODES              2
+#define LEDC_MODEL_TIMERS             4                  ///< Per speed mode
+#define LEDC_MODEL_CHANNELS           8                  ///< Per speed mode
+#define LEDC_MODEL_FRACTION_BITS      4                  ///< Fractional duty bits (dithered)
+
+/** Level change on one channel output, time in picoseconds */
+typedef void (*ledc_model_sink_t)(void *arg, int64_t time_ps, bool level);
+
+typedef struct {
+    bool running;
+    int64_t cycle_ps;               ///< Source clock period
+    uint32_t divider_q8;            ///< Clock divider, 10.8 fixed point
+    uint32_t bits;                  ///< Counter resolution
+    int64_t base_ps;                ///< Time of tick 0
+    uint64_t period;                ///< Periods completed since base_ps
+    uint64_t overflows;
+} ledc_model_timer_t;
+
+typedef struct {
+    uint32_t hpoint;
+    uint32_t duty_q4;               ///< Duty with 4 fractional bits
+    bool increase;                  ///< Fade direction
+    uint32_t num;                   ///< Fade steps left
+    uint32_t cycle;                 ///< Periods per fade step
+    uint32_t scale;                 ///< Duty change per fade step (integer counts)
+} ledc_model_duty_t;
+
+typedef struct {
+    bool enabled;
+    uint32_t timer;
+    ledc_model_duty_t shadow;       ///< Written by software
+    bool update_pending;            ///< Shadow latches at the next overflow
+    ledc_model_duty_t active;       ///< Used by the hardware this period
+    uint32_t cycle_count;           ///< Periods into the current fade step
+    uint32_t dither_acc;            ///< Fraction accumulator
+    bool level;
+    int64_t carry_fall_ps;          ///< Fall of a pulse wrapping past overflow, or -1
+    ledc_model_sink_t sink;
+    void *sink_arg;
+    uint32_t latches;               ///< Shadow latches performed
+    uint32_t fades_done;            ///< Fade-end events
+} ledc_model_channel_t;
+
+typedef struct {
+    int64_t now_ps;
+    ledc_model_timer_t timers[LEDC_MODEL_MODES][LEDC_MODEL_TIMERS];
+    ledc_model_channel_t channels[LEDC_MODEL_MODES][LEDC_MODEL_CHANNELS];
+} ledc_model_t;
+
+void ledc_model_init(ledc_model_t *model);
+
+int ledc_model_timer_config(ledc_model_t *model, uint32_t mode, uint32_t timer,
+                            uint32_t clock_hz, uint32_t divider_q8, uint32_t bits);
+
+int ledc_model_channel_config(ledc_model_t *model, uint32_t mode, uint32_t channel,
+                              uint32_t timer, uint32_t hpoint, uint32_t duty_q4,
+                              ledc_model_sink_t sink, void *sink_arg);
+
+int ledc_model_set_duty(ledc_model_t *model, uint32_t mode, uint32_t channel,
+                        uint32_t hpoint, uint32_t duty_q4);
+
+int ledc_model_set_fade(ledc_model_t *model, uint32_t mode, uint32_t channel,
+                        uint32_t duty_q4, bool increase, uint32_t num, uint32_t cycle,
+                        uint32_t scale);
+
+int ledc_model_update(ledc_model_t *model, uint32_t mode, uint32_t channel);
+
+uint32_t ledc_model_get_duty(const ledc_model_t *model, uint32_t mode, uint32_t channel);
+
+void ledc_model_run(ledc_model_t *model, int64_t until_ps);
+
+#endif
@@ -2,12 +2,23 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_mac.h"
 
 #include "config.h"
 #include "pwm_controller.h"
 #include "encoder.h"
 #include "touch_sensor.h"
+#include "input_events.h"
 #include "nvs_manager.h"
+#include "thermal.h"
+#include "current_sense.h"
+#include "daylight.h"
+#include "energy.h"
+#include "output.h"
+#include "metrics.h"
+#include "heap_guard.h"
+#include "deadline_monitor.h"
 
 static const char *TAG = "MAIN";
 
@@ -16,54 +27,217 @@ typedef struct {
     int32_t current_position;
     uint32_t last_touch_count;
     uint32_t nvs_check_counter;
+    bool storage_available;         ///< NVS is up; otherwise nothing is persisted
+    bool encoder_available;
+    bool touch_available;
 } app_state_t;
 
-static int app_init_all_modules(void)
+typedef enum {
+    BOOT_PHASE_OUTPUT,
+    BOOT_PHASE_LIGHT,
+    BOOT_PHASE_STORAGE,
+    BOOT_PHASE_INPUTS,
+    BOOT_PHASE_COUNT
+} boot_phase_t;
+
+static const char *BOOT_PHASE_NAMES[BOOT_PHASE_COUNT] = {
+    "output", "light", "storage", "inputs"
+};
+
+/** Time since reset (esp_timer start) at the end of each boot phase */
+static int64_t boot_phase_us[BOOT_PHASE_COUNT];
+
+static void app_boot_mark(boot_phase_t phase)
+{
+    boot_phase_us[phase] = esp_timer_get_time();
+}
+
+static void app_boot_report(void)
+{
+    int64_t previous = 0;
+
+    ESP_LOGI(TAG, "Boot timing (reset-to-light %lld us):", boot_phase_us[BOOT_PHASE_LIGHT]);
+    for (int i = 0; i < BOOT_PHASE_COUNT; i++) {
+        ESP_LOGI(TAG, "  %-8s at %7lld us (+%lld us)",
+                 BOOT_PHASE_NAMES[i], boot_phase_us[i], boot_phase_us[i] - previous);
+        previous = boot_phase_us[i];
+    }
+}
+
+static void app_apply_output(const app_state_t *state)
+{
+    if (state->pwm_enabled) {
+        pwm_controller_set_brightness((uint32_t)state->current_position);
+    } else {
+        pwm_controller_set_brightness(0);
+    }
+}
+
+/**
+ * @brief Device-specific soft start offset
+ *
+ * Hashes the factory MAC so fixtures on a shared supply start their ramps
+ * at different, but reproducible, moments after a power cut.
+ */
+static uint32_t app_soft_start_delay_ms(void)
+{
+    uint8_t mac[6] = {0};
+    uint32_t hash = 2166136261u;   // FNV-1a
+
+    esp_efuse_mac_get_default(mac);
+    for (int i = 0; i < 6; i++) {
+        hash = (hash ^ mac[i]) * 16777619u;
+    }
+
+    return hash % (CONFIG_SOFTSTART_STAGGER_MAX_MS + 1);
+}
+
+/**
+ * @brief Apply the restored state at power-on, ramping up if enabled
+ */
+static void app_power_on_output(const app_state_t *state)
 {
-    ESP_LOGI(TAG, "Init modules");
+    if (!CONFIG_ENABLE_SOFT_START || !state->pwm_enabled) {
+        app_apply_output(state);
+        return;
+    }
+
+    pwm_controller_ramp_to((uint32_t)state->current_position, CONFIG_SOFTSTART_RAMP_MS,
+                           app_soft_start_delay_ms());
+}
 
+static int app_init_storage(void)
+{
     if (CONFIG_ENABLE_NVS_STORAGE) {
         if (nvs_manager_init() != 0) {
             ESP_LOGE(TAG, "NVS init failed");
             return -1;
         }
+
+        if (CONFIG_ENABLE_ENERGY_METER) {
+            energy_load();
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Start input sampling and sensing
+ *
+ * A failed input is left out rather than stopping the boot, so the light
+ * keeps whatever control is left.
+ *
+ * @return 0 on success, -1 if the encoder or touch sensor is unavailable
+ */
+static int app_init_inputs(app_state_t *state)
+{
+    int result = 0;
+
+    state->encoder_available = (input_events_init() == 0 && encoder_init() == 0 &&
+                                encoder_start() == 0);
+    if (!state->encoder_available) {
+        ESP_LOGE(TAG, "Encoder unavailable");
+        result = -1;
     }
 
-    encoder_init();
-    encoder_task_start();
+    state->touch_available = CONFIG_ENABLE_TOUCH_TOGGLE && touch_sensor_init() == 0;
+    if (CONFIG_ENABLE_TOUCH_TOGGLE && !state->touch_available) {
+        ESP_LOGE(TAG, "Touch toggle unavailable");
+        result = -1;
+    }
 
-    if (CONFIG_ENABLE_TOUCH_TOGGLE) {
-        touch_sensor_init();
+    if (CONFIG_ENABLE_THERMAL_DERATING && thermal_init() != 0) {
+        ESP_LOGW(TAG, "Thermal derating unavailable");
     }
 
-    if (pwm_controller_init() != 0) {
-        return -1;
+    if (CONFIG_ENABLE_DAYLIGHT && daylight_init() != 0) {
+        ESP_LOGW(TAG, "Daylight harvesting unavailable");
     }
 
-    return 0;
+    if (CONFIG_ENABLE_CURRENT_SENSE && current_sense_init() != 0) {
+        ESP_LOGW(TAG, "Current sensing unavailable");
+    }
+
+    return result;
 }
 
-static int app_restore_state(app_state_t *state)
+/**
+ * @brief Mirror the LED state for the recovery after a watchdog reset
+ */
+static void app_keep_state(const app_state_t *state)
 {
-    nvs_led_state_t saved_state;
+    nvs_led_state_t led_state = {
+        .pwm_enabled = state->pwm_enabled,
+        .pwm_value = (uint32_t)state->current_position
+    };
+    deadline_monitor_keep_led_state(&led_state);
+}
 
-    if (nvs_manager_load_led_state(&saved_state) != 0) {
-        return -1;
+/**
+ * @brief Queue the LED state for the next flash commit, if storage is up
+ */
+static void app_save_state(const app_state_t *state)
+{
+    if (!state->storage_available) {
+        return;
     }
 
-    state->pwm_enabled = saved_state.pwm_enabled;
-    state->current_position = saved_state.pwm_value;
+    nvs_led_state_t led_state = {
+        .pwm_enabled = state->pwm_enabled,
+        .pwm_value = (uint32_t)state->current_position
+    };
+    nvs_manager_save_led_state(&led_state);
+}
+
+static void app_set_restored_state(app_state_t *state, const nvs_led_state_t *saved_state)
+{
+    state->pwm_enabled = saved_state->pwm_enabled;
+    state->current_position = saved_state->pwm_value;
     state->last_touch_count = 0;
     state->nvs_check_counter = 0;
+}
+
+/**
+ * @brief Restore the last state before NVS is up
+ *
+ * After a watchdog reset the state kept in RTC memory wins, since it may be
+ * newer than the last journal entry, and is applied at once: the light only
+ * blinked, so there is no inrush to soften. Otherwise the journal is read.
+ *
+ * @param recovered Set if the state came from before a watchdog reset
+ * @return true if the light was restored on the fast path
+ */
+static bool app_restore_state_fast(app_state_t *state, bool *recovered)
+{
+    nvs_led_state_t saved_state;
 
-    encoder_set_position((int32_t)saved_state.pwm_value);
+    *recovered = (deadline_monitor_recover_led_state(&saved_state) == 0);
+    if (!*recovered &&
+        (!CONFIG_ENABLE_NVS_STORAGE || nvs_manager_peek_led_state(&saved_state) != 0)) {
+        return false;
+    }
 
-    if (saved_state.pwm_enabled) {
-        pwm_controller_set_brightness(saved_state.pwm_value);
+    app_set_restored_state(state, &saved_state);
+    if (*recovered) {
+        app_apply_output(state);
     } else {
-        pwm_controller_set_brightness(0);
+        app_power_on_output(state);
+    }
+    return true;
+}
+
+static int app_restore_state(app_state_t *state)
+{
+    nvs_led_state_t saved_state;
+
+    if (nvs_manager_load_led_state(&saved_state) != 0) {
+        return -1;
     }
 
+    app_set_restored_state(state, &saved_state);
+    app_power_on_output(state);
+
     return 0;
 }
 
@@ -73,12 +247,7 @@ static void app_handle_encoder_change(int32_t position, app_state_t *state)
 
     if (state->pwm_enabled) {
         pwm_controller_set_brightness((uint32_t)position);
-
-        nvs_led_state_t current_state = {
-            .pwm_enabled = state->pwm_enabled,
-            .pwm_value = (uint32_t)position
-        };
-        nvs_manager_save_led_state(&current_state);
+        app_save_state(state);
     }
 }
 
@@ -92,48 +261,145 @@ static void app_handle_touch_toggle(app_state_t *state)
         pwm_controller_set_brightness(0);
     }
 
-    nvs_led_state_t current_state = {
-        .pwm_enabled = state->pwm_enabled,
-        .pwm_value = (uint32_t)state->current_position
-    };
-    nvs_manager_save_led_state(&current_state);
+    app_save_state(state);
+}
+
+/**
+ * @brief Pick up input changes from the encoder and touch sensor
+ *
+ * Runs on every input event and once per main loop period, so changes
+ * behind a dropped event are still applied.
+ */
+static void app_poll_inputs(app_state_t *state)
+{
+    if (state->touch_available) {
+        uint32_t touch_count = touch_sensor_get_touch_count();
+        if (touch_count != state->last_touch_count) {
+            state->last_touch_count = touch_count;
+            app_handle_touch_toggle(state);
+        }
+    }
+
+    if (state->encoder_available) {
+        int32_t position = encoder_get_position();
+        if (position != state->current_position) {
+            app_handle_encoder_change(position, state);
+        }
+    }
+
+    app_keep_state(state);
+}
+
+/**
+ * @brief Log an input event (the sampling callbacks cannot log themselves)
+ */
+static void app_log_input_event(const input_event_t *event)
+{
+    switch (event->type) {
+    case INPUT_EVENT_ENCODER:
+        ESP_LOGD(TAG, "Encoder position %ld", event->value);
+        break;
+    case INPUT_EVENT_BUTTON:
+        ESP_LOGI(TAG, "Button pressed! Count: %ld | Scale factor changed to: %lu",
+                 event->value, encoder_get_scale_factor());
+        break;
+    case INPUT_EVENT_TOUCH:
+        ESP_LOGI(TAG, "Touch detected! Event count: %ld", event->value);
+        break;
+    }
 }
 
 void app_main(void)
 {
     ESP_LOGI(TAG, "Starting LED PWM Driver");
 
-    if (app_init_all_modules() != 0) {
+    app_state_t state = {
+        .pwm_enabled = CONFIG_NVS_DEFAULT_PWM_ENABLE,
+        .current_position = CONFIG_NVS_DEFAULT_PWM_VALUE
+    };
+
+    // Stage 1: output and light, from the fastest state source
+    if (CONFIG_ENABLE_ENERGY_METER && energy_init() != 0) {
+        ESP_LOGW(TAG, "Energy metering unavailable");
+    }
+    if (output_init() != 0 || pwm_controller_init() != 0) {
         return;
     }
+    app_boot_mark(BOOT_PHASE_OUTPUT);
+
+    bool recovered;
+    bool restored = app_restore_state_fast(&state, &recovered);
+    app_boot_mark(BOOT_PHASE_LIGHT);
+
+    // Stage 2: storage, then inputs (encoder init includes GPIO settle time).
+    // The light is already on, so failures from here on only cost features.
+    state.storage_available = CONFIG_ENABLE_NVS_STORAGE && app_init_storage() == 0;
+    if (CONFIG_ENABLE_NVS_STORAGE && !state.storage_available) {
+        ESP_LOGE(TAG, "Running without persistence");
+    }
+    if (!restored && (!state.storage_available || app_restore_state(&state) != 0)) {
+        app_power_on_output(&state);
+    }
+    if (recovered) {
+        app_save_state(&state);
+    }
+    app_keep_state(&state);
+    app_boot_mark(BOOT_PHASE_STORAGE);
+
+    if (app_init_inputs(&state) != 0) {
+        ESP_LOGE(TAG, "Running with limited input control");
+    }
+    if (state.encoder_available) {
+        encoder_set_position(state.current_position);
+    }
+    app_boot_mark(BOOT_PHASE_INPUTS);
 
-    app_state_t state = {0};
-    if (app_restore_state(&state) != 0) {
-        state.pwm_enabled = CONFIG_NVS_DEFAULT_PWM_ENABLE;
-        state.current_position = CONFIG_NVS_DEFAULT_PWM_VALUE;
+    const int main_loop_job = deadline_monitor_register(
+        "main_loop", (uint32_t)CONFIG_MAIN_LOOP_INTERVAL * 1000,
+        (uint32_t)CONFIG_DEADLINE_MAIN_LOOP_BUDGET_MS * 1000);
+    if (deadline_monitor_start() != 0) {
+        ESP_LOGW(TAG, "Deadline monitoring unavailable");
     }
 
+    app_boot_report();
+    heap_guard_arm();
+
     ESP_LOGI(TAG, "Entering main loop");
 
+    const int64_t period_us = (int64_t)CONFIG_MAIN_LOOP_INTERVAL * 1000;
+    int64_t next_period_us = esp_timer_get_time() + period_us;
+
     while (1) {
-        if (CONFIG_ENABLE_TOUCH_TOGGLE) {
-            uint32_t touch_count = touch_sensor_get_touch_count();
-            if (touch_count != state.last_touch_count) {
-                state.last_touch_count = touch_count;
-                app_handle_touch_toggle(&state);
-            }
+        // Handle input as it arrives until the next periodic pass is due
+        input_event_t event;
+        int64_t remaining_us = next_period_us - esp_timer_get_time();
+        if (remaining_us > 0 &&
+            input_events_wait(&event, (uint32_t)((remaining_us + 999) / 1000))) {
+            app_log_input_event(&event);
+            app_poll_inputs(&state);
+            continue;
         }
 
-        int32_t position = encoder_get_position();
-        if (position != state.current_position) {
-            app_handle_encoder_change(position, &state);
+        next_period_us += period_us;
+        if (next_period_us < esp_timer_get_time()) {
+            next_period_us = esp_timer_get_time() + period_us;
         }
 
-        if (++state.nvs_check_counter >= CONFIG_NVS_CHECK_COUNT) {
+        deadline_monitor_begin(main_loop_job);
+        app_poll_inputs(&state);
+
+        if (state.storage_available && ++state.nvs_check_counter >= CONFIG_NVS_CHECK_COUNT) {
             state.nvs_check_counter = 0;
+            if (CONFIG_ENABLE_ENERGY_METER) {
+                energy_persist();
+            }
             nvs_manager_check_pending_write();
         }
 
-        vTaskDelay(CONFIG_MAIN_LOOP_INTERVAL / portTICK_PERIOD_MS);
+        metrics_periodic();
+        heap_guard_periodic();
+        deadline_monitor_end(main_loop_job);
+
+        deadline_monitor_periodic();
     }
 }
@@ -0,0 +1,124 @@
+/**
+ * @file metrics.c
+ * @brief Runtime metrics snapshot
+ *
+ * Collects the counters exported by the individual modules into a single
+ * snapshot so they can be logged or reported together. Modules that are
+ * disabled in config.h leave their part of the snapshot zeroed.
+ */
+
+#include "metrics.h"
+#include "config.h"
+#include "nvs_manager.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "METRICS";
+
+static const char *CURRENT_FAULT_NAMES[] = { "ok", "open", "short" };
+
+static int64_t last_log_us = 0;
+
+/**
+ * @brief Fill a snapshot from all modules
+ */
+int metrics_get_snapshot(metrics_snapshot_t *snapshot)
+{
+    if (snapshot == NULL) {
+        return -1;
+    }
+
+    memset(snapshot, 0, sizeof(*snapshot));
+    snapshot->uptime_us = esp_timer_get_time();
+
+    pwm_controller_get_power_stats(&snapshot->power);
+
+    if (CONFIG_ENABLE_NVS_STORAGE) {
+        nvs_manager_get_policy_stats(&snapshot->flash);
+    }
+    if (CONFIG_ENABLE_THERMAL_DERATING) {
+        thermal_get_status(&snapshot->thermal);
+    }
+    if (CONFIG_ENABLE_DAYLIGHT) {
+        daylight_get_status(&snapshot->daylight);
+    }
+    if (CONFIG_ENABLE_CURRENT_SENSE) {
+        for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+            current_sense_get_channel(i, &snapshot->current[i]);
+        }
+    }
+    if (CONFIG_ENABLE_ENERGY_METER) {
+        for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+            energy_get_summary(i, &snapshot->energy[i]);
+        }
+    }
+    heap_guard_get_stats(&snapshot->heap);
+    output_get_handoff_stats(&snapshot->handoff);
+
+    return 0;
+}
+
+/**
+ * @brief Log a snapshot of all metrics
+ */
+void metrics_log_snapshot(void)
+{
+    metrics_snapshot_t snapshot;
+
+    if (metrics_get_snapshot(&snapshot) != 0) {
+        return;
+    }
+
+    ESP_LOGI(TAG, "Uptime %lld s", snapshot.uptime_us / 1000000);
+    ESP_LOGI(TAG, "  power: %lu/%lu mW, %lu limited of %lu frames",
+             snapshot.power.output_mw, snapshot.power.requested_mw,
+             snapshot.power.limit_events, snapshot.power.frames);
+    ESP_LOGI(TAG, "  flash: %lu commits, ~%lu erases, idle %lu ms",
+             snapshot.flash.commits, snapshot.flash.estimated_erases,
+             snapshot.flash.effective_idle_ms);
+    ESP_LOGI(TAG, "  thermal: %ld.%ld C, level %lu%%, %lu faults",
+             snapshot.thermal.temperature_dc / 10, labs(snapshot.thermal.temperature_dc % 10),
+             (snapshot.thermal.level_q16 * 100) / PWM_MASTER_UNITY_Q16,
+             snapshot.thermal.sensor_faults);
+    ESP_LOGI(TAG, "  daylight: %lu lux, trim %lu%%, %lu faults",
+             snapshot.daylight.lux, (snapshot.daylight.level_q16 * 100) / PWM_MASTER_UNITY_Q16,
+             snapshot.daylight.sensor_faults);
+    for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+        const current_sense_channel_t *current = &snapshot.current[i];
+        ESP_LOGI(TAG, "  LED %lu: on %lu mA, off %lu mA, avg %lu mA, %lu/%lu samples, %s",
+                 i + 1, current->on_ma, current->off_ma, current->average_ma,
+                 current->samples, current->samples + current->skipped,
+                 CURRENT_FAULT_NAMES[current->fault]);
+    }
+    for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+        const energy_summary_t *energy = &snapshot.energy[i];
+        ESP_LOGI(TAG, "  LED %lu: %lu Wh, %lu h on, %lu ppm of rated life used",
+                 i + 1, energy->energy_wh, energy->on_hours, energy->life_used_ppm);
+    }
+    ESP_LOGI(TAG, "  heap: %lu free, %lu minimum, %lu allocations after init",
+             snapshot.heap.free_bytes, snapshot.heap.minimum_free_bytes,
+             snapshot.heap.late_allocs);
+    ESP_LOGI(TAG, "  handoff: %lu frames, max %lu us staging, max %lu us queued, %lu overflows",
+             snapshot.handoff.frames, snapshot.handoff.max_stage_us,
+             snapshot.handoff.max_handoff_us, snapshot.handoff.overflows);
+}
+
+/**
+ * @brief Log a snapshot every CONFIG_METRICS_LOG_INTERVAL_MS
+ *
+ * Called from the main loop.
+ */
+void metrics_periodic(void)
+{
+    if (CONFIG_METRICS_LOG_INTERVAL_MS == 0) {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    if (now_us - last_log_us >= (int64_t)CONFIG_METRICS_LOG_INTERVAL_MS * 1000) {
+        last_log_us = now_us;
+        metrics_log_snapshot();
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pwm_controller.h"
+#include "nvs_policy.h"
+#include "thermal.h"
+#include "daylight.h"
+#include "current_sense.h"
+#include "energy.h"
+#include "heap_guard.h"
+#include "output.h"
+
+typedef struct {
+    int64_t uptime_us;
+    pwm_power_stats_t power;
+    nvs_policy_stats_t flash;
+    thermal_status_t thermal;
+    daylight_status_t daylight;
+    current_sense_channel_t current[PWM_CHANNEL_COUNT];
+    energy_summary_t energy[PWM_CHANNEL_COUNT];
+    heap_guard_stats_t heap;
+    output_handoff_stats_t handoff;
+} metrics_snapshot_t;
+
+int metrics_get_snapshot(metrics_snapshot_t *snapshot);
+
+void metrics_log_snapshot(void);
+
+void metrics_periodic(void);
+
+#endif
@@ -1,7 +1,10 @@
 #include "nvs_manager.h"
 #include "config.h"
+#include "state_journal.h"
+#include "deadline_monitor.h"
 #include "nvs_flash.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <string.h>
@@ -17,7 +20,11 @@ static const char *TAG = "NVS_MANAGER";
 static const char *NVS_NAMESPACE = CONFIG_NVS_NAMESPACE;
 static const char *NVS_KEY_PWM_ENABLED = CONFIG_NVS_KEY_PWM_ENABLED;
 static const char *NVS_KEY_PWM_VALUE = CONFIG_NVS_KEY_PWM_VALUE;
-static const uint32_t FLASH_WRITE_DEBOUNCE_MS = CONFIG_FLASH_WRITE_DEBOUNCE;
+static const char *NVS_KEY_ENERGY = CONFIG_NVS_KEY_ENERGY;
+
+// NVS entries are 32 bytes; a blob also costs a data header and an index entry
+#define NVS_ENTRIES_PER_PAGE          (CONFIG_NVS_COMMITS_PER_PAGE * 2)
+#define NVS_ENERGY_ENTRIES            ((sizeof(energy_meter_data_t) + 31) / 32 + 2)
 
 // Cache for last saved state to optimize write cycles
 static nvs_led_state_t last_saved_state = {
@@ -31,9 +38,24 @@ static nvs_led_state_t pending_state = {
     .pwm_enabled = CONFIG_NVS_DEFAULT_PWM_ENABLE,
     .pwm_value = CONFIG_NVS_DEFAULT_PWM_VALUE
 };
-static uint32_t pending_timestamp = 0;
 static bool pending_write = false;
 
+// Commit policy (idle threshold, staleness bound, daily budget)
+static nvs_policy_t commit_policy;
+
+// Energy totals change continuously while lit; their own policy paces them
+static energy_meter_data_t pending_energy;
+static bool pending_energy_write = false;
+static nvs_policy_t energy_policy;
+
+/**
+ * @brief Current time in milliseconds for the commit policy
+ */
+static uint32_t nvs_manager_now_ms(void)
+{
+    return xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
 /**
  * Initialize NVS (Non-Volatile Storage)
  */
@@ -54,6 +76,28 @@ int nvs_manager_init(void)
     
     ESP_LOGI(TAG, "NVS initialized successfully");
     
+    if (CONFIG_ENABLE_STATE_JOURNAL && !state_journal_is_available() &&
+        state_journal_init() != 0) {
+        ESP_LOGW(TAG, "State journal unavailable, using NVS keys");
+    }
+    
+    nvs_policy_config_t policy_config = {
+        .idle_ms = CONFIG_FLASH_WRITE_DEBOUNCE,
+        .max_staleness_ms = CONFIG_NVS_MAX_STALENESS_MS,
+        .daily_write_budget = CONFIG_NVS_DAILY_WRITE_BUDGET,
+        .commits_per_erase = state_journal_is_available() ?
+                             STATE_JOURNAL_RECORDS_PER_SECTOR : CONFIG_NVS_COMMITS_PER_PAGE
+    };
+    nvs_policy_init(&commit_policy, &policy_config, nvs_manager_now_ms());
+    
+    nvs_policy_config_t energy_policy_config = {
+        .idle_ms = CONFIG_ENERGY_PERSIST_INTERVAL_MS,
+        .max_staleness_ms = CONFIG_ENERGY_PERSIST_INTERVAL_MS,
+        .daily_write_budget = NVS_POLICY_DAY_MS / CONFIG_ENERGY_PERSIST_INTERVAL_MS,
+        .commits_per_erase = NVS_ENTRIES_PER_PAGE / NVS_ENERGY_ENTRIES
+    };
+    nvs_policy_init(&energy_policy, &energy_policy_config, nvs_manager_now_ms());
+    
     // Load initial state from flash
     if (nvs_manager_load_led_state(&last_saved_state) == 0) {
         state_cached = true;
@@ -68,6 +112,32 @@ int nvs_manager_init(void)
     return 0;
 }
 
+/**
+ * Read the newest LED state from the journal without initializing NVS
+ *
+ * Used on the fast boot path: the journal is a raw partition, so it can be
+ * read before the NVS subsystem (page scan, key index) is up.
+ *
+ * @return 0 if a saved state was found, -1 otherwise
+ */
+int nvs_manager_peek_led_state(nvs_led_state_t *state)
+{
+    if (state == NULL) {
+        ESP_LOGE(TAG, "Invalid state pointer");
+        return -1;
+    }
+    
+    if (!CONFIG_ENABLE_STATE_JOURNAL) {
+        return -1;
+    }
+    
+    if (!state_journal_is_available() && state_journal_init() != 0) {
+        return -1;
+    }
+    
+    return state_journal_read_latest(state);
+}
+
 /**
  * Load LED state from flash
  */
@@ -78,6 +148,13 @@ int nvs_manager_load_led_state(nvs_led_state_t *state)
         return -1;
     }
     
+    // The journal holds the newest state; NVS keys are the legacy fallback
+    if (state_journal_read_latest(state) == 0) {
+        ESP_LOGI(TAG, "Loaded from journal: enabled=%d, pwm=%lu",
+                 state->pwm_enabled, state->pwm_value);
+        return 0;
+    }
+    
     nvs_handle_t nvs_handle;
     esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
     
@@ -128,7 +205,11 @@ int nvs_manager_save_led_state(const nvs_led_state_t *state)
     if (state_cached && 
         last_saved_state.pwm_enabled == state->pwm_enabled &&
         last_saved_state.pwm_value == state->pwm_value) {
-        // No change from last saved, skip write
+        // Back to the saved value, drop any pending write
+        if (pending_write) {
+            pending_write = false;
+            nvs_policy_cancel(&commit_policy);
+        }
         return 0;
     }
     
@@ -142,19 +223,19 @@ int nvs_manager_save_led_state(const nvs_led_state_t *state)
     
     // Queue a pending write
     pending_state = *state;
-    pending_timestamp = xTaskGetTickCount() * portTICK_PERIOD_MS;
     pending_write = true;
+    nvs_policy_note_change(&commit_policy, nvs_manager_now_ms());
     
-    ESP_LOGD(TAG, "Queued state change: enabled=%d, pwm=%lu (will write in 5s if stable)",
-             state->pwm_enabled, state->pwm_value);
+    ESP_LOGD(TAG, "Queued state change: enabled=%d, pwm=%lu (idle threshold %lu ms)",
+             state->pwm_enabled, state->pwm_value, commit_policy.stats.effective_idle_ms);
     
     return 0;
 }
 
 /**
- * Internal function to perform actual flash write
+ * Write LED state as NVS key/value pairs
  */
-static int nvs_manager_commit_write(const nvs_led_state_t *state)
+static int nvs_manager_commit_nvs(const nvs_led_state_t *state)
 {
     nvs_handle_t nvs_handle;
     esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
@@ -189,6 +270,30 @@ static int nvs_manager_commit_write(const nvs_led_state_t *state)
     }
     
     nvs_close(nvs_handle);
+    return 0;
+}
+
+/**
+ * Internal function to perform actual flash write
+ */
+static int nvs_manager_commit_write(const nvs_led_state_t *state)
+{
+    int64_t flash_start_us = esp_timer_get_time();
+    int result;
+
+    if (state_journal_is_available()) {
+        result = state_journal_append(state);
+    } else {
+        result = nvs_manager_commit_nvs(state);
+    }
+    deadline_monitor_note_block(DEADLINE_CAUSE_FLASH, flash_start_us);
+
+    if (result != 0) {
+        if (state_journal_is_available()) {
+            ESP_LOGE(TAG, "Failed to append state to journal");
+        }
+        return -1;
+    }
     
     // Update cache with new values
     last_saved_state = *state;
@@ -202,26 +307,148 @@ static int nvs_manager_commit_write(const nvs_led_state_t *state)
 }
 
 /**
- * Check and commit pending writes if debounce time has elapsed
- * Should be called periodically (e.g., every 100ms) from main task
+ * Commit the pending LED state when its policy allows it
  */
-int nvs_manager_check_pending_write(void)
+static int nvs_manager_check_led_write(uint32_t current_time)
 {
     if (!pending_write) {
         return 0;  // No pending write
     }
     
-    uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    uint32_t elapsed_time = current_time - pending_timestamp;
+    if (!nvs_policy_should_commit(&commit_policy, current_time)) {
+        // Still waiting for idle, staleness or budget
+        return 0;
+    }
+    
+    int result = nvs_manager_commit_write(&pending_state);
+    pending_write = false;
+    
+    if (result == 0) {
+        nvs_policy_note_commit(&commit_policy, current_time);
+        ESP_LOGI(TAG, "Commit #%lu (%lu today), est. erases %lu, idle threshold %lu ms",
+                 commit_policy.stats.commits, commit_policy.stats.commits_in_window,
+                 commit_policy.stats.estimated_erases, commit_policy.stats.effective_idle_ms);
+    } else {
+        nvs_policy_cancel(&commit_policy);
+    }
+    
+    return result;
+}
+
+/**
+ * Commit the pending energy totals when their policy allows it
+ */
+static int nvs_manager_check_energy_write(uint32_t current_time)
+{
+    if (!pending_energy_write || !nvs_policy_should_commit(&energy_policy, current_time)) {
+        return 0;
+    }
+    
+    nvs_handle_t nvs_handle;
+    int64_t flash_start_us = esp_timer_get_time();
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(nvs_handle, NVS_KEY_ENERGY, &pending_energy, sizeof(pending_energy));
+        if (ret == ESP_OK) {
+            ret = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
+    }
+    deadline_monitor_note_block(DEADLINE_CAUSE_FLASH, flash_start_us);
+    pending_energy_write = false;
+    
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write energy totals: 0x%x", ret);
+        nvs_policy_cancel(&energy_policy);
+        return -1;
+    }
+    
+    nvs_policy_note_commit(&energy_policy, current_time);
+    ESP_LOGI(TAG, "Committed energy totals (%u bytes)", (unsigned)sizeof(pending_energy));
+    return 0;
+}
+
+/**
+ * Check and commit pending writes when the commit policy allows it
+ * Should be called periodically (e.g., every 100ms) from main task
+ */
+int nvs_manager_check_pending_write(void)
+{
+    uint32_t current_time = nvs_manager_now_ms();
+    
+    int result = nvs_manager_check_led_write(current_time);
+    if (nvs_manager_check_energy_write(current_time) != 0) {
+        result = -1;
+    }
+    
+    return result;
+}
+
+/**
+ * Load persisted energy totals
+ *
+ * @return 0 on success, -1 if none are stored or the layout changed
+ */
+int nvs_manager_load_energy(energy_meter_data_t *data)
+{
+    if (data == NULL) {
+        ESP_LOGE(TAG, "Invalid energy pointer");
+        return -1;
+    }
+    
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return -1;
+    }
+    
+    size_t length = sizeof(*data);
+    esp_err_t ret = nvs_get_blob(nvs_handle, NVS_KEY_ENERGY, data, &length);
+    nvs_close(nvs_handle);
+    
+    if (ret != ESP_OK || length != sizeof(*data)) {
+        if (ret != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGW(TAG, "Energy totals unreadable (0x%x, %u bytes), ignoring",
+                     ret, (unsigned)length);
+        }
+        return -1;
+    }
+    
+    return 0;
+}
+
+/**
+ * Queue energy totals for a policy-paced write
+ */
+int nvs_manager_save_energy(const energy_meter_data_t *data)
+{
+    if (data == NULL) {
+        ESP_LOGE(TAG, "Invalid energy pointer");
+        return -1;
+    }
+    
+    // Totals only grow while lit; nothing to do while the light is off
+    if (memcmp(&pending_energy, data, sizeof(*data)) == 0) {
+        return 0;
+    }
+    
+    pending_energy = *data;
+    pending_energy_write = true;
+    nvs_policy_note_change(&energy_policy, nvs_manager_now_ms());
     
-    if (elapsed_time >= FLASH_WRITE_DEBOUNCE_MS) {
-        // Debounce time has elapsed, commit the pending write
-        int result = nvs_manager_commit_write(&pending_state);
-        pending_write = false;
-        return result;
+    return 0;
+}
+
+/**
+ * Get commit policy counters (commits, erase estimate, adapted idle time)
+ */
+int nvs_manager_get_policy_stats(nvs_policy_stats_t *stats)
+{
+    if (stats == NULL) {
+        ESP_LOGE(TAG, "Invalid stats pointer");
+        return -1;
     }
     
-    // Debounce timer still running
+    *stats = commit_policy.stats;
     return 0;
 }
 
@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "nvs_policy.h"
+#include "energy_meter.h"
 
 typedef struct {
     bool pwm_enabled;
@@ -11,6 +13,8 @@ typedef struct {
 
 int nvs_manager_init(void);
 
+int nvs_manager_peek_led_state(nvs_led_state_t *state);
+
 int nvs_manager_load_led_state(nvs_led_state_t *state);
 
 int nvs_manager_save_led_state(const nvs_led_state_t *state);
@@ -19,4 +23,10 @@ int nvs_manager_get_last_state(nvs_led_state_t *state);
 
 int nvs_manager_check_pending_write(void);
 
+int nvs_manager_get_policy_stats(nvs_policy_stats_t *stats);
+
+int nvs_manager_load_energy(energy_meter_data_t *data);
+
+int nvs_manager_save_energy(const energy_meter_data_t *data);
+
 #endif
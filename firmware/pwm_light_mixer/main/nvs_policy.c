@@ -0,0 +1,146 @@
+/**
+ * @file nvs_policy.c
+ * @brief Adaptive flash commit policy
+ *
+ * Decides when a queued state change should be written to flash:
+ * - Idle: input has been quiet for the (adapted) idle threshold
+ * - Staleness: the oldest unsaved change reached the hard upper bound, so
+ *   continuous adjustment can no longer postpone the write forever
+ * - Budget: commits are paced against a daily write budget; when the budget
+ *   runs ahead of schedule the idle threshold backs off, and once it is
+ *   exhausted only the staleness bound can trigger a commit
+ *
+ * Pure logic with caller-supplied millisecond timestamps (wrap-safe
+ * differences), so the same code runs on target and in host simulations.
+ */
+
+#include "nvs_policy.h"
+#include <string.h>
+
+/**
+ * @brief Roll the 24 h budget window forward if it has expired
+ */
+static void nvs_policy_roll_window(nvs_policy_t *policy, uint32_t now_ms)
+{
+    while (now_ms - policy->window_start_ms >= NVS_POLICY_DAY_MS) {
+        policy->window_start_ms += NVS_POLICY_DAY_MS;
+        policy->stats.commits_in_window = 0;
+    }
+}
+
+/**
+ * @brief Adapt the idle threshold to the budget consumption rate
+ *
+ * Compares commits so far with the share of the budget that the elapsed
+ * part of the window allows. Running ahead doubles the threshold (up to the
+ * staleness bound); running well behind halves it back toward the base.
+ */
+static void nvs_policy_adapt(nvs_policy_t *policy, uint32_t now_ms)
+{
+    const nvs_policy_config_t *config = &policy->config;
+    uint32_t elapsed = now_ms - policy->window_start_ms;
+    uint32_t allowed = (uint32_t)(((uint64_t)config->daily_write_budget * elapsed) /
+                                  NVS_POLICY_DAY_MS);
+    uint32_t idle = policy->stats.effective_idle_ms;
+
+    if (policy->stats.commits_in_window > allowed + 1) {
+        idle = (idle > config->max_staleness_ms / 2) ? config->max_staleness_ms : idle * 2;
+    } else if (policy->stats.commits_in_window * 2 < allowed) {
+        idle = (idle / 2 < config->idle_ms) ? config->idle_ms : idle / 2;
+    }
+
+    policy->stats.effective_idle_ms = idle;
+}
+
+/**
+ * @brief Initialize a policy instance
+ */
+void nvs_policy_init(nvs_policy_t *policy, const nvs_policy_config_t *config, uint32_t now_ms)
+{
+    memset(policy, 0, sizeof(*policy));
+    policy->config = *config;
+    if (policy->config.max_staleness_ms < policy->config.idle_ms) {
+        policy->config.max_staleness_ms = policy->config.idle_ms;
+    }
+    if (policy->config.commits_per_erase == 0) {
+        policy->config.commits_per_erase = 1;
+    }
+    policy->stats.effective_idle_ms = policy->config.idle_ms;
+    policy->window_start_ms = now_ms;
+}
+
+/**
+ * @brief Record a new unsaved state change
+ */
+void nvs_policy_note_change(nvs_policy_t *policy, uint32_t now_ms)
+{
+    if (!policy->pending) {
+        policy->pending = true;
+        policy->deferral_counted = false;
+        policy->first_change_ms = now_ms;
+    }
+    policy->last_change_ms = now_ms;
+}
+
+/**
+ * @brief Decide whether the pending change should be committed now
+ */
+bool nvs_policy_should_commit(nvs_policy_t *policy, uint32_t now_ms)
+{
+    if (!policy->pending) {
+        return false;
+    }
+
+    nvs_policy_roll_window(policy, now_ms);
+
+    if (now_ms - policy->first_change_ms >= policy->config.max_staleness_ms) {
+        return true;
+    }
+
+    if (now_ms - policy->last_change_ms < policy->stats.effective_idle_ms) {
+        return false;
+    }
+
+    if (policy->stats.commits_in_window >= policy->config.daily_write_budget) {
+        if (!policy->deferral_counted) {
+            policy->deferral_counted = true;
+            policy->stats.budget_deferrals++;
+        }
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Record a completed commit and update wear estimates
+ */
+void nvs_policy_note_commit(nvs_policy_t *policy, uint32_t now_ms)
+{
+    nvs_policy_roll_window(policy, now_ms);
+
+    if (policy->pending && now_ms - policy->first_change_ms >= policy->config.max_staleness_ms) {
+        policy->stats.commits_stale++;
+    } else {
+        policy->stats.commits_idle++;
+    }
+
+    policy->stats.commits++;
+    policy->stats.commits_in_window++;
+    policy->pending = false;
+
+    if (++policy->commits_since_erase >= policy->config.commits_per_erase) {
+        policy->commits_since_erase = 0;
+        policy->stats.estimated_erases++;
+    }
+
+    nvs_policy_adapt(policy, now_ms);
+}
+
+/**
+ * @brief Drop the pending change (e.g. state returned to the saved value)
+ */
+void nvs_policy_cancel(nvs_policy_t *policy)
+{
+    policy->pending = false;
+}
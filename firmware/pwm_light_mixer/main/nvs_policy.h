@@ -0,0 +1,47 @@
+#ifndef NVS_POLICY_H
+#define NVS_POLICY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define NVS_POLICY_DAY_MS             (24u * 60u * 60u * 1000u)
+
+typedef struct {
+    uint32_t idle_ms;               ///< Commit once input has been idle this long
+    uint32_t max_staleness_ms;      ///< Commit at the latest this long after the first change
+    uint32_t daily_write_budget;    ///< Target commits per 24 h window
+    uint32_t commits_per_erase;     ///< Backend estimate: commits per sector erase
+} nvs_policy_config_t;
+
+typedef struct {
+    uint32_t commits;               ///< Total commits
+    uint32_t commits_idle;          ///< Commits triggered by the idle threshold
+    uint32_t commits_stale;         ///< Commits forced by the staleness bound
+    uint32_t commits_in_window;     ///< Commits in the current 24 h window
+    uint32_t budget_deferrals;      ///< Idle commits held back by an exhausted budget
+    uint32_t estimated_erases;      ///< Estimated sector erases caused by commits
+    uint32_t effective_idle_ms;     ///< Current (adapted) idle threshold
+} nvs_policy_stats_t;
+
+typedef struct {
+    nvs_policy_config_t config;
+    nvs_policy_stats_t stats;
+    uint32_t window_start_ms;
+    uint32_t first_change_ms;
+    uint32_t last_change_ms;
+    uint32_t commits_since_erase;
+    bool pending;
+    bool deferral_counted;
+} nvs_policy_t;
+
+void nvs_policy_init(nvs_policy_t *policy, const nvs_policy_config_t *config, uint32_t now_ms);
+
+void nvs_policy_note_change(nvs_policy_t *policy, uint32_t now_ms);
+
+bool nvs_policy_should_commit(nvs_policy_t *policy, uint32_t now_ms);
+
+void nvs_policy_note_commit(nvs_policy_t *policy, uint32_t now_ms);
+
+void nvs_policy_cancel(nvs_policy_t *policy);
+
+#endif
@@ -0,0 +1,477 @@
+/**
+ * @file output.c
+ * @brief Output registry and frame scheduling
+ *
+ * Registers every enabled output driver (LEDC always; the PCA9685
+ * expander, the WS2812 strip, the BAM engine and the sigma-delta outputs
+ * when their feature flags are set) with an output_scheduler and fans each frame from
+ * pwm_controller out to all of them. Immediate outputs are committed in the staging call; outputs with
+ * a native frame rate are committed later from a one-shot esp_timer armed
+ * for the scheduler's next deadline, so a fast encoder never floods a slow
+ * bus and the last staged frame always goes out.
+ *
+ * With CONFIG_ENABLE_OUTPUT_TASK the staging call only copies the frame
+ * into a lock-free ring (spsc_ring.c) and wakes the output task pinned to
+ * CONFIG_OUTPUT_CORE, which stages the newest frame and runs all commits;
+ * the commit timer only wakes the task. Inputs, sensing and the main loop
+ * stay on CONFIG_INPUT_CORE, so bus transfers never stall them and they
+ * never delay a commit. Producers are serialized by the pwm_controller
+ * mutex, which makes the ring single-producer.
+ *
+ * Time-driven effects (the pwm_controller ramp) are composed on the output
+ * core too: their timer calls output_request_effects(), and the output task
+ * runs the effects hook before taking the newest frame, so each step is
+ * staged in the same wake-up.
+ */
+
+#include "output.h"
+#include "output_ledc.h"
+#include "pca9685.h"
+#include "ws2812.h"
+#include "bam.h"
+#include "sdm.h"
+#include "spsc_ring.h"
+#include "deadline_monitor.h"
+#include "config.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <string.h>
+
+static const char *TAG = "OUTPUT";
+
+static output_scheduler_t scheduler;
+static esp_timer_handle_t commit_timer = NULL;
+
+// Serializes frame staging against deferred commits
+static SemaphoreHandle_t output_mutex = NULL;
+static StaticSemaphore_t output_mutex_buffer;
+
+/** One frame queued for the output task */
+typedef struct {
+    int64_t staged_us;
+    uint32_t count;
+    uint16_t duty[CONFIG_OUTPUT_FRAME_CHANNELS];
+} output_frame_t;
+
+static spsc_ring_t frame_ring;
+static output_frame_t frame_ring_storage[CONFIG_OUTPUT_RING_DEPTH];
+
+static TaskHandle_t output_task_handle = NULL;
+static int commit_job = -1;
+static StackType_t output_task_stack[CONFIG_OUTPUT_TASK_STACK];
+static StaticTask_t output_task_buffer;
+
+// Set by the output task when staging the newest frame failed, so the producer retries
+static bool stage_failed = false;
+
+static output_effects_fn_t effects_hook = NULL;
+static bool effects_due = false;
+
+/** Handoff counters written by the producer (output_stage_frame) */
+typedef struct {
+    uint32_t frames;
+    uint32_t overflows;
+    uint32_t max_stage_us;
+} output_producer_stats_t;
+
+/** Handoff counters written by the output task */
+typedef struct {
+    uint32_t coalesced;
+    uint32_t max_handoff_us;
+} output_consumer_stats_t;
+
+// Each half has its own lock, so a snapshot from another task never reads
+// a counter mid-update: producer_stats under producer_spinlock (the
+// producer's own pwm_controller mutex is not ours to take), consumer_stats
+// under output_mutex
+static output_producer_stats_t producer_stats;
+static output_consumer_stats_t consumer_stats;
+static portMUX_TYPE producer_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Arm the commit timer for the next deadline (mutex must be held)
+ */
+static void output_arm_timer(int64_t next_us, int64_t now_us)
+{
+    esp_timer_stop(commit_timer);
+
+    if (next_us == OUTPUT_SCHEDULER_IDLE) {
+        return;
+    }
+
+    int64_t delay_us = next_us - now_us;
+    esp_timer_start_once(commit_timer, (delay_us > 0) ? (uint64_t)delay_us : 1);
+}
+
+/**
+ * @brief Output task: run requested effects, stage the newest queued frame
+ *        and run due commits
+ *
+ * Woken by output_stage_frame, output_request_effects and the commit timer.
+ */
+static void output_task(void *arg)
+{
+    output_frame_t frame;
+    output_frame_t newest;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        deadline_monitor_begin(commit_job);
+
+        // Effects queue their frame here, before the ring is drained below
+        if (__atomic_exchange_n(&effects_due, false, __ATOMIC_ACQ_REL) && effects_hook != NULL) {
+            effects_hook();
+        }
+
+        deadline_monitor_take(output_mutex);
+
+        int64_t now_us = esp_timer_get_time();
+        int64_t next_us;
+        uint32_t popped = 0;
+
+        // Frames carry the whole state, so only the newest one matters
+        while (spsc_ring_pop(&frame_ring, &frame) == 0) {
+            newest = frame;
+            popped++;
+        }
+
+        if (popped > 0) {
+            uint32_t handoff_us = (uint32_t)(now_us - newest.staged_us);
+            if (handoff_us > consumer_stats.max_handoff_us) {
+                consumer_stats.max_handoff_us = handoff_us;
+            }
+            consumer_stats.coalesced += popped - 1;
+
+            int result = output_scheduler_stage(&scheduler, newest.duty, newest.count,
+                                                now_us, &next_us);
+            __atomic_store_n(&stage_failed, result != 0, __ATOMIC_RELEASE);
+        }
+
+        output_scheduler_service(&scheduler, now_us, &next_us);
+        output_arm_timer(next_us, now_us);
+
+        xSemaphoreGive(output_mutex);
+        deadline_monitor_end(commit_job);
+    }
+}
+
+/**
+ * @brief Deferred commit timer callback (esp_timer task)
+ */
+static void output_commit_timer_callback(void *arg)
+{
+    if (CONFIG_ENABLE_OUTPUT_TASK) {
+        xTaskNotifyGive(output_task_handle);
+        return;
+    }
+
+    xSemaphoreTake(output_mutex, portMAX_DELAY);
+
+    int64_t now_us = esp_timer_get_time();
+    int64_t next_us;
+    output_scheduler_service(&scheduler, now_us, &next_us);
+    output_arm_timer(next_us, now_us);
+
+    xSemaphoreGive(output_mutex);
+}
+
+/** GPIO claimed by an enabled output */
+typedef struct {
+    int gpio;
+    const char *owner;
+} output_pin_t;
+
+/**
+ * @brief Check that no GPIO is driven by two enabled outputs
+ *
+ * @return 0 if all pins are distinct, -1 on a conflict
+ */
+static int output_check_pins(void)
+{
+    static const int BAM_PINS[CONFIG_BAM_CHANNELS] = CONFIG_BAM_DATA_PINS;
+    output_pin_t pins[CONFIG_BAM_CHANNELS + 9];
+    uint32_t count = 0;
+
+    pins[count++] = (output_pin_t){ CONFIG_LED_PIN_1, "ledc" };
+    pins[count++] = (output_pin_t){ CONFIG_LED_PIN_2, "ledc" };
+    if (CONFIG_ENABLE_PCA9685) {
+        pins[count++] = (output_pin_t){ CONFIG_PCA9685_SDA_PIN, "pca9685" };
+        pins[count++] = (output_pin_t){ CONFIG_PCA9685_SCL_PIN, "pca9685" };
+    }
+    if (CONFIG_ENABLE_WS2812) {
+        pins[count++] = (output_pin_t){ CONFIG_WS2812_PIN, "ws2812" };
+    }
+    if (CONFIG_ENABLE_BAM) {
+        for (uint32_t i = 0; i < CONFIG_BAM_CHANNELS; i++) {
+            pins[count++] = (output_pin_t){ BAM_PINS[i], "bam" };
+        }
+        pins[count++] = (output_pin_t){ CONFIG_BAM_WR_PIN, "bam" };
+        pins[count++] = (output_pin_t){ CONFIG_BAM_DC_PIN, "bam" };
+    }
+    if (CONFIG_ENABLE_SDM) {
+        pins[count++] = (output_pin_t){ CONFIG_SDM_PIN_1, "sdm" };
+        pins[count++] = (output_pin_t){ CONFIG_SDM_PIN_2, "sdm" };
+    }
+
+    int result = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        for (uint32_t j = i + 1; j < count; j++) {
+            if (pins[i].gpio == pins[j].gpio) {
+                ESP_LOGE(TAG, "GPIO %d claimed by %s and %s", pins[i].gpio, pins[i].owner,
+                         pins[j].owner);
+                result = -1;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Register one driver, logging its capabilities
+ */
+static int output_register(const output_driver_t *driver, uint32_t base_channel)
+{
+    int index = output_scheduler_register(&scheduler, driver, base_channel);
+    if (index < 0) {
+        ESP_LOGE(TAG, "Failed to register output %s", driver->name);
+        return -1;
+    }
+
+    const output_caps_t *caps = &scheduler.slots[index].caps;
+    ESP_LOGI(TAG, "  %s: %lu channels from %lu, %lu-bit, %lu Hz%s", driver->name,
+             caps->channel_count, base_channel, caps->resolution_bits, caps->max_refresh_hz,
+             (caps->max_refresh_hz == 0) ? " (immediate)" : "");
+    return 0;
+}
+
+/**
+ * @brief Initialize and register all enabled outputs
+ *
+ * @return 0 on success, -1 if the on-board LEDC output is unavailable or
+ *         two enabled outputs share a GPIO
+ */
+int output_init(void)
+{
+    ESP_LOGI(TAG, "Initializing outputs");
+
+    if (output_check_pins() != 0) {
+        return -1;
+    }
+
+    output_mutex = xSemaphoreCreateMutexStatic(&output_mutex_buffer);
+    if (output_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex");
+        return -1;
+    }
+
+    const esp_timer_create_args_t commit_timer_args = {
+        .callback = output_commit_timer_callback,
+        .name = "output_commit"
+    };
+    if (esp_timer_create(&commit_timer_args, &commit_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create commit timer");
+        return -1;
+    }
+
+    output_scheduler_init(&scheduler);
+
+    if (CONFIG_ENABLE_OUTPUT_TASK) {
+        if (spsc_ring_init(&frame_ring, frame_ring_storage, sizeof(output_frame_t),
+                           CONFIG_OUTPUT_RING_DEPTH) != 0) {
+            ESP_LOGE(TAG, "Invalid frame ring depth %d", CONFIG_OUTPUT_RING_DEPTH);
+            return -1;
+        }
+
+        // Wake-to-commit time of the output task
+        commit_job = deadline_monitor_register("frame_commit", 0,
+                                               CONFIG_DEADLINE_COMMIT_BUDGET_US);
+
+        output_task_handle = xTaskCreateStaticPinnedToCore(
+            output_task, "output_task", CONFIG_OUTPUT_TASK_STACK, NULL,
+            CONFIG_OUTPUT_TASK_PRIORITY, output_task_stack, &output_task_buffer,
+            CONFIG_OUTPUT_CORE);
+        if (output_task_handle == NULL) {
+            ESP_LOGE(TAG, "Failed to create output task");
+            return -1;
+        }
+        ESP_LOGI(TAG, "Output task on core %d", CONFIG_OUTPUT_CORE);
+    }
+
+    if (output_register(output_ledc_driver(), 0) != 0) {
+        return -1;
+    }
+
+    if (CONFIG_ENABLE_PCA9685 &&
+        output_register(pca9685_output_driver(), CONFIG_OUTPUT_PCA9685_BASE_CHANNEL) != 0) {
+        ESP_LOGW(TAG, "PCA9685 expander unavailable");
+    }
+
+    if (CONFIG_ENABLE_WS2812 &&
+        output_register(ws2812_output_driver(), CONFIG_OUTPUT_WS2812_BASE_CHANNEL) != 0) {
+        ESP_LOGW(TAG, "Addressable strip unavailable");
+    }
+
+    if (CONFIG_ENABLE_BAM &&
+        output_register(bam_output_driver(), CONFIG_OUTPUT_BAM_BASE_CHANNEL) != 0) {
+        ESP_LOGW(TAG, "BAM engine unavailable");
+    }
+
+    if (CONFIG_ENABLE_SDM &&
+        output_register(sdm_output_driver(), CONFIG_OUTPUT_SDM_BASE_CHANNEL) != 0) {
+        ESP_LOGW(TAG, "Sigma-delta outputs unavailable");
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Queue a frame for the output task (producer side of the ring)
+ */
+static int output_queue_frame(const uint16_t *duty, uint32_t count, int64_t now_us)
+{
+    output_frame_t frame;
+
+    if (count > CONFIG_OUTPUT_FRAME_CHANNELS) {
+        ESP_LOGE(TAG, "Frame of %lu channels exceeds %d", count, CONFIG_OUTPUT_FRAME_CHANNELS);
+        return -1;
+    }
+
+    frame.staged_us = now_us;
+    frame.count = count;
+    memcpy(frame.duty, duty, count * sizeof(uint16_t));
+
+    if (spsc_ring_push(&frame_ring, &frame) != 0) {
+        portENTER_CRITICAL(&producer_spinlock);
+        producer_stats.overflows++;
+        portEXIT_CRITICAL(&producer_spinlock);
+        return -1;
+    }
+
+    xTaskNotifyGive(output_task_handle);
+
+    // Report the previous frame's failure; the caller restages on the next commit
+    return __atomic_load_n(&stage_failed, __ATOMIC_ACQUIRE) ? -1 : 0;
+}
+
+/**
+ * @brief Stage a frame of 16-bit logical channel duties on all outputs
+ *
+ * Immediate outputs are written before returning, or as soon as the output
+ * task runs with CONFIG_ENABLE_OUTPUT_TASK; the others are committed at
+ * their native rate. Callers must be serialized (pwm_controller mutex).
+ *
+ * @return 0 on success, -1 if any output failed to stage or commit, or the
+ *         frame could not be queued
+ */
+int output_stage_frame(const uint16_t *duty, uint32_t count)
+{
+    int64_t now_us = esp_timer_get_time();
+    int result;
+
+    if (CONFIG_ENABLE_OUTPUT_TASK) {
+        result = output_queue_frame(duty, count, now_us);
+    } else {
+        xSemaphoreTake(output_mutex, portMAX_DELAY);
+
+        int64_t locked_us = esp_timer_get_time();
+        int64_t next_us;
+        result = output_scheduler_stage(&scheduler, duty, count, locked_us, &next_us);
+        output_arm_timer(next_us, locked_us);
+
+        xSemaphoreGive(output_mutex);
+    }
+
+    // Time the producer was held up, the cost of staging on the input core
+    uint32_t stage_us = (uint32_t)(esp_timer_get_time() - now_us);
+    portENTER_CRITICAL(&producer_spinlock);
+    if (stage_us > producer_stats.max_stage_us) {
+        producer_stats.max_stage_us = stage_us;
+    }
+    producer_stats.frames++;
+    portEXIT_CRITICAL(&producer_spinlock);
+
+    return result;
+}
+
+/**
+ * @brief Set the function output_request_effects() runs
+ *
+ * Set once at init, before the first request.
+ */
+void output_set_effects_hook(output_effects_fn_t fn)
+{
+    effects_hook = fn;
+}
+
+/**
+ * @brief Run the effects hook on the output core
+ *
+ * Wakes the output task, which runs the hook on its next pass; requests
+ * made before it gets there collapse into one run. Without
+ * CONFIG_ENABLE_OUTPUT_TASK the hook runs in the caller.
+ */
+void output_request_effects(void)
+{
+    if (!CONFIG_ENABLE_OUTPUT_TASK) {
+        if (effects_hook != NULL) {
+            effects_hook();
+        }
+        return;
+    }
+
+    __atomic_store_n(&effects_due, true, __ATOMIC_RELEASE);
+    xTaskNotifyGive(output_task_handle);
+}
+
+/**
+ * @brief Number of registered outputs
+ */
+uint32_t output_count(void)
+{
+    return scheduler.count;
+}
+
+/**
+ * @brief Get name, capabilities and counters of one output
+ */
+int output_get_info(uint32_t index, output_info_t *info)
+{
+    if (info == NULL || index >= scheduler.count) {
+        ESP_LOGE(TAG, "Invalid output %lu", index);
+        return -1;
+    }
+
+    xSemaphoreTake(output_mutex, portMAX_DELAY);
+    info->name = scheduler.slots[index].driver->name;
+    info->caps = scheduler.slots[index].caps;
+    info->stats = scheduler.slots[index].stats;
+    xSemaphoreGive(output_mutex);
+
+    return 0;
+}
+
+/**
+ * @brief Get frame handoff counters (producer blocking time, queueing delay)
+ */
+int output_get_handoff_stats(output_handoff_stats_t *stats)
+{
+    if (stats == NULL) {
+        return -1;
+    }
+
+    portENTER_CRITICAL(&producer_spinlock);
+    stats->frames = producer_stats.frames;
+    stats->overflows = producer_stats.overflows;
+    stats->max_stage_us = producer_stats.max_stage_us;
+    portEXIT_CRITICAL(&producer_spinlock);
+
+    xSemaphoreTake(output_mutex, portMAX_DELAY);
+    stats->coalesced = consumer_stats.coalesced;
+    stats->max_handoff_us = consumer_stats.max_handoff_us;
+    xSemaphoreGive(output_mutex);
+
+    return 0;
+}
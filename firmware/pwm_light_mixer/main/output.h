@@ -0,0 +1,39 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "output_scheduler.h"
+
+typedef struct {
+    const char *name;
+    output_caps_t caps;
+    output_slot_stats_t stats;
+} output_info_t;
+
+typedef struct {
+    uint32_t frames;                ///< Frames staged by pwm_controller
+    uint32_t coalesced;             ///< Queued frames replaced by a newer one
+    uint32_t overflows;             ///< Frames rejected because the ring was full
+    uint32_t max_stage_us;          ///< Worst time a caller spent in output_stage_frame
+    uint32_t max_handoff_us;        ///< Worst delay from queueing to the output task
+} output_handoff_stats_t;
+
+/** Composes and stages a frame from time-driven state (pwm_controller ramp) */
+typedef void (*output_effects_fn_t)(void);
+
+int output_init(void);
+
+int output_stage_frame(const uint16_t *duty, uint32_t count);
+
+uint32_t output_count(void);
+
+int output_get_info(uint32_t index, output_info_t *info);
+
+int output_get_handoff_stats(output_handoff_stats_t *stats);
+
+void output_set_effects_hook(output_effects_fn_t fn);
+
+void output_request_effects(void);
+
+#endif
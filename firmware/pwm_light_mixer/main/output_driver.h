@@ -0,0 +1,36 @@
+#ifndef OUTPUT_DRIVER_H
+#define OUTPUT_DRIVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define OUTPUT_DUTY_MAX               65535u             ///< Full scale of a staged duty
+#define OUTPUT_COMMIT_PENDING         1                  ///< commit(): frame not (fully) sent yet
+
+typedef struct {
+    uint32_t channel_count;         ///< Channels the output can drive
+    uint32_t resolution_bits;       ///< Native duty resolution
+    uint32_t max_refresh_hz;        ///< Native frame rate; 0 = commit immediately
+} output_caps_t;
+
+/**
+ * @brief Output driver interface
+ *
+ * Duties are staged as 16-bit values (0..OUTPUT_DUTY_MAX) and mapped to the
+ * native resolution by each driver. stage() only records channels
+ * 0..count-1 (count may be below channel_count; the rest keep their value),
+ * commit() pushes the staged frame to the hardware and must not block on
+ * the bus. It returns 0 once the whole frame is on its way,
+ * OUTPUT_COMMIT_PENDING if the bus was busy or part of the frame is left
+ * over (the scheduler retries after one period), or -1 on an error.
+ */
+typedef struct {
+    const char *name;
+    int (*init)(void *ctx);
+    void (*get_caps)(void *ctx, output_caps_t *caps);
+    int (*stage)(void *ctx, const uint16_t *duty, uint32_t count);
+    int (*commit)(void *ctx);
+    void *ctx;
+} output_driver_t;
+
+#endif
@@ -0,0 +1,500 @@
+/**
+ * @file output_ledc.c
+ * @brief LEDC output driver
+ *
+ * Owns the LEDC timers and the two on-board LED channels. Channels belong
+ * to groups with their own frequency and minimum resolution
+ * (CONFIG_LEDC_GROUP_*); ledc_alloc places the groups on timers and speed
+ * modes at init, at the highest resolution each frequency allows, and an
+ * infeasible configuration fails init with the reason per group.
+ *
+ * Where a group's frequency leaves fewer timer bits than
+ * CONFIG_LEDC_TARGET_BITS (the camera-safe profile at 25 kHz gets 11),
+ * pwm_plan tops the resolution up with the LEDC's 4 fractional duty bits,
+ * which the hardware dithers across PWM periods with no CPU involvement.
+ *
+ * With CONFIG_ENABLE_SPREAD_SPECTRUM, a periodic esp_timer sweeps every
+ * timer across its group frequency +/- CONFIG_LEDC_SPREAD_PERMILLE. Timer
+ * resolution is allocated for the top of the band and ledc_set_freq()
+ * changes only the clock divider, so the counter range and with it every
+ * duty ratio stay exact through each retune; nothing needs rewriting.
+ *
+ * Frames are mapped from 16-bit duties to each channel's effective
+ * resolution when staged, and commit writes only the channels whose duty
+ * changed (or whose last write failed). LEDC latches new duties at the next
+ * PWM period by itself, so the driver reports an immediate refresh rate.
+ *
+ * output_ledc_fast_write() is an IRAM path for effects running in ISRs: it
+ * writes the duty and update bits through the LL layer with no locks and
+ * no argument checks, for a channel validated once by output_ledc_fast_get().
+ * A fast write holds until the next frame commit touches the channel.
+ *
+ * The fast path is exported API only; in this tree just the boot benchmark
+ * calls it. The ramp effect needs the power budget, energy metering and the
+ * non-LEDC outputs, so it composes a whole frame in pwm_controller instead.
+ */
+
+#include "output_ledc.h"
+#include "ledc_alloc.h"
+#include "pwm_plan.h"
+#include "spread_spectrum.h"
+#include "config.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "hal/ledc_ll.h"
+#include "soc/ledc_struct.h"
+
+static const char *TAG = "OUT_LEDC";
+
+#define OUTPUT_LEDC_CHANNEL_COUNT     2
+#define OUTPUT_LEDC_FRACTION_BITS     4                  ///< Fractional bits in the duty register
+#define OUTPUT_LEDC_BENCHMARK_WRITES  64
+
+typedef struct {
+    gpio_num_t gpio;
+    uint32_t group;
+    output_ledc_timing_t timing;    ///< Assigned at init
+    uint32_t dither_bits;           ///< Fractional bits below the timer resolution
+    uint32_t duty_max;              ///< Full scale at the effective resolution
+    uint32_t staged;                ///< Native duty staged for the next commit
+    uint32_t written;               ///< Native duty last written
+    bool valid;                     ///< written matches the hardware
+} output_ledc_channel_t;
+
+static output_ledc_channel_t channels[OUTPUT_LEDC_CHANNEL_COUNT] = {
+    { .gpio = CONFIG_LED_PIN_1, .group = CONFIG_LEDC_CH1_GROUP },
+    { .gpio = CONFIG_LED_PIN_2, .group = CONFIG_LEDC_CH2_GROUP },
+};
+
+static const uint32_t GROUP_FREQUENCIES[] = CONFIG_LEDC_GROUP_FREQUENCIES;
+static const uint32_t GROUP_MIN_BITS[] = CONFIG_LEDC_GROUP_MIN_BITS;
+
+#define OUTPUT_LEDC_GROUP_COUNT       (sizeof(GROUP_FREQUENCIES) / sizeof(GROUP_FREQUENCIES[0]))
+
+_Static_assert(sizeof(GROUP_FREQUENCIES) / sizeof(GROUP_FREQUENCIES[0]) <= LEDC_ALLOC_MAX_GROUPS,
+               "Too many LEDC groups");
+_Static_assert(sizeof(GROUP_FREQUENCIES) == sizeof(GROUP_MIN_BITS),
+               "One minimum resolution per LEDC group");
+
+static ledc_alloc_request_t groups[OUTPUT_LEDC_GROUP_COUNT];
+static uint32_t group_dither_bits[OUTPUT_LEDC_GROUP_COUNT];
+
+/** ESP32 LEDC clock sources, in the order ledc_alloc prefers on a tie */
+static const ledc_alloc_clock_t CLOCKS[] = {
+    { "APB",      80000000, 0x3 },
+    { "RC_FAST",  8000000,  0x2 },
+    { "REF_TICK", 1000000,  0x3 },
+};
+
+static const ledc_clk_cfg_t CLOCK_CFG[] = {
+    LEDC_USE_APB_CLK,
+    LEDC_USE_RC_FAST_CLK,
+    LEDC_USE_REF_TICK,
+};
+
+static const ledc_mode_t MODES[LEDC_ALLOC_MODES] = {
+    LEDC_HIGH_SPEED_MODE,
+    LEDC_LOW_SPEED_MODE,
+};
+
+static uint32_t output_ledc_min_bits = LEDC_ALLOC_MAX_BITS;
+
+typedef struct {
+    ledc_mode_t speed_mode;
+    ledc_timer_t timer;
+    spread_spectrum_t sweep;
+} output_ledc_spread_t;
+
+static output_ledc_spread_t spreads[LEDC_ALLOC_MAX_GROUPS];
+static uint32_t spread_count = 0;
+static esp_timer_handle_t spread_timer = NULL;
+
+static int output_ledc_write_channel(const output_ledc_timing_t *timing, uint32_t duty,
+                                     uint32_t dither_bits);
+static void output_ledc_fast_benchmark(void);
+
+/**
+ * @brief Place the channel groups on timers and configure them
+ */
+static int output_ledc_configure_timers(ledc_alloc_group_t *placement)
+{
+    // Spread groups need their resolution at the top of the band
+    for (uint32_t g = 0; g < OUTPUT_LEDC_GROUP_COUNT; g++) {
+        groups[g].freq_hz = CONFIG_ENABLE_SPREAD_SPECTRUM ?
+                            spread_spectrum_max_hz(GROUP_FREQUENCIES[g],
+                                                   CONFIG_LEDC_SPREAD_PERMILLE) :
+                            GROUP_FREQUENCIES[g];
+        groups[g].min_bits = GROUP_MIN_BITS[g];
+        groups[g].channels = 0;
+    }
+    for (uint32_t i = 0; i < OUTPUT_LEDC_CHANNEL_COUNT; i++) {
+        if (channels[i].group >= OUTPUT_LEDC_GROUP_COUNT) {
+            ESP_LOGE(TAG, "LED %lu in undefined group %lu", i + 1, channels[i].group);
+            return -1;
+        }
+        groups[channels[i].group].channels++;
+    }
+
+    int result = ledc_alloc_plan(CLOCKS, sizeof(CLOCKS) / sizeof(CLOCKS[0]),
+                                 groups, OUTPUT_LEDC_GROUP_COUNT, placement);
+
+    for (uint32_t g = 0; g < OUTPUT_LEDC_GROUP_COUNT; g++) {
+        if (placement[g].status != LEDC_ALLOC_OK) {
+            ESP_LOGE(TAG, "Group %lu (%lu Hz, >= %lu bit): %s", g, groups[g].freq_hz,
+                     groups[g].min_bits, ledc_alloc_status_name(placement[g].status));
+            continue;
+        }
+
+        // Dither rate and camera safety are judged at the bottom of a spread band
+        uint32_t low_hz = CONFIG_ENABLE_SPREAD_SPECTRUM ?
+                          spread_spectrum_min_hz(GROUP_FREQUENCIES[g],
+                                                 CONFIG_LEDC_SPREAD_PERMILLE) :
+                          placement[g].actual_hz;
+        group_dither_bits[g] = pwm_plan_dither_bits(low_hz, placement[g].bits,
+                                                    CONFIG_LEDC_TARGET_BITS,
+                                                    CONFIG_LEDC_MIN_DITHER_HZ);
+
+        ESP_LOGI(TAG, "  Group %lu: %lu Hz, %lu-bit +%lu dithered on %s timer %lu (%s)", g,
+                 placement[g].actual_hz, placement[g].bits, group_dither_bits[g],
+                 (placement[g].mode == 0) ? "high speed" : "low speed",
+                 placement[g].timer, CLOCKS[placement[g].clock].name);
+
+        if (CONFIG_PWM_PROFILE == CONFIG_PWM_PROFILE_CAMERA_SAFE &&
+            low_hz < PWM_PLAN_CAMERA_SAFE_HZ) {
+            ESP_LOGW(TAG, "  Group %lu below %d Hz, may band on camera", g,
+                     PWM_PLAN_CAMERA_SAFE_HZ);
+        }
+    }
+
+    if (result != 0) {
+        return -1;
+    }
+
+    // Groups sharing a timer appear once per group; configuring twice is harmless
+    for (uint32_t g = 0; g < OUTPUT_LEDC_GROUP_COUNT; g++) {
+        if (groups[g].channels == 0) {
+            continue;
+        }
+
+        ledc_timer_config_t timer_config = {
+            .speed_mode = MODES[placement[g].mode],
+            .timer_num = (ledc_timer_t)placement[g].timer,
+            .duty_resolution = (ledc_timer_bit_t)placement[g].bits,
+            .freq_hz = GROUP_FREQUENCIES[g],
+            .clk_cfg = CLOCK_CFG[placement[g].clock]
+        };
+
+        if (ledc_timer_config(&timer_config) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to configure LEDC timer for group %lu", g);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Retune every spread timer to its next frequency (esp_timer task)
+ *
+ * One table lookup and one ledc_set_freq() per timer, at most
+ * LEDC_ALLOC_MAX_GROUPS per call.
+ */
+static void output_ledc_spread_callback(void *arg)
+{
+    for (uint32_t i = 0; i < spread_count; i++) {
+        ledc_set_freq(spreads[i].speed_mode, spreads[i].timer,
+                      spread_spectrum_next(&spreads[i].sweep));
+    }
+}
+
+/**
+ * @brief Build a sweep for each timer in use and start retuning
+ */
+static int output_ledc_spread_start(const ledc_alloc_group_t *placement)
+{
+    for (uint32_t g = 0; g < OUTPUT_LEDC_GROUP_COUNT; g++) {
+        if (groups[g].channels == 0) {
+            continue;
+        }
+
+        // Groups at the same frequency share a timer; sweep it once
+        bool shared = false;
+        for (uint32_t i = 0; i < spread_count; i++) {
+            if (spreads[i].speed_mode == MODES[placement[g].mode] &&
+                spreads[i].timer == (ledc_timer_t)placement[g].timer) {
+                shared = true;
+            }
+        }
+        if (shared) {
+            continue;
+        }
+
+        output_ledc_spread_t *spread = &spreads[spread_count];
+        spread->speed_mode = MODES[placement[g].mode];
+        spread->timer = (ledc_timer_t)placement[g].timer;
+        if (spread_spectrum_init(&spread->sweep, GROUP_FREQUENCIES[g],
+                                 CONFIG_LEDC_SPREAD_PERMILLE, CONFIG_LEDC_SPREAD_STEPS) != 0) {
+            ESP_LOGE(TAG, "Invalid spread band for group %lu", g);
+            return -1;
+        }
+        spread_count++;
+
+        ESP_LOGI(TAG, "  Group %lu spread: %lu..%lu Hz in %d steps of %d us", g,
+                 spread->sweep.freq_hz[0], spread->sweep.freq_hz[spread->sweep.steps - 1],
+                 CONFIG_LEDC_SPREAD_STEPS, CONFIG_LEDC_SPREAD_RETUNE_US);
+    }
+
+    const esp_timer_create_args_t spread_timer_args = {
+        .callback = output_ledc_spread_callback,
+        .name = "ledc_spread"
+    };
+    if (esp_timer_create(&spread_timer_args, &spread_timer) != ESP_OK ||
+        esp_timer_start_periodic(spread_timer, CONFIG_LEDC_SPREAD_RETUNE_US) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start spread timer");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Allocate timers and configure the channels, all at the minimum duty
+ */
+static int output_ledc_init(void *ctx)
+{
+    ledc_alloc_group_t placement[LEDC_ALLOC_MAX_GROUPS];
+    uint32_t next_channel[LEDC_ALLOC_MAX_GROUPS] = {0};
+
+    if (output_ledc_configure_timers(placement) != 0) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < OUTPUT_LEDC_CHANNEL_COUNT; i++) {
+        const ledc_alloc_group_t *group = &placement[channels[i].group];
+        output_ledc_timing_t *timing = &channels[i].timing;
+
+        timing->speed_mode = MODES[group->mode];
+        timing->timer = (ledc_timer_t)group->timer;
+        timing->channel = (ledc_channel_t)(group->first_channel + next_channel[channels[i].group]++);
+        timing->freq_hz = CONFIG_ENABLE_SPREAD_SPECTRUM ? GROUP_FREQUENCIES[channels[i].group] :
+                          group->actual_hz;
+        timing->resolution_bits = group->bits;
+        channels[i].dither_bits = group_dither_bits[channels[i].group];
+        channels[i].duty_max = ((1u << group->bits) - 1) << channels[i].dither_bits;
+
+        if (group->bits + channels[i].dither_bits < output_ledc_min_bits) {
+            output_ledc_min_bits = group->bits + channels[i].dither_bits;
+        }
+
+        uint32_t duty = (CONFIG_PWM_MIN_DUTY * ((1u << group->bits) - 1)) / CONFIG_PWM_MAX_DUTY;
+        ledc_channel_config_t channel_config = {
+            .speed_mode = timing->speed_mode,
+            .channel = timing->channel,
+            .timer_sel = timing->timer,
+            .intr_type = LEDC_INTR_DISABLE,
+            .gpio_num = channels[i].gpio,
+            .duty = duty,
+            .hpoint = 0
+        };
+
+        if (ledc_channel_config(&channel_config) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to configure LED %lu channel", i + 1);
+            return -1;
+        }
+
+        channels[i].staged = duty << channels[i].dither_bits;
+        channels[i].written = channels[i].staged;
+        channels[i].valid = true;
+    }
+
+    if (CONFIG_ENABLE_SPREAD_SPECTRUM && output_ledc_spread_start(placement) != 0) {
+        return -1;
+    }
+
+    if (CONFIG_LEDC_FAST_BENCHMARK) {
+        output_ledc_fast_benchmark();
+    }
+
+    ESP_LOGI(TAG, "  Pins: LED1=%d, LED2=%d", CONFIG_LED_PIN_1, CONFIG_LED_PIN_2);
+    return 0;
+}
+
+static void output_ledc_get_caps(void *ctx, output_caps_t *caps)
+{
+    caps->channel_count = OUTPUT_LEDC_CHANNEL_COUNT;
+    caps->resolution_bits = output_ledc_min_bits;
+    caps->max_refresh_hz = 0;
+}
+
+static int output_ledc_stage(void *ctx, const uint16_t *duty, uint32_t count)
+{
+    for (uint32_t i = 0; i < count && i < OUTPUT_LEDC_CHANNEL_COUNT; i++) {
+        channels[i].staged = (uint32_t)(((uint64_t)duty[i] * channels[i].duty_max +
+                                         OUTPUT_DUTY_MAX / 2) / OUTPUT_DUTY_MAX);
+    }
+    return 0;
+}
+
+/**
+ * @brief Write a duty value to one LEDC channel
+ *
+ * The low dither_bits of duty are the fraction: ledc_set_duty() writes the
+ * integer part and sets up the update, and the fraction is then placed in
+ * the low bits of the duty register before the update latches it.
+ */
+static int output_ledc_write_channel(const output_ledc_timing_t *timing, uint32_t duty,
+                                     uint32_t dither_bits)
+{
+    if (ledc_set_duty(timing->speed_mode, timing->channel, duty >> dither_bits) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set duty on channel %d", timing->channel);
+        return -1;
+    }
+
+    if (dither_bits > 0) {
+        LEDC.channel_group[timing->speed_mode].channel[timing->channel].duty.duty =
+            duty << (OUTPUT_LEDC_FRACTION_BITS - dither_bits);
+    }
+
+    if (ledc_update_duty(timing->speed_mode, timing->channel) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to update duty on channel %d", timing->channel);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int output_ledc_commit(void *ctx)
+{
+    int result = 0;
+
+    for (uint32_t i = 0; i < OUTPUT_LEDC_CHANNEL_COUNT; i++) {
+        if (channels[i].valid && channels[i].staged == channels[i].written) {
+            continue;
+        }
+
+        channels[i].written = channels[i].staged;
+        channels[i].valid = (output_ledc_write_channel(&channels[i].timing, channels[i].staged,
+                                                       channels[i].dither_bits) == 0);
+        if (!channels[i].valid) {
+            result = -1;
+        }
+    }
+
+    return result;
+}
+
+static const output_driver_t ledc_driver = {
+    .name = "ledc",
+    .init = output_ledc_init,
+    .get_caps = output_ledc_get_caps,
+    .stage = output_ledc_stage,
+    .commit = output_ledc_commit,
+    .ctx = NULL,
+};
+
+/**
+ * @brief LEDC driver instance for output registration
+ */
+const output_driver_t *output_ledc_driver(void)
+{
+    return &ledc_driver;
+}
+
+/**
+ * @brief Timer, channel and frequency assigned to one LED channel
+ *
+ * Valid after output_init().
+ */
+int output_ledc_get_timing(uint32_t channel, output_ledc_timing_t *timing)
+{
+    if (channel >= OUTPUT_LEDC_CHANNEL_COUNT || timing == NULL) {
+        ESP_LOGE(TAG, "Invalid channel or timing pointer");
+        return -1;
+    }
+
+    *timing = channels[channel].timing;
+    return 0;
+}
+
+/**
+ * ============================================================================
+ * FAST PATH
+ * ============================================================================
+ */
+
+/**
+ * @brief Validate a channel once for output_ledc_fast_write()
+ *
+ * Valid after output_init().
+ */
+int output_ledc_fast_get(uint32_t channel, output_ledc_fast_t *fast)
+{
+    if (channel >= OUTPUT_LEDC_CHANNEL_COUNT || fast == NULL) {
+        ESP_LOGE(TAG, "Invalid channel or fast path pointer");
+        return -1;
+    }
+
+    fast->speed_mode = channels[channel].timing.speed_mode;
+    fast->channel = channels[channel].timing.channel;
+    fast->index = channel;
+    fast->duty_max = channels[channel].duty_max;
+    fast->shift = OUTPUT_LEDC_FRACTION_BITS - channels[channel].dither_bits;
+    return 0;
+}
+
+/**
+ * @brief Write a duty (0..fast->duty_max) straight to the LEDC registers
+ *
+ * ISR safe. Performs the same register sequence as ledc_set_duty() and
+ * ledc_update_duty() for a non-fading duty; the new duty latches at the
+ * next PWM period.
+ */
+void IRAM_ATTR output_ledc_fast_write(const output_ledc_fast_t *fast, uint32_t duty)
+{
+    if (duty > fast->duty_max) {
+        duty = fast->duty_max;
+    }
+
+    LEDC.channel_group[fast->speed_mode].channel[fast->channel].duty.duty = duty << fast->shift;
+    ledc_ll_set_duty_direction(&LEDC, fast->speed_mode, fast->channel, LEDC_DUTY_DIR_INCREASE);
+    ledc_ll_set_duty_num(&LEDC, fast->speed_mode, fast->channel, 1);
+    ledc_ll_set_duty_cycle(&LEDC, fast->speed_mode, fast->channel, 1);
+    ledc_ll_set_duty_scale(&LEDC, fast->speed_mode, fast->channel, 0);
+    ledc_ll_set_sig_out_en(&LEDC, fast->speed_mode, fast->channel, true);
+    ledc_ll_set_duty_start(&LEDC, fast->speed_mode, fast->channel, true);
+    ledc_ll_ls_channel_update(&LEDC, fast->speed_mode, fast->channel);
+
+    // Hardware no longer holds the frame duty; the next commit restores it
+    channels[fast->index].valid = false;
+}
+
+/**
+ * @brief Log CPU cycles per duty update, driver API against the fast path
+ *
+ * Rewrites LED 1's current duty, so the output does not change.
+ */
+static void output_ledc_fast_benchmark(void)
+{
+    output_ledc_fast_t fast;
+    output_ledc_fast_get(0, &fast);
+    uint32_t duty = channels[0].written;
+
+    esp_cpu_cycle_count_t start = esp_cpu_get_cycle_count();
+    for (uint32_t i = 0; i < OUTPUT_LEDC_BENCHMARK_WRITES; i++) {
+        output_ledc_write_channel(&channels[0].timing, duty, channels[0].dither_bits);
+    }
+    uint32_t driver_cycles = (esp_cpu_get_cycle_count() - start) / OUTPUT_LEDC_BENCHMARK_WRITES;
+
+    start = esp_cpu_get_cycle_count();
+    for (uint32_t i = 0; i < OUTPUT_LEDC_BENCHMARK_WRITES; i++) {
+        output_ledc_fast_write(&fast, duty);
+    }
+    uint32_t fast_cycles = (esp_cpu_get_cycle_count() - start) / OUTPUT_LEDC_BENCHMARK_WRITES;
+    channels[0].valid = true;
+
+    ESP_LOGI(TAG, "  Duty update: driver %lu cycles, fast path %lu cycles (%lu saved)",
+             driver_cycles, fast_cycles,
+             (driver_cycles > fast_cycles) ? driver_cycles - fast_cycles : 0);
+}
@@ -0,0 +1,35 @@
+#ifndef OUTPUT_LEDC_H
+#define OUTPUT_LEDC_H
+
+#include <stdint.h>
+#include "driver/ledc.h"
+#include "output_driver.h"
+
+typedef struct {
+    ledc_mode_t speed_mode;
+    ledc_timer_t timer;
+    ledc_channel_t channel;
+    uint32_t freq_hz;               ///< Actual PWM frequency (band center if spread)
+    uint32_t resolution_bits;
+} output_ledc_timing_t;
+
+/**
+ * Pre-validated channel for output_ledc_fast_write(); the struct must live
+ * in DRAM when used from an ISR.
+ */
+typedef struct {
+    ledc_mode_t speed_mode;
+    ledc_channel_t channel;
+    uint32_t index;                 ///< LED channel
+    uint32_t duty_max;              ///< Full scale at the effective resolution
+    uint32_t shift;                 ///< Duty position in the duty register
+} output_ledc_fast_t;
+
+const output_driver_t *output_ledc_driver(void);
+
+int output_ledc_get_timing(uint32_t channel, output_ledc_timing_t *timing);
+
+int output_ledc_fast_get(uint32_t channel, output_ledc_fast_t *fast);
+void output_ledc_fast_write(const output_ledc_fast_t *fast, uint32_t duty);
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * @file output_recording.c
+ * @brief Recording output driver
+ *
+ * Implements the output driver interface without hardware: each commit
+ * stores the staged duties with a timestamp from a caller-supplied clock
+ * in a ring of the newest OUTPUT_RECORDING_DEPTH frames. Any capabilities
+ * can be declared, so host tools can stand in for LEDC, the I2C expander
+ * or a pixel strip and check what the scheduler delivers and when.
+ *
+ * Duties are recorded as staged (16-bit); channels beyond
+ * OUTPUT_RECORDING_CHANNELS are accepted and ignored. A listener can be
+ * attached to see every commit, for tools that need more history than
+ * the ring holds.
+ *
+ * A deferring mode makes every Nth commit return OUTPUT_COMMIT_PENDING
+ * without recording anything, the way the PCA9685 and WS2812 backends
+ * answer while their bus is still busy.
+ */
+
+#include "output_recording.h"
+#include <string.h>
+
+static void output_recording_get_caps(void *ctx, output_caps_t *caps)
+{
+    const output_recording_t *recording = ctx;
+    *caps = recording->caps;
+}
+
+static int output_recording_stage(void *ctx, const uint16_t *duty, uint32_t count)
+{
+    output_recording_t *recording = ctx;
+
+    for (uint32_t i = 0; i < count && i < OUTPUT_RECORDING_CHANNELS; i++) {
+        recording->staged[i] = duty[i];
+    }
+    return 0;
+}
+
+static int output_recording_commit(void *ctx)
+{
+    output_recording_t *recording = ctx;
+
+    if (recording->defer_every > 0 && ++recording->attempts % recording->defer_every == 0) {
+        return OUTPUT_COMMIT_PENDING;
+    }
+
+    const output_record_t *previous = output_recording_get(recording, 0);
+    output_record_t *record = &recording->records[recording->commits % OUTPUT_RECORDING_DEPTH];
+
+    if (previous == NULL ||
+        memcmp(previous->duty, recording->staged, sizeof(recording->staged)) != 0) {
+        recording->changes++;
+    }
+
+    record->time_us = recording->clock(recording->clock_arg);
+    memcpy(record->duty, recording->staged, sizeof(record->duty));
+    recording->commits++;
+
+    if (recording->listener != NULL) {
+        recording->listener(recording->listener_arg, record);
+    }
+    return 0;
+}
+
+/**
+ * @brief Set up a recording driver with the given capabilities
+ *
+ * Register &recording->driver with the scheduler.
+ */
+void output_recording_init(output_recording_t *recording, const char *name,
+                           const output_caps_t *caps, output_recording_clock_t clock,
+                           void *clock_arg)
+{
+    memset(recording, 0, sizeof(*recording));
+    recording->caps = *caps;
+    recording->clock = clock;
+    recording->clock_arg = clock_arg;
+
+    recording->driver.name = name;
+    recording->driver.init = NULL;
+    recording->driver.get_caps = output_recording_get_caps;
+    recording->driver.stage = output_recording_stage;
+    recording->driver.commit = output_recording_commit;
+    recording->driver.ctx = recording;
+}
+
+/**
+ * @brief Call a function with each frame as it is committed
+ */
+void output_recording_set_listener(output_recording_t *recording,
+                                   output_recording_listener_t listener, void *arg)
+{
+    recording->listener = listener;
+    recording->listener_arg = arg;
+}
+
+/**
+ * @brief Report every Nth commit as still pending (0 to commit every time)
+ */
+void output_recording_set_defer(output_recording_t *recording, uint32_t every)
+{
+    recording->defer_every = every;
+    recording->attempts = 0;
+}
+
+/**
+ * @brief Get a recorded frame by age
+ *
+ * @param age 0 for the newest commit, 1 for the one before, ...
+ * @return Frame, or NULL if it is older than the ring or never happened
+ */
+const output_record_t *output_recording_get(const output_recording_t *recording, uint32_t age)
+{
+    if (age >= recording->commits || age >= OUTPUT_RECORDING_DEPTH) {
+        return NULL;
+    }
+    return &recording->records[(recording->commits - 1 - age) % OUTPUT_RECORDING_DEPTH];
+}
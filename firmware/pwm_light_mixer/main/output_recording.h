@@ -0,0 +1,46 @@
+#ifndef OUTPUT_RECORDING_H
+#define OUTPUT_RECORDING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "output_driver.h"
+
+#define OUTPUT_RECORDING_CHANNELS     8                  ///< Channels captured per frame
+#define OUTPUT_RECORDING_DEPTH        64                 ///< Frames kept in the ring
+
+typedef int64_t (*output_recording_clock_t)(void *arg);
+
+typedef struct {
+    int64_t time_us;                ///< Clock at commit
+    uint16_t duty[OUTPUT_RECORDING_CHANNELS];
+} output_record_t;
+
+typedef void (*output_recording_listener_t)(void *arg, const output_record_t *record);
+
+typedef struct {
+    output_driver_t driver;         ///< Interface to register; ctx points back here
+    output_caps_t caps;
+    output_recording_clock_t clock;
+    void *clock_arg;
+    output_recording_listener_t listener;   ///< Optional, sees every commit
+    void *listener_arg;
+    uint32_t defer_every;           ///< Every Nth commit reports a busy bus (0 = never)
+    uint32_t attempts;              ///< Commit calls, including deferred ones
+    uint16_t staged[OUTPUT_RECORDING_CHANNELS];
+    output_record_t records[OUTPUT_RECORDING_DEPTH];
+    uint32_t commits;               ///< Total frames committed (ring holds the newest)
+    uint32_t changes;               ///< Commits whose duties differ from the previous one
+} output_recording_t;
+
+void output_recording_init(output_recording_t *recording, const char *name,
+                           const output_caps_t *caps, output_recording_clock_t clock,
+                           void *clock_arg);
+
+void output_recording_set_listener(output_recording_t *recording,
+                                   output_recording_listener_t listener, void *arg);
+
+void output_recording_set_defer(output_recording_t *recording, uint32_t every);
+
+const output_record_t *output_recording_get(const output_recording_t *recording, uint32_t age);
+
+#endif
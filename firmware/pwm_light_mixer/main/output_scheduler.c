@@ -0,0 +1,170 @@
+/**
+ * @file output_scheduler.c
+ * @brief Frame scheduler driving every output at its native rate
+ *
+ * A frame of logical channel duties is staged into all registered outputs
+ * at once. Each output is then committed as soon as its own minimum frame
+ * period (from its max_refresh_hz capability) has elapsed since its last
+ * commit: immediate outputs such as LEDC commit in the same call, while
+ * bus-bound outputs (I2C expanders, pixel strips) commit at most at their
+ * native rate and always send the newest staged frame. A driver that
+ * cannot send the whole frame yet reports it as still pending; the slot
+ * stays pending and is retried one period later.
+ *
+ * Pure logic with caller-supplied microsecond timestamps. Stage and
+ * service report the next time a commit is due, so the caller can arm a
+ * one-shot timer instead of polling.
+ */
+
+#include "output_scheduler.h"
+#include <string.h>
+
+/**
+ * @brief Initialize an empty scheduler
+ */
+void output_scheduler_init(output_scheduler_t *scheduler)
+{
+    memset(scheduler, 0, sizeof(*scheduler));
+}
+
+/**
+ * @brief Initialize an output and add it to the schedule
+ *
+ * @param base_channel Logical channel mapped to the output's channel 0
+ * @return Slot index, or -1 if the table is full or init fails
+ */
+int output_scheduler_register(output_scheduler_t *scheduler, const output_driver_t *driver,
+                              uint32_t base_channel)
+{
+    if (scheduler->count >= OUTPUT_SCHEDULER_MAX_OUTPUTS || driver == NULL) {
+        return -1;
+    }
+
+    if (driver->init != NULL && driver->init(driver->ctx) != 0) {
+        return -1;
+    }
+
+    output_slot_t *slot = &scheduler->slots[scheduler->count];
+    memset(slot, 0, sizeof(*slot));
+    slot->driver = driver;
+    slot->base_channel = base_channel;
+    driver->get_caps(driver->ctx, &slot->caps);
+    slot->period_us = (slot->caps.max_refresh_hz > 0) ? 1000000u / slot->caps.max_refresh_hz : 0;
+    slot->last_commit_us = INT64_MIN / 2;
+
+    return (int)scheduler->count++;
+}
+
+/**
+ * @brief Commit one slot if it has a pending frame and its period elapsed
+ *
+ * @return 0 on success, nothing due or a deferred commit, -1 if the driver
+ *         commit failed
+ */
+static int output_scheduler_service_slot(output_slot_t *slot, int64_t now_us, int64_t *next_us)
+{
+    if (!slot->pending) {
+        return 0;
+    }
+
+    int64_t due_us = slot->last_commit_us + slot->period_us;
+    if (now_us < due_us) {
+        if (due_us < *next_us) {
+            *next_us = due_us;
+        }
+        return 0;
+    }
+
+    int result = slot->driver->commit(slot->driver->ctx);
+    if (result == OUTPUT_COMMIT_PENDING) {
+        // Keep the frame and try again after a period
+        slot->stats.deferred++;
+        slot->last_commit_us = now_us;
+        due_us = now_us + ((slot->period_us > 0) ? slot->period_us : OUTPUT_SCHEDULER_RETRY_US);
+        if (due_us < *next_us) {
+            *next_us = due_us;
+        }
+        return 0;
+    }
+    if (result != 0) {
+        slot->stats.errors++;
+    }
+
+    uint32_t latency_us = (uint32_t)(now_us - slot->staged_us);
+    if (latency_us > slot->stats.max_latency_us) {
+        slot->stats.max_latency_us = latency_us;
+    }
+
+    slot->stats.frames++;
+    slot->pending = false;
+    slot->last_commit_us = now_us;
+    return result;
+}
+
+/**
+ * @brief Stage a frame of logical channel duties into every output
+ *
+ * Each output receives the part of the frame starting at its base channel;
+ * output channels beyond the frame keep whatever was set on them directly.
+ * Outputs without a pending frame that are due are committed right away.
+ *
+ * @param next_us Set to the next due commit, or OUTPUT_SCHEDULER_IDLE
+ * @return 0 on success, -1 if any stage or commit failed
+ */
+int output_scheduler_stage(output_scheduler_t *scheduler, const uint16_t *duty,
+                           uint32_t count, int64_t now_us, int64_t *next_us)
+{
+    int result = 0;
+
+    for (uint32_t i = 0; i < scheduler->count; i++) {
+        output_slot_t *slot = &scheduler->slots[i];
+
+        if (slot->base_channel >= count) {
+            continue;
+        }
+
+        uint32_t width = count - slot->base_channel;
+        if (width > slot->caps.channel_count) {
+            width = slot->caps.channel_count;
+        }
+
+        if (slot->driver->stage(slot->driver->ctx, &duty[slot->base_channel], width) != 0) {
+            slot->stats.errors++;
+            result = -1;
+            continue;
+        }
+
+        if (slot->pending) {
+            slot->stats.skipped++;
+        } else {
+            slot->pending = true;
+            slot->staged_us = now_us;
+        }
+    }
+
+    if (output_scheduler_service(scheduler, now_us, next_us) != 0) {
+        result = -1;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Commit every output whose pending frame is due
+ *
+ * @param next_us Set to the next due commit, or OUTPUT_SCHEDULER_IDLE
+ * @return 0 on success, -1 if any commit failed
+ */
+int output_scheduler_service(output_scheduler_t *scheduler, int64_t now_us, int64_t *next_us)
+{
+    int result = 0;
+
+    *next_us = OUTPUT_SCHEDULER_IDLE;
+    for (uint32_t i = 0; i < scheduler->count; i++) {
+        if (output_scheduler_service_slot(&scheduler->slots[i], now_us, next_us) != 0) {
+            result = -1;
+        }
+    }
+
+    return result;
+}
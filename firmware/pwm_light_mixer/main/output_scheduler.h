@@ -0,0 +1,46 @@
+#ifndef OUTPUT_SCHEDULER_H
+#define OUTPUT_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "output_driver.h"
+
+#define OUTPUT_SCHEDULER_MAX_OUTPUTS  4
+#define OUTPUT_SCHEDULER_IDLE         INT64_MAX          ///< No commit due
+#define OUTPUT_SCHEDULER_RETRY_US     1000               ///< Retry of a deferred immediate output
+
+typedef struct {
+    uint32_t frames;                ///< Frames committed
+    uint32_t skipped;               ///< Staged frames replaced before their commit
+    uint32_t deferred;              ///< Commits the driver left pending (bus busy)
+    uint32_t errors;                ///< Failed stage or commit calls
+    uint32_t max_latency_us;        ///< Worst delay from first stage to commit
+} output_slot_stats_t;
+
+typedef struct {
+    const output_driver_t *driver;
+    output_caps_t caps;
+    uint32_t base_channel;          ///< First logical channel mapped to output channel 0
+    uint32_t period_us;             ///< Minimum time between commits
+    int64_t last_commit_us;
+    int64_t staged_us;              ///< Time the pending frame was first staged
+    bool pending;
+    output_slot_stats_t stats;
+} output_slot_t;
+
+typedef struct {
+    output_slot_t slots[OUTPUT_SCHEDULER_MAX_OUTPUTS];
+    uint32_t count;
+} output_scheduler_t;
+
+void output_scheduler_init(output_scheduler_t *scheduler);
+
+int output_scheduler_register(output_scheduler_t *scheduler, const output_driver_t *driver,
+                              uint32_t base_channel);
+
+int output_scheduler_stage(output_scheduler_t *scheduler, const uint16_t *duty,
+                           uint32_t count, int64_t now_us, int64_t *next_us);
+
+int output_scheduler_service(output_scheduler_t *scheduler, int64_t now_us, int64_t *next_us);
+
+#endif
@@ -0,0 +1,347 @@
+/**
+ * @file pca9685.c
+ * @brief PCA9685 I2C PWM expander output backend
+ *
+ * Drives CONFIG_PCA9685_CHIP_COUNT chips (16 channels each) on one I2C bus
+ * with the same channel-indexed API as pwm_controller. Duties are staged in
+ * a pca9685_frame; pca9685_commit() packs the dirty channels into
+ * auto-increment bursts and queues them as asynchronous I2C transactions,
+ * so the caller never waits for the bus.
+ *
+ * While a frame is still on the bus, further commits only stage values:
+ * the dirty bits accumulate and the next commit after completion sends the
+ * newest duties in one frame, so a slow bus drops intermediate frames
+ * instead of queueing them. Such a commit, or one that leaves dirty
+ * channels beyond CONFIG_PCA9685_QUEUE_DEPTH bursts, reports the frame as
+ * pending so the scheduler commits again.
+ */
+
+#include "pca9685.h"
+#include "pca9685_frame.h"
+#include "config.h"
+#include "driver/i2c_master.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "PCA9685";
+
+/**
+ * ============================================================================
+ * REGISTERS
+ * ============================================================================
+ */
+
+#define PCA9685_REG_MODE1             0x00
+#define PCA9685_REG_MODE2             0x01
+#define PCA9685_REG_PRESCALE          0xFE
+#define PCA9685_MODE1_SLEEP           0x10
+#define PCA9685_MODE1_AI              0x20               ///< Register auto-increment
+#define PCA9685_MODE2_OUTDRV          0x04               ///< Totem-pole outputs
+#define PCA9685_OSC_HZ                25000000
+
+#define PCA9685_CHANNEL_COUNT         (CONFIG_PCA9685_CHIP_COUNT * PCA9685_CHANNELS_PER_CHIP)
+
+_Static_assert(CONFIG_PCA9685_CHIP_COUNT <= PCA9685_MAX_CHIPS, "At most 8 chips per bus");
+
+/**
+ * ============================================================================
+ * STATE
+ * ============================================================================
+ */
+
+static i2c_master_bus_handle_t bus_handle = NULL;
+static i2c_master_dev_handle_t chip_handles[CONFIG_PCA9685_CHIP_COUNT];
+
+static pca9685_frame_t frame;
+static pca9685_burst_t bursts[CONFIG_PCA9685_QUEUE_DEPTH];
+static pca9685_stats_t stats = {0};
+
+// Bursts queued by commit vs. completed in the driver callback; each
+// counter has a single writer, the difference is the number in flight
+static uint32_t bursts_sent = 0;
+static volatile uint32_t bursts_done = 0;
+static volatile bool bus_error = false;
+
+static SemaphoreHandle_t pca9685_mutex = NULL;
+static StaticSemaphore_t pca9685_mutex_buffer;
+
+/**
+ * @brief Transaction complete callback (I2C ISR context)
+ */
+static bool IRAM_ATTR pca9685_trans_done(i2c_master_dev_handle_t dev,
+                                         const i2c_master_event_data_t *event, void *arg)
+{
+    if (event->event != I2C_EVENT_DONE) {
+        bus_error = true;
+    }
+    bursts_done = bursts_done + 1;
+    return false;
+}
+
+/**
+ * @brief Blocking register write, used during init only
+ */
+static int pca9685_write_reg(i2c_master_dev_handle_t dev, uint8_t reg, uint8_t value)
+{
+    uint8_t data[2] = { reg, value };
+
+    if (i2c_master_transmit(dev, data, sizeof(data), CONFIG_PCA9685_TIMEOUT_MS) != ESP_OK) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Configure one chip: PWM frequency, auto-increment, totem-pole outputs
+ */
+static int pca9685_configure_chip(i2c_master_dev_handle_t dev)
+{
+    uint32_t prescale = (PCA9685_OSC_HZ + 2048u * CONFIG_PCA9685_PWM_FREQUENCY) /
+                        (4096u * CONFIG_PCA9685_PWM_FREQUENCY) - 1;
+
+    // PRESCALE is only writable while the oscillator sleeps
+    if (pca9685_write_reg(dev, PCA9685_REG_MODE1, PCA9685_MODE1_SLEEP | PCA9685_MODE1_AI) != 0 ||
+        pca9685_write_reg(dev, PCA9685_REG_PRESCALE, (uint8_t)prescale) != 0 ||
+        pca9685_write_reg(dev, PCA9685_REG_MODE2, PCA9685_MODE2_OUTDRV) != 0 ||
+        pca9685_write_reg(dev, PCA9685_REG_MODE1, PCA9685_MODE1_AI) != 0) {
+        return -1;
+    }
+
+    // Oscillator needs 500 us to stabilize after wake-up; a 1 ms task delay
+    // rounds to 0 ticks at the default 100 Hz tick rate
+    esp_rom_delay_us(500);
+    return 0;
+}
+
+/**
+ * ============================================================================
+ * PUBLIC API
+ * ============================================================================
+ */
+
+/**
+ * @brief Initialize the I2C bus and all expander chips
+ */
+int pca9685_init(void)
+{
+    ESP_LOGI(TAG, "Initializing %d PCA9685 chips (%d channels)",
+             CONFIG_PCA9685_CHIP_COUNT, PCA9685_CHANNEL_COUNT);
+
+    pca9685_mutex = xSemaphoreCreateMutexStatic(&pca9685_mutex_buffer);
+    if (pca9685_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex");
+        return -1;
+    }
+
+    i2c_master_bus_config_t bus_config = {
+        .i2c_port = CONFIG_PCA9685_I2C_PORT,
+        .sda_io_num = CONFIG_PCA9685_SDA_PIN,
+        .scl_io_num = CONFIG_PCA9685_SCL_PIN,
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = 7,
+        .trans_queue_depth = CONFIG_PCA9685_QUEUE_DEPTH,
+        .flags.enable_internal_pullup = true,   // Enough for 400 kHz only
+    };
+    if (i2c_new_master_bus(&bus_config, &bus_handle) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create I2C bus");
+        return -1;
+    }
+
+    for (int i = 0; i < CONFIG_PCA9685_CHIP_COUNT; i++) {
+        i2c_device_config_t device_config = {
+            .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+            .device_address = CONFIG_PCA9685_BASE_ADDRESS + i,
+            .scl_speed_hz = CONFIG_PCA9685_I2C_FREQUENCY,
+        };
+        if (i2c_master_bus_add_device(bus_handle, &device_config, &chip_handles[i]) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to add chip %d", i);
+            return -1;
+        }
+
+        if (pca9685_configure_chip(chip_handles[i]) != 0) {
+            ESP_LOGE(TAG, "Chip %d at 0x%02x not responding", i, CONFIG_PCA9685_BASE_ADDRESS + i);
+            return -1;
+        }
+
+        // From here on, transmits on this chip return immediately
+        i2c_master_event_callbacks_t callbacks = {
+            .on_trans_done = pca9685_trans_done,
+        };
+        if (i2c_master_register_event_callbacks(chip_handles[i], &callbacks, NULL) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to register callbacks for chip %d", i);
+            return -1;
+        }
+    }
+
+    pca9685_frame_init(&frame, PCA9685_CHANNEL_COUNT, CONFIG_PCA9685_MERGE_GAP);
+    return (pca9685_commit() < 0) ? -1 : 0;
+}
+
+/**
+ * @brief Number of channels provided by all chips
+ */
+uint32_t pca9685_channel_count(void)
+{
+    return PCA9685_CHANNEL_COUNT;
+}
+
+/**
+ * @brief Stage brightness on one channel (0..CONFIG_PWM_MAX_DUTY)
+ *
+ * Takes effect on the next pca9685_commit().
+ */
+int pca9685_set_channel(uint32_t channel, uint32_t duty)
+{
+    if (channel >= PCA9685_CHANNEL_COUNT) {
+        ESP_LOGE(TAG, "Invalid channel %lu", channel);
+        return -1;
+    }
+    if (duty > CONFIG_PWM_MAX_DUTY) {
+        duty = CONFIG_PWM_MAX_DUTY;
+    }
+
+    xSemaphoreTake(pca9685_mutex, portMAX_DELAY);
+    pca9685_frame_set(&frame, channel, (uint16_t)((duty * PCA9685_DUTY_MAX) / CONFIG_PWM_MAX_DUTY));
+    xSemaphoreGive(pca9685_mutex);
+
+    return 0;
+}
+
+/**
+ * @brief Get staged brightness of one channel (0..CONFIG_PWM_MAX_DUTY)
+ */
+uint32_t pca9685_get_channel(uint32_t channel)
+{
+    if (channel >= PCA9685_CHANNEL_COUNT) {
+        return 0;
+    }
+    return ((uint32_t)frame.duty[channel] * CONFIG_PWM_MAX_DUTY + PCA9685_DUTY_MAX / 2) /
+           PCA9685_DUTY_MAX;
+}
+
+/**
+ * @brief Queue all dirty channels as burst writes without blocking
+ *
+ * @return 0 on success, OUTPUT_COMMIT_PENDING if the bus was busy or
+ *         channels are left dirty, -1 on a queueing error
+ */
+int pca9685_commit(void)
+{
+    int result = 0;
+
+    xSemaphoreTake(pca9685_mutex, portMAX_DELAY);
+
+    if (bursts_sent != bursts_done) {
+        // Previous frame still on the bus; its buffers are in use
+        stats.coalesced++;
+        xSemaphoreGive(pca9685_mutex);
+        return OUTPUT_COMMIT_PENDING;
+    }
+
+    if (bus_error) {
+        // A lost write leaves the chip state unknown: resend everything
+        bus_error = false;
+        stats.bus_errors++;
+        pca9685_frame_mark_all_dirty(&frame);
+        ESP_LOGW(TAG, "Bus error, rewriting all channels");
+    }
+
+    uint32_t count = pca9685_frame_build(&frame, bursts, CONFIG_PCA9685_QUEUE_DEPTH);
+    if (count > 0) {
+        stats.frames++;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        bursts_sent++;
+        if (i2c_master_transmit(chip_handles[bursts[i].chip], bursts[i].data,
+                                bursts[i].length, -1) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to queue burst to chip %u", bursts[i].chip);
+            bursts_sent--;
+            bus_error = true;
+            result = -1;
+            break;
+        }
+        stats.bursts++;
+        stats.bytes += bursts[i].length;
+    }
+
+    // More dirty runs than bursts: the rest go out with the next commit
+    if (result == 0 && pca9685_frame_is_dirty(&frame)) {
+        result = OUTPUT_COMMIT_PENDING;
+    }
+
+    xSemaphoreGive(pca9685_mutex);
+    return result;
+}
+
+/**
+ * @brief Get transfer counters
+ */
+int pca9685_get_stats(pca9685_stats_t *out)
+{
+    if (out == NULL) {
+        ESP_LOGE(TAG, "Invalid stats pointer");
+        return -1;
+    }
+
+    *out = stats;
+    return 0;
+}
+
+/**
+ * ============================================================================
+ * OUTPUT DRIVER
+ * ============================================================================
+ */
+
+static int pca9685_output_init(void *ctx)
+{
+    return pca9685_init();
+}
+
+static void pca9685_output_get_caps(void *ctx, output_caps_t *caps)
+{
+    caps->channel_count = PCA9685_CHANNEL_COUNT;
+    caps->resolution_bits = 12;
+    caps->max_refresh_hz = CONFIG_PCA9685_REFRESH_HZ;
+}
+
+/**
+ * @brief Stage 16-bit duties at the full 12-bit resolution
+ */
+static int pca9685_output_stage(void *ctx, const uint16_t *duty, uint32_t count)
+{
+    xSemaphoreTake(pca9685_mutex, portMAX_DELAY);
+    for (uint32_t i = 0; i < count && i < PCA9685_CHANNEL_COUNT; i++) {
+        pca9685_frame_set(&frame, i, (uint16_t)(((uint32_t)duty[i] * PCA9685_DUTY_MAX +
+                                                 OUTPUT_DUTY_MAX / 2) / OUTPUT_DUTY_MAX));
+    }
+    xSemaphoreGive(pca9685_mutex);
+
+    return 0;
+}
+
+static int pca9685_output_commit(void *ctx)
+{
+    return pca9685_commit();
+}
+
+static const output_driver_t pca9685_driver = {
+    .name = "pca9685",
+    .init = pca9685_output_init,
+    .get_caps = pca9685_output_get_caps,
+    .stage = pca9685_output_stage,
+    .commit = pca9685_output_commit,
+    .ctx = NULL,
+};
+
+/**
+ * @brief Expander driver instance for output registration
+ */
+const output_driver_t *pca9685_output_driver(void)
+{
+    return &pca9685_driver;
+}
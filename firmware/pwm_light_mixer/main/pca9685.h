@@ -0,0 +1,30 @@
+#ifndef PCA9685_H
+#define PCA9685_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "output_driver.h"
+
+typedef struct {
+    uint32_t frames;                ///< Commits that started a bus transfer
+    uint32_t bursts;                ///< I2C transactions queued
+    uint32_t bytes;                 ///< Payload bytes queued (register + data)
+    uint32_t coalesced;             ///< Commits deferred because the bus was busy
+    uint32_t bus_errors;            ///< Transactions that ended in NACK or error
+} pca9685_stats_t;
+
+int pca9685_init(void);
+
+uint32_t pca9685_channel_count(void);
+
+int pca9685_set_channel(uint32_t channel, uint32_t duty);
+
+uint32_t pca9685_get_channel(uint32_t channel);
+
+int pca9685_commit(void);
+
+int pca9685_get_stats(pca9685_stats_t *stats);
+
+const output_driver_t *pca9685_output_driver(void);
+
+#endif
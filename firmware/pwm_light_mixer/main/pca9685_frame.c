@@ -0,0 +1,169 @@
+/**
+ * @file pca9685_frame.c
+ * @brief PCA9685 frame packing into auto-increment burst writes
+ *
+ * Channel duties are staged with a dirty bit each. Building a frame turns
+ * every run of dirty channels on one chip into a single write starting at
+ * that channel's LEDn_ON_L register; with MODE1.AI set the chip advances
+ * the register pointer itself, so a run of n channels costs 1 + 4n data
+ * bytes in one transaction instead of n transactions.
+ *
+ * Runs separated by at most merge_gap clean channels are bridged (the
+ * clean channels are rewritten unchanged) when a new transaction costs
+ * more than the extra bytes, which depends on the bus driver overhead.
+ *
+ * ON times are staggered per channel so outputs on one chip do not all
+ * switch on at counter zero, which spreads the supply inrush.
+ *
+ * Pure logic, shared by the I2C backend and the host benchmark.
+ */
+
+#include "pca9685_frame.h"
+#include <string.h>
+
+#define PCA9685_FULL_BIT              0x10               ///< Bit 4 of LEDn_ON_H / LEDn_OFF_H
+#define PCA9685_PHASE_STEP            (4096 / PCA9685_CHANNELS_PER_CHIP)
+
+static bool pca9685_frame_test_dirty(const pca9685_frame_t *frame, uint32_t channel)
+{
+    return (frame->dirty[channel / 32] >> (channel % 32)) & 1u;
+}
+
+/**
+ * @brief Encode one channel as ON_L, ON_H, OFF_L, OFF_H
+ */
+static void pca9685_frame_encode(uint32_t channel, uint16_t duty, uint8_t *out)
+{
+    uint32_t on = ((channel % PCA9685_CHANNELS_PER_CHIP) * PCA9685_PHASE_STEP) & 0x0FFF;
+    uint32_t off = (on + duty) & 0x0FFF;
+
+    if (duty == 0) {
+        out[0] = 0;
+        out[1] = 0;
+        out[2] = 0;
+        out[3] = PCA9685_FULL_BIT;  // Full off
+        return;
+    }
+    if (duty >= PCA9685_DUTY_MAX) {
+        out[0] = 0;
+        out[1] = PCA9685_FULL_BIT;  // Full on
+        out[2] = 0;
+        out[3] = 0;
+        return;
+    }
+
+    out[0] = (uint8_t)(on & 0xFF);
+    out[1] = (uint8_t)(on >> 8);
+    out[2] = (uint8_t)(off & 0xFF);
+    out[3] = (uint8_t)(off >> 8);
+}
+
+/**
+ * @brief Initialize a frame with every channel off and dirty
+ *
+ * The first build then writes all channels, which also clears whatever
+ * the chips held before reset.
+ */
+void pca9685_frame_init(pca9685_frame_t *frame, uint32_t channel_count, uint32_t merge_gap)
+{
+    memset(frame, 0, sizeof(*frame));
+    frame->channel_count = (channel_count > PCA9685_MAX_CHANNELS) ?
+                           PCA9685_MAX_CHANNELS : channel_count;
+    frame->merge_gap = merge_gap;
+    pca9685_frame_mark_all_dirty(frame);
+}
+
+/**
+ * @brief Mark every channel dirty, keeping the staged duties
+ *
+ * The next build rewrites all channels, e.g. after a lost write left the
+ * chip state unknown.
+ */
+void pca9685_frame_mark_all_dirty(pca9685_frame_t *frame)
+{
+    for (uint32_t ch = 0; ch < frame->channel_count; ch++) {
+        frame->dirty[ch / 32] |= 1u << (ch % 32);
+    }
+}
+
+/**
+ * @brief Stage a 12-bit duty on one channel
+ *
+ * @return true if the value changed and the channel became dirty
+ */
+bool pca9685_frame_set(pca9685_frame_t *frame, uint32_t channel, uint16_t duty)
+{
+    if (channel >= frame->channel_count) {
+        return false;
+    }
+    if (duty > PCA9685_DUTY_MAX) {
+        duty = PCA9685_DUTY_MAX;
+    }
+    if (frame->duty[channel] == duty) {
+        return false;
+    }
+
+    frame->duty[channel] = duty;
+    frame->dirty[channel / 32] |= 1u << (channel % 32);
+    return true;
+}
+
+/**
+ * @brief Check whether any channel awaits a write
+ */
+bool pca9685_frame_is_dirty(const pca9685_frame_t *frame)
+{
+    for (uint32_t i = 0; i < sizeof(frame->dirty) / sizeof(frame->dirty[0]); i++) {
+        if (frame->dirty[i] != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Pack all dirty channels into burst writes and clear their dirty bits
+ *
+ * Channels that do not fit into @p max_bursts stay dirty for the next build.
+ *
+ * @return Number of bursts produced
+ */
+uint32_t pca9685_frame_build(pca9685_frame_t *frame, pca9685_burst_t *bursts, uint32_t max_bursts)
+{
+    uint32_t count = 0;
+    uint32_t ch = 0;
+
+    while (ch < frame->channel_count && count < max_bursts) {
+        if (!pca9685_frame_test_dirty(frame, ch)) {
+            ch++;
+            continue;
+        }
+
+        // Extend the run while dirty channels follow within the merge gap
+        uint32_t chip_end = (ch / PCA9685_CHANNELS_PER_CHIP + 1) * PCA9685_CHANNELS_PER_CHIP;
+        if (chip_end > frame->channel_count) {
+            chip_end = frame->channel_count;
+        }
+        uint32_t last = ch;
+        for (uint32_t next = ch + 1; next < chip_end && next - last <= frame->merge_gap + 1; next++) {
+            if (pca9685_frame_test_dirty(frame, next)) {
+                last = next;
+            }
+        }
+
+        pca9685_burst_t *burst = &bursts[count++];
+        burst->chip = (uint8_t)(ch / PCA9685_CHANNELS_PER_CHIP);
+        burst->data[0] = (uint8_t)(PCA9685_REG_LED0_ON_L + 4 * (ch % PCA9685_CHANNELS_PER_CHIP));
+        burst->length = 1;
+
+        for (uint32_t i = ch; i <= last; i++) {
+            pca9685_frame_encode(i, frame->duty[i], &burst->data[burst->length]);
+            burst->length += 4;
+            frame->dirty[i / 32] &= ~(1u << (i % 32));
+        }
+
+        ch = last + 1;
+    }
+
+    return count;
+}
@@ -0,0 +1,38 @@
+#ifndef PCA9685_FRAME_H
+#define PCA9685_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PCA9685_CHANNELS_PER_CHIP     16
+#define PCA9685_MAX_CHIPS             8
+#define PCA9685_MAX_CHANNELS          (PCA9685_CHANNELS_PER_CHIP * PCA9685_MAX_CHIPS)
+#define PCA9685_DUTY_MAX              4095               ///< 12-bit counter
+#define PCA9685_REG_LED0_ON_L         0x06
+#define PCA9685_BURST_MAX_BYTES       (1 + PCA9685_CHANNELS_PER_CHIP * 4)
+
+/** One auto-increment write: register address followed by channel data */
+typedef struct {
+    uint8_t chip;                   ///< Chip index (address = base + chip)
+    uint8_t length;                 ///< Bytes used in data[]
+    uint8_t data[PCA9685_BURST_MAX_BYTES];
+} pca9685_burst_t;
+
+typedef struct {
+    uint32_t channel_count;
+    uint32_t merge_gap;             ///< Clean channels bridged to avoid a new transaction
+    uint16_t duty[PCA9685_MAX_CHANNELS];
+    uint32_t dirty[(PCA9685_MAX_CHANNELS + 31) / 32];
+} pca9685_frame_t;
+
+void pca9685_frame_init(pca9685_frame_t *frame, uint32_t channel_count, uint32_t merge_gap);
+
+void pca9685_frame_mark_all_dirty(pca9685_frame_t *frame);
+
+bool pca9685_frame_set(pca9685_frame_t *frame, uint32_t channel, uint16_t duty);
+
+bool pca9685_frame_is_dirty(const pca9685_frame_t *frame);
+
+uint32_t pca9685_frame_build(pca9685_frame_t *frame, pca9685_burst_t *bursts, uint32_t max_bursts);
+
+#endif
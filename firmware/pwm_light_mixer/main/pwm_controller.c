@@ -2,20 +2,86 @@
  * @file pwm_controller.c
  * @brief PWM LED Controller Implementation
  * 
- * Manages LEDC configuration and provides high-level PWM control API.
+ * Provides the high-level brightness control API.
+ *
+ * Brightness requests are staged per channel and applied in a single frame
+ * commit, which runs the output stages (master scale, power budget limiting)
+ * and hands the resulting duties to the output layer as one 16-bit frame
+ * whenever they changed.
+ *
+ * Requests arrive in the 0..CONFIG_PWM_MAX_DUTY API range but are held,
+ * scaled and ramped as 16-bit levels (0..OUTPUT_DUTY_MAX), so master scale
+ * factors and ramp steps reach outputs with more than 8 bits of resolution.
  */
 
 #include "pwm_controller.h"
 #include "config.h"
-#include "driver/ledc.h"
+#include "energy.h"
+#include "output.h"
+#include "deadline_monitor.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include <string.h>
 
 static const char *TAG = "PWM_CTRL";
 
-/** Current brightness state for each channel */
-static uint32_t current_duty_ch1 = 0;
-static uint32_t current_duty_ch2 = 0;
+/**
+ * ============================================================================
+ * CHANNEL TABLE
+ * ============================================================================
+ */
+
+typedef struct {
+    uint32_t full_scale_mw;         ///< Electrical power at 100% duty
+    uint8_t priority;               ///< Higher is served first when limiting
+    uint32_t requested;             ///< Level requested by the application (16-bit)
+    uint32_t output;                ///< Level after output stages (16-bit)
+} pwm_channel_t;
+
+static pwm_channel_t channels[PWM_CHANNEL_COUNT] = {
+    {
+        .full_scale_mw = CONFIG_PWM_CH1_FULL_SCALE_MW,
+        .priority = CONFIG_PWM_CH1_PRIORITY,
+    },
+    {
+        .full_scale_mw = CONFIG_PWM_CH2_FULL_SCALE_MW,
+        .priority = CONFIG_PWM_CH2_PRIORITY,
+    },
+};
+
+static pwm_power_stats_t power_stats = {0};
+
+/** Last frame was not accepted by every output and must be staged again */
+static bool frame_failed = false;
+
+/** Master output scale applied to every channel, product of all sources */
+static uint32_t master_scale_q16 = PWM_MASTER_UNITY_Q16;
+static uint32_t source_scale_q16[PWM_SCALE_SOURCE_COUNT] = {
+    [PWM_SCALE_THERMAL] = PWM_MASTER_UNITY_Q16,
+    [PWM_SCALE_DAYLIGHT] = PWM_MASTER_UNITY_Q16,
+};
+
+/** Background brightness ramp (power-on soft start) */
+typedef struct {
+    bool active;
+    uint32_t start_level;           ///< 16-bit levels, so slow ramps step finer than the API
+    uint32_t target_level;
+    uint32_t step;
+    uint32_t total_steps;
+    uint32_t delay_steps;
+} pwm_ramp_t;
+
+static pwm_ramp_t ramp = {0};
+static esp_timer_handle_t ramp_timer = NULL;
+
+// Serializes staging and frame commits between callers and the ramp timer
+static SemaphoreHandle_t pwm_mutex = NULL;
+static StaticSemaphore_t pwm_mutex_buffer;
+
+static void pwm_ramp_timer_callback(void *arg);
+static void pwm_ramp_step(void);
 
 /**
  * @brief Clamp duty value to valid range
@@ -31,144 +97,444 @@ static uint32_t pwm_clamp_duty(uint32_t duty)
     return duty;
 }
 
+/**
+ * @brief API duty (0..CONFIG_PWM_MAX_DUTY) to a 16-bit level
+ */
+static uint32_t pwm_duty_to_level(uint32_t duty)
+{
+    return (duty * OUTPUT_DUTY_MAX + CONFIG_PWM_MAX_DUTY / 2) / CONFIG_PWM_MAX_DUTY;
+}
+
+/**
+ * @brief 16-bit level to the nearest API duty
+ */
+static uint32_t pwm_level_to_duty(uint32_t level)
+{
+    return (level * CONFIG_PWM_MAX_DUTY + OUTPUT_DUTY_MAX / 2) / OUTPUT_DUTY_MAX;
+}
+
 /**
  * @brief Initialize PWM controller
+ *
+ * Outputs must be initialized first (output_init); they start at
+ * CONFIG_PWM_MIN_DUTY, which is the initial output of every channel.
  */
 int pwm_controller_init(void)
 {
     ESP_LOGI(TAG, "Initializing PWM controller");
     
-    // Configure LEDC timer
-    ledc_timer_config_t timer_config = {
-        .speed_mode = CONFIG_LEDC_MODE,
-        .timer_num = CONFIG_LEDC_TIMER,
-        .duty_resolution = CONFIG_LEDC_DUTY_RES,
-        .freq_hz = CONFIG_LEDC_FREQUENCY,
-        .clk_cfg = LEDC_AUTO_CLK
-    };
-    
-    if (ledc_timer_config(&timer_config) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure LEDC timer");
+    pwm_mutex = xSemaphoreCreateMutexStatic(&pwm_mutex_buffer);
+    if (pwm_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex");
         return -1;
     }
     
-    // Configure LED 1 channel
-    ledc_channel_config_t channel1_config = {
-        .speed_mode = CONFIG_LEDC_MODE,
-        .channel = CONFIG_LEDC_CHANNEL_1,
-        .timer_sel = CONFIG_LEDC_TIMER,
-        .intr_type = LEDC_INTR_DISABLE,
-        .gpio_num = CONFIG_LED_PIN_1,
-        .duty = CONFIG_PWM_MIN_DUTY,
-        .hpoint = 0
+    output_set_effects_hook(pwm_ramp_step);
+    const esp_timer_create_args_t ramp_timer_args = {
+        .callback = pwm_ramp_timer_callback,
+        .name = "pwm_ramp"
     };
-    
-    if (ledc_channel_config(&channel1_config) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure LED 1 channel");
+    if (esp_timer_create(&ramp_timer_args, &ramp_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create ramp timer");
         return -1;
     }
     
-    // Configure LED 2 channel
-    ledc_channel_config_t channel2_config = {
-        .speed_mode = CONFIG_LEDC_MODE,
-        .channel = CONFIG_LEDC_CHANNEL_2,
-        .timer_sel = CONFIG_LEDC_TIMER,
-        .intr_type = LEDC_INTR_DISABLE,
-        .gpio_num = CONFIG_LED_PIN_2,
-        .duty = CONFIG_PWM_MIN_DUTY,
-        .hpoint = 0
-    };
-    
-    if (ledc_channel_config(&channel2_config) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure LED 2 channel");
-        return -1;
+    for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+        channels[i].requested = pwm_duty_to_level(CONFIG_PWM_MIN_DUTY);
+        channels[i].output = pwm_duty_to_level(CONFIG_PWM_MIN_DUTY);
     }
-    
-    current_duty_ch1 = CONFIG_PWM_MIN_DUTY;
-    current_duty_ch2 = CONFIG_PWM_MIN_DUTY;
-    
+
     ESP_LOGI(TAG, "PWM controller initialized successfully");
-    ESP_LOGI(TAG, "  Pins: LED1=%d, LED2=%d", CONFIG_LED_PIN_1, CONFIG_LED_PIN_2);
-    ESP_LOGI(TAG, "  Frequency: %d Hz, Resolution: 8-bit", CONFIG_LEDC_FREQUENCY);
+    if (CONFIG_ENABLE_POWER_LIMIT) {
+        ESP_LOGI(TAG, "  Power budget: %d mW (%s)", CONFIG_PWM_POWER_BUDGET_MW,
+                 CONFIG_PWM_POWER_LIMIT_BY_PRIORITY ? "priority" : "proportional");
+    }
     
     return 0;
 }
 
 /**
- * @brief Set brightness on both LED channels synchronously
+ * ============================================================================
+ * FRAME COMMIT
+ * ============================================================================
  */
-int pwm_controller_set_brightness(uint32_t duty)
+
+/**
+ * @brief Electrical power of a channel at a given 16-bit level, in mW
+ */
+static uint32_t pwm_channel_power_mw(const pwm_channel_t *channel, uint32_t level)
 {
-    duty = pwm_clamp_duty(duty);
-    
-    // Update channel 1
-    if (ledc_set_duty(CONFIG_LEDC_MODE, CONFIG_LEDC_CHANNEL_1, duty) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set duty on channel 1");
-        return -1;
+    return (uint32_t)(((uint64_t)level * channel->full_scale_mw) / OUTPUT_DUTY_MAX);
+}
+
+/**
+ * @brief Scale a set of channels by budget/demand (Q16 fixed point)
+ *
+ * Rounds down, so the scaled power never exceeds the budget.
+ */
+static void pwm_scale_channels(uint32_t *duties, const bool *selected,
+                               uint32_t budget_mw, uint32_t demand_mw)
+{
+    uint32_t scale_q16 = (uint32_t)(((uint64_t)budget_mw << 16) / demand_mw);
+
+    for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+        if (selected[i]) {
+            duties[i] = (uint32_t)(((uint64_t)duties[i] * scale_q16) >> 16);
+        }
+    }
+}
+
+/**
+ * @brief Power budget stage: limit total electrical power to the supply cap
+ *
+ * Proportional mode scales every channel by the same factor. Priority mode
+ * serves channels in descending priority; the first level that no longer
+ * fits is scaled into the remaining budget and lower levels are switched off.
+ */
+static void pwm_apply_power_budget(uint32_t *duties)
+{
+    uint32_t demand_mw = 0;
+
+    for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+        demand_mw += pwm_channel_power_mw(&channels[i], duties[i]);
+    }
+
+    power_stats.frames++;
+    power_stats.requested_mw = demand_mw;
+
+    if (!CONFIG_ENABLE_POWER_LIMIT || demand_mw <= CONFIG_PWM_POWER_BUDGET_MW) {
+        power_stats.output_mw = demand_mw;
+        return;
+    }
+
+    power_stats.limit_events++;
+
+    bool selected[PWM_CHANNEL_COUNT];
+
+    if (!CONFIG_PWM_POWER_LIMIT_BY_PRIORITY) {
+        for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+            selected[i] = true;
+        }
+        pwm_scale_channels(duties, selected, CONFIG_PWM_POWER_BUDGET_MW, demand_mw);
+    } else {
+        uint32_t remaining_mw = CONFIG_PWM_POWER_BUDGET_MW;
+        int level = 255;
+
+        while (level >= 0) {
+            uint32_t level_mw = 0;
+            int next_level = -1;
+
+            for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+                selected[i] = (channels[i].priority == level);
+                if (selected[i]) {
+                    level_mw += pwm_channel_power_mw(&channels[i], duties[i]);
+                } else if (channels[i].priority < level && channels[i].priority > next_level) {
+                    next_level = channels[i].priority;
+                }
+            }
+
+            if (level_mw > remaining_mw) {
+                pwm_scale_channels(duties, selected, remaining_mw, level_mw);
+                remaining_mw = 0;
+            } else {
+                remaining_mw -= level_mw;
+            }
+
+            level = next_level;
+        }
+    }
+
+    uint32_t output_mw = 0;
+    for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+        output_mw += pwm_channel_power_mw(&channels[i], duties[i]);
+    }
+    power_stats.output_mw = output_mw;
+}
+
+/**
+ * @brief Run the output stages and stage changed frames (mutex must be held)
+ */
+static int pwm_commit_frame(void)
+{
+    uint32_t duties[PWM_CHANNEL_COUNT];
+
+    // Q16 product kept at 16 bits, not truncated back to the API range
+    for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+        duties[i] = (uint32_t)(((uint64_t)channels[i].requested * master_scale_q16) >> 16);
+    }
+
+    pwm_apply_power_budget(duties);
+
+    bool changed = false;
+    for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+        if (duties[i] != channels[i].output) {
+            changed = true;
+            channels[i].output = duties[i];
+        }
+    }
+
+    if (!changed && !frame_failed) {
+        return 0;
+    }
+
+    uint16_t frame[PWM_CHANNEL_COUNT];
+    for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+        frame[i] = (uint16_t)duties[i];
+    }
+
+    int result = output_stage_frame(frame, PWM_CHANNEL_COUNT);
+    frame_failed = (result != 0);
+
+    // Outputs are constant between commits, so metering only needs the changes
+    if (CONFIG_ENABLE_ENERGY_METER && changed) {
+        uint32_t power_mw[PWM_CHANNEL_COUNT];
+        for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+            power_mw[i] = pwm_channel_power_mw(&channels[i], duties[i]);
+        }
+        energy_note_frame(duties, power_mw);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Stage the same 16-bit level on all channels (mutex must be held)
+ */
+static void pwm_stage_all(uint32_t level)
+{
+    for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+        channels[i].requested = level;
+    }
+}
+
+/**
+ * ============================================================================
+ * POWER-ON RAMP
+ * ============================================================================
+ */
+
+/**
+ * @brief Abort a running ramp (mutex must be held)
+ *
+ * Direct brightness requests always win over a power-on ramp.
+ */
+static void pwm_cancel_ramp(void)
+{
+    if (ramp.active) {
+        ramp.active = false;
+        esp_timer_stop(ramp_timer);
+        ESP_LOGI(TAG, "Ramp cancelled at duty %lu", pwm_level_to_duty(channels[0].requested));
     }
+}
+
+/**
+ * @brief Ramp timer callback, one step per CONFIG_SOFTSTART_STEP_MS
+ *
+ * The esp_timer task runs on the input core; the step itself is composed
+ * on the output core.
+ */
+static void pwm_ramp_timer_callback(void *arg)
+{
+    output_request_effects();
+}
+
+/**
+ * @brief Advance the ramp one step (output effects hook)
+ *
+ * Runs in the output task, so it never delays input handling.
+ */
+static void pwm_ramp_step(void)
+{
+    deadline_monitor_take(pwm_mutex);
     
-    if (ledc_update_duty(CONFIG_LEDC_MODE, CONFIG_LEDC_CHANNEL_1) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to update duty on channel 1");
-        return -1;
+    if (!ramp.active) {
+        xSemaphoreGive(pwm_mutex);
+        return;
     }
     
-    // Update channel 2
-    if (ledc_set_duty(CONFIG_LEDC_MODE, CONFIG_LEDC_CHANNEL_2, duty) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set duty on channel 2");
-        return -1;
+    if (ramp.delay_steps > 0) {
+        ramp.delay_steps--;
+        xSemaphoreGive(pwm_mutex);
+        return;
     }
     
-    if (ledc_update_duty(CONFIG_LEDC_MODE, CONFIG_LEDC_CHANNEL_2) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to update duty on channel 2");
-        return -1;
+    ramp.step++;
+    int64_t span = (int64_t)ramp.target_level - (int64_t)ramp.start_level;
+    uint32_t level = (uint32_t)((int64_t)ramp.start_level +
+                                span * ramp.step / (int64_t)ramp.total_steps);
+
+    pwm_stage_all(level);
+    pwm_commit_frame();
+    
+    if (ramp.step >= ramp.total_steps) {
+        ramp.active = false;
+        esp_timer_stop(ramp_timer);
+        ESP_LOGI(TAG, "Ramp complete at duty %lu", pwm_level_to_duty(level));
     }
     
-    current_duty_ch1 = duty;
-    current_duty_ch2 = duty;
+    xSemaphoreGive(pwm_mutex);
+}
+
+/**
+ * ============================================================================
+ * PUBLIC API
+ * ============================================================================
+ */
+
+/**
+ * @brief Set brightness on both LED channels synchronously
+ */
+int pwm_controller_set_brightness(uint32_t duty)
+{
+    duty = pwm_clamp_duty(duty);
     
-    return 0;
+    deadline_monitor_take(pwm_mutex);
+    pwm_cancel_ramp();
+    pwm_stage_all(pwm_duty_to_level(duty));
+    int result = pwm_commit_frame();
+    xSemaphoreGive(pwm_mutex);
+    
+    return result;
 }
 
 /**
- * @brief Set brightness on first LED channel
+ * @brief Ramp both channels to a brightness in the background
+ *
+ * Starts after @p delay_ms and moves linearly from the current duty to
+ * @p duty over @p duration_ms. Used for the power-on soft start so that
+ * fixtures sharing a supply don't all draw their inrush at the same instant.
  */
-int pwm_controller_set_brightness_ch1(uint32_t duty)
+int pwm_controller_ramp_to(uint32_t duty, uint32_t duration_ms, uint32_t delay_ms)
 {
     duty = pwm_clamp_duty(duty);
     
-    if (ledc_set_duty(CONFIG_LEDC_MODE, CONFIG_LEDC_CHANNEL_1, duty) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set duty on channel 1");
-        return -1;
+    uint32_t total_steps = duration_ms / CONFIG_SOFTSTART_STEP_MS;
+    if (total_steps == 0 && delay_ms == 0) {
+        return pwm_controller_set_brightness(duty);
     }
     
-    if (ledc_update_duty(CONFIG_LEDC_MODE, CONFIG_LEDC_CHANNEL_1) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to update duty on channel 1");
-        return -1;
+    deadline_monitor_take(pwm_mutex);
+    pwm_cancel_ramp();
+
+    ramp.start_level = channels[0].requested;
+    ramp.target_level = pwm_duty_to_level(duty);
+    ramp.step = 0;
+    ramp.total_steps = (total_steps > 0) ? total_steps : 1;
+    ramp.delay_steps = delay_ms / CONFIG_SOFTSTART_STEP_MS;
+    ramp.active = true;
+    
+    esp_err_t ret = esp_timer_start_periodic(ramp_timer, CONFIG_SOFTSTART_STEP_MS * 1000ULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start ramp timer: 0x%x", ret);
+        ramp.active = false;
+        pwm_stage_all(ramp.target_level);
+        int result = pwm_commit_frame();
+        xSemaphoreGive(pwm_mutex);
+        return result;
     }
     
-    current_duty_ch1 = duty;
+    xSemaphoreGive(pwm_mutex);
+    
+    ESP_LOGI(TAG, "Ramp %lu->%lu over %lu ms after %lu ms",
+             pwm_level_to_duty(ramp.start_level), duty, duration_ms, delay_ms);
     return 0;
 }
 
 /**
- * @brief Set brightness on second LED channel
+ * @brief Scale all channel outputs without changing requested brightness
+ *
+ * Used by output protection and trimming (thermal derating, daylight
+ * harvesting). Each source sets its own factor, 65536 meaning full output;
+ * the applied master scale is the product of all factors.
  */
-int pwm_controller_set_brightness_ch2(uint32_t duty)
+int pwm_controller_set_master_scale(pwm_scale_source_t source, uint32_t scale_q16)
 {
-    duty = pwm_clamp_duty(duty);
-    
-    if (ledc_set_duty(CONFIG_LEDC_MODE, CONFIG_LEDC_CHANNEL_2, duty) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set duty on channel 2");
+    if (source >= PWM_SCALE_SOURCE_COUNT) {
+        ESP_LOGE(TAG, "Invalid scale source %d", source);
         return -1;
     }
-    
-    if (ledc_update_duty(CONFIG_LEDC_MODE, CONFIG_LEDC_CHANNEL_2) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to update duty on channel 2");
+
+    if (scale_q16 > PWM_MASTER_UNITY_Q16) {
+        scale_q16 = PWM_MASTER_UNITY_Q16;
+    }
+
+    deadline_monitor_take(pwm_mutex);
+    source_scale_q16[source] = scale_q16;
+
+    uint32_t combined = PWM_MASTER_UNITY_Q16;
+    for (int i = 0; i < PWM_SCALE_SOURCE_COUNT; i++) {
+        combined = (uint32_t)(((uint64_t)combined * source_scale_q16[i]) >> 16);
+    }
+
+    int result = 0;
+    if (combined != master_scale_q16) {
+        master_scale_q16 = combined;
+        result = pwm_commit_frame();
+    }
+    xSemaphoreGive(pwm_mutex);
+
+    return result;
+}
+
+/**
+ * @brief Set brightness on one channel by index
+ */
+int pwm_controller_set_channel(uint32_t channel, uint32_t duty)
+{
+    if (channel >= PWM_CHANNEL_COUNT) {
+        ESP_LOGE(TAG, "Invalid channel %lu", channel);
         return -1;
     }
-    
-    current_duty_ch2 = duty;
-    return 0;
+
+    duty = pwm_clamp_duty(duty);
+
+    deadline_monitor_take(pwm_mutex);
+    pwm_cancel_ramp();
+    channels[channel].requested = pwm_duty_to_level(duty);
+    int result = pwm_commit_frame();
+    xSemaphoreGive(pwm_mutex);
+
+    return result;
+}
+
+/**
+ * @brief Get requested brightness of one channel by index
+ */
+uint32_t pwm_controller_get_channel(uint32_t channel)
+{
+    if (channel >= PWM_CHANNEL_COUNT) {
+        return 0;
+    }
+    return pwm_level_to_duty(channels[channel].requested);
+}
+
+/**
+ * @brief Get the level currently driven on one channel (after output stages)
+ *
+ * @return 16-bit level, 0..OUTPUT_DUTY_MAX
+ */
+uint32_t pwm_controller_get_output(uint32_t channel)
+{
+    if (channel >= PWM_CHANNEL_COUNT) {
+        return 0;
+    }
+    return channels[channel].output;
+}
+
+/**
+ * @brief Set brightness on first LED channel
+ */
+int pwm_controller_set_brightness_ch1(uint32_t duty)
+{
+    return pwm_controller_set_channel(0, duty);
+}
+
+/**
+ * @brief Set brightness on second LED channel
+ */
+int pwm_controller_set_brightness_ch2(uint32_t duty)
+{
+    return pwm_controller_set_channel(1, duty);
 }
 
 /**
@@ -176,7 +542,7 @@ int pwm_controller_set_brightness_ch2(uint32_t duty)
  */
 uint32_t pwm_controller_get_brightness_ch1(void)
 {
-    return current_duty_ch1;
+    return pwm_controller_get_channel(0);
 }
 
 /**
@@ -184,7 +550,7 @@ uint32_t pwm_controller_get_brightness_ch1(void)
  */
 uint32_t pwm_controller_get_brightness_ch2(void)
 {
-    return current_duty_ch2;
+    return pwm_controller_get_channel(1);
 }
 
 /**
@@ -192,6 +558,27 @@ uint32_t pwm_controller_get_brightness_ch2(void)
  */
 bool pwm_controller_is_enabled(void)
 {
-    return (current_duty_ch1 > CONFIG_PWM_MIN_DUTY) || 
-           (current_duty_ch2 > CONFIG_PWM_MIN_DUTY);
+    for (uint32_t i = 0; i < PWM_CHANNEL_COUNT; i++) {
+        if (channels[i].requested > pwm_duty_to_level(CONFIG_PWM_MIN_DUTY)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Get power budget counters
+ */
+int pwm_controller_get_power_stats(pwm_power_stats_t *stats)
+{
+    if (stats == NULL) {
+        ESP_LOGE(TAG, "Invalid stats pointer");
+        return -1;
+    }
+
+    deadline_monitor_take(pwm_mutex);
+    *stats = power_stats;
+    xSemaphoreGive(pwm_mutex);
+
+    return 0;
 }
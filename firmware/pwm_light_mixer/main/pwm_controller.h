@@ -3,11 +3,39 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "output_driver.h"
+
+#define PWM_CHANNEL_COUNT             2
+#define PWM_MASTER_UNITY_Q16          65536u             ///< Master scale of 100%
+
+/** Independent master scale factors; the applied scale is their product */
+typedef enum {
+    PWM_SCALE_THERMAL,              ///< Thermal derating
+    PWM_SCALE_DAYLIGHT,             ///< Daylight harvesting trim
+    PWM_SCALE_SOURCE_COUNT
+} pwm_scale_source_t;
+
+typedef struct {
+    uint32_t frames;                ///< Frame commits processed
+    uint32_t limit_events;          ///< Frames where the power budget scaled outputs
+    uint32_t requested_mw;          ///< Power demanded by the last frame
+    uint32_t output_mw;             ///< Power delivered by the last frame
+} pwm_power_stats_t;
 
 int pwm_controller_init(void);
 
 int pwm_controller_set_brightness(uint32_t duty);
 
+int pwm_controller_ramp_to(uint32_t duty, uint32_t duration_ms, uint32_t delay_ms);
+
+int pwm_controller_set_master_scale(pwm_scale_source_t source, uint32_t scale_q16);
+
+int pwm_controller_set_channel(uint32_t channel, uint32_t duty);
+
+uint32_t pwm_controller_get_channel(uint32_t channel);
+
+uint32_t pwm_controller_get_output(uint32_t channel);
+
 int pwm_controller_set_brightness_ch1(uint32_t duty);
 
 int pwm_controller_set_brightness_ch2(uint32_t duty);
@@ -18,4 +46,6 @@ uint32_t pwm_controller_get_brightness_ch2(void);
 
 bool pwm_controller_is_enabled(void);
 
+int pwm_controller_get_power_stats(pwm_power_stats_t *stats);
+
 #endif
@@ -0,0 +1,126 @@
+/**
+ * @file pwm_plan.c
+ * @brief PWM resolution / frequency planner with LEDC duty dithering
+ *
+ * The LEDC counter resolution halves with every doubling of the PWM
+ * frequency: at 80 MHz, 5 kHz allows 13 bits but the 20 kHz and up needed
+ * by rolling-shutter cameras only 11. The LEDC duty register carries
+ * 4 extra fractional bits which the hardware dithers, lengthening the
+ * ON time by one count in frac out of 16 periods, so the effective
+ * resolution can be topped up to a target at no CPU cost.
+ *
+ * Dithering adds a ripple at actual_hz / 2^dither_bits of one count
+ * amplitude; dither bits are only added while that rate stays at or above
+ * a minimum, so it stays well clear of camera line rates and visibility.
+ *
+ * Pure logic, shared by the LEDC output driver and the host planner.
+ */
+
+#include "pwm_plan.h"
+#include <string.h>
+
+/**
+ * @brief Dither bits needed to reach a target, within the ripple limit
+ */
+uint32_t pwm_plan_dither_bits(uint32_t actual_hz, uint32_t hw_bits, uint32_t target_bits,
+                              uint32_t min_dither_hz)
+{
+    uint32_t bits = 0;
+
+    while (hw_bits + bits < target_bits && bits < PWM_PLAN_DITHER_MAX_BITS &&
+           (actual_hz >> (bits + 1)) >= min_dither_hz) {
+        bits++;
+    }
+
+    return bits;
+}
+
+/**
+ * @brief Best plan for one frequency in one speed mode
+ *
+ * @return 0 if the frequency is reachable, -1 otherwise
+ */
+int pwm_plan_make(const ledc_alloc_clock_t *clocks, uint32_t clock_count, uint32_t mode,
+                  uint32_t freq_hz, uint32_t target_bits, uint32_t min_dither_hz,
+                  pwm_plan_t *plan)
+{
+    memset(plan, 0, sizeof(*plan));
+    plan->freq_hz = freq_hz;
+
+    bool found = false;
+    for (uint32_t c = 0; c < clock_count; c++) {
+        uint32_t divider_q8;
+
+        if (!(clocks[c].mode_mask & (1u << mode))) {
+            continue;
+        }
+
+        uint32_t bits = ledc_alloc_max_bits(clocks[c].hz, freq_hz, &divider_q8);
+        if (bits > plan->hw_bits) {
+            plan->hw_bits = bits;
+            plan->clock = c;
+            plan->divider_q8 = divider_q8;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return -1;
+    }
+
+    uint64_t counter = (uint64_t)plan->divider_q8 << plan->hw_bits;
+    plan->actual_hz = (uint32_t)((((uint64_t)clocks[plan->clock].hz << 8) + counter / 2) / counter);
+    plan->dither_bits = pwm_plan_dither_bits(plan->actual_hz, plan->hw_bits, target_bits,
+                                             min_dither_hz);
+    plan->effective_bits = plan->hw_bits + plan->dither_bits;
+    plan->dither_hz = plan->actual_hz >> plan->dither_bits;
+    plan->meets_target = (plan->effective_bits >= target_bits);
+    return 0;
+}
+
+/**
+ * @brief Highest-resolution plan within a frequency band
+ *
+ * Only the top frequency of each resolution step is worth testing: the
+ * counter width depends on the frequency alone, so within a step the
+ * highest frequency (furthest from visible and camera beat rates) wins,
+ * and it divides the clock exactly, so the period has no divider jitter.
+ *
+ * @return 0 if any frequency in the band is reachable, -1 otherwise
+ */
+int pwm_plan_best(const ledc_alloc_clock_t *clocks, uint32_t clock_count, uint32_t mode,
+                  uint32_t min_hz, uint32_t max_hz, uint32_t target_bits,
+                  uint32_t min_dither_hz, pwm_plan_t *plan)
+{
+    bool found = false;
+
+    for (uint32_t c = 0; c < clock_count; c++) {
+        if (!(clocks[c].mode_mask & (1u << mode))) {
+            continue;
+        }
+
+        for (uint32_t bits = 1; bits <= LEDC_ALLOC_MAX_BITS; bits++) {
+            // Highest frequency still giving this many bits (divider 1.0)
+            uint32_t step_hz = (uint32_t)(clocks[c].hz >> bits);
+            uint32_t freq_hz = (step_hz > max_hz) ? max_hz : step_hz;
+            pwm_plan_t candidate;
+
+            if (freq_hz < min_hz ||
+                pwm_plan_make(clocks, clock_count, mode, freq_hz, target_bits, min_dither_hz,
+                              &candidate) != 0) {
+                continue;
+            }
+
+            // Most effective bits, then fewest of them dithered, then fastest
+            if (!found || candidate.effective_bits > plan->effective_bits ||
+                (candidate.effective_bits == plan->effective_bits &&
+                 (candidate.hw_bits > plan->hw_bits ||
+                  (candidate.hw_bits == plan->hw_bits && candidate.freq_hz > plan->freq_hz)))) {
+                *plan = candidate;
+                found = true;
+            }
+        }
+    }
+
+    return found ? 0 : -1;
+}
@@ -0,0 +1,34 @@
+#ifndef PWM_PLAN_H
+#define PWM_PLAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ledc_alloc.h"
+
+#define PWM_PLAN_DITHER_MAX_BITS      4                  ///< LEDC fractional duty bits
+#define PWM_PLAN_CAMERA_SAFE_HZ       20000              ///< No banding on rolling-shutter video
+
+typedef struct {
+    uint32_t freq_hz;               ///< Requested frequency
+    uint32_t actual_hz;             ///< After divider rounding
+    uint32_t clock;                 ///< Index into the clock list
+    uint32_t divider_q8;            ///< Clock divider, 10.8 fixed point
+    uint32_t hw_bits;               ///< Timer resolution
+    uint32_t dither_bits;           ///< Fractional bits dithered by the LEDC
+    uint32_t effective_bits;        ///< hw_bits + dither_bits
+    uint32_t dither_hz;             ///< Repetition rate of the dither pattern
+    bool meets_target;
+} pwm_plan_t;
+
+uint32_t pwm_plan_dither_bits(uint32_t actual_hz, uint32_t hw_bits, uint32_t target_bits,
+                              uint32_t min_dither_hz);
+
+int pwm_plan_make(const ledc_alloc_clock_t *clocks, uint32_t clock_count, uint32_t mode,
+                  uint32_t freq_hz, uint32_t target_bits, uint32_t min_dither_hz,
+                  pwm_plan_t *plan);
+
+int pwm_plan_best(const ledc_alloc_clock_t *clocks, uint32_t clock_count, uint32_t mode,
+                  uint32_t min_hz, uint32_t max_hz, uint32_t target_bits,
+                  uint32_t min_dither_hz, pwm_plan_t *plan);
+
+#endif
@@ -0,0 +1,140 @@
+/**
+ * @file sdm.c
+ * @brief Sigma-delta modulator output driver
+ *
+ * Secondary low-cost dimming channels on the SDM peripheral (8 channels,
+ * any GPIO): status indicator LEDs, and 0-10 V dimming outputs through an
+ * RC filter and gain stage. At CONFIG_SDM_SAMPLE_RATE_HZ the pulse train
+ * averages out in a simple filter, and no LEDC timer or channel is used.
+ *
+ * Registered with the output layer like every other backend, so the
+ * channels follow the same 16-bit frames and batched commits. Each channel
+ * maps duties through its own sdm_map calibration curve; commit writes
+ * only the channels whose density changed.
+ */
+
+#include "sdm.h"
+#include "sdm_map.h"
+#include "config.h"
+#include "driver/sdm.h"
+#include "esp_log.h"
+
+static const char *TAG = "SDM";
+
+#define SDM_CHANNEL_COUNT             2
+
+typedef struct {
+    gpio_num_t gpio;
+    int8_t calibration[SDM_MAP_POINTS];
+    bool off_at_zero;
+    sdm_channel_handle_t handle;
+    sdm_map_t map;
+    int8_t staged;                  ///< Density staged for the next commit
+    int8_t written;                 ///< Density last written
+    bool valid;                     ///< written matches the hardware
+} sdm_output_channel_t;
+
+static sdm_output_channel_t channels[SDM_CHANNEL_COUNT] = {
+    {
+        .gpio = CONFIG_SDM_PIN_1,
+        .calibration = CONFIG_SDM_CH1_CALIBRATION,
+        .off_at_zero = CONFIG_SDM_CH1_OFF_AT_ZERO,
+    },
+    {
+        .gpio = CONFIG_SDM_PIN_2,
+        .calibration = CONFIG_SDM_CH2_CALIBRATION,
+        .off_at_zero = CONFIG_SDM_CH2_OFF_AT_ZERO,
+    },
+};
+
+/**
+ * @brief Create and enable one SDM channel per table entry, all at duty 0
+ */
+static int sdm_output_init(void *ctx)
+{
+    ESP_LOGI(TAG, "Initializing %d channels at %d Hz", SDM_CHANNEL_COUNT,
+             CONFIG_SDM_SAMPLE_RATE_HZ);
+
+    for (uint32_t i = 0; i < SDM_CHANNEL_COUNT; i++) {
+        sdm_map_init(&channels[i].map, channels[i].calibration, channels[i].off_at_zero);
+
+        sdm_config_t config = {
+            .gpio_num = channels[i].gpio,
+            .clk_src = SDM_CLK_SRC_DEFAULT,
+            .sample_rate_hz = CONFIG_SDM_SAMPLE_RATE_HZ,
+        };
+        if (sdm_new_channel(&config, &channels[i].handle) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create channel %lu", i);
+            return -1;
+        }
+
+        if (sdm_channel_enable(channels[i].handle) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to enable channel %lu", i);
+            return -1;
+        }
+
+        // The hardware starts at density 0 (50 %); no frame may follow for a while
+        channels[i].staged = sdm_map_density(&channels[i].map, 0);
+        channels[i].written = channels[i].staged;
+        if (sdm_channel_set_pulse_density(channels[i].handle, channels[i].staged) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to set density on channel %lu", i);
+            return -1;
+        }
+        channels[i].valid = true;
+    }
+
+    return 0;
+}
+
+static void sdm_output_get_caps(void *ctx, output_caps_t *caps)
+{
+    caps->channel_count = SDM_CHANNEL_COUNT;
+    caps->resolution_bits = 8;
+    caps->max_refresh_hz = 0;
+}
+
+static int sdm_output_stage(void *ctx, const uint16_t *duty, uint32_t count)
+{
+    for (uint32_t i = 0; i < count && i < SDM_CHANNEL_COUNT; i++) {
+        channels[i].staged = sdm_map_density(&channels[i].map, duty[i]);
+    }
+    return 0;
+}
+
+static int sdm_output_commit(void *ctx)
+{
+    int result = 0;
+
+    for (uint32_t i = 0; i < SDM_CHANNEL_COUNT; i++) {
+        if (channels[i].valid && channels[i].staged == channels[i].written) {
+            continue;
+        }
+
+        channels[i].written = channels[i].staged;
+        channels[i].valid = (sdm_channel_set_pulse_density(channels[i].handle,
+                                                           channels[i].staged) == ESP_OK);
+        if (!channels[i].valid) {
+            ESP_LOGE(TAG, "Failed to set density on channel %lu", i);
+            result = -1;
+        }
+    }
+
+    return result;
+}
+
+static const output_driver_t sdm_driver = {
+    .name = "sdm",
+    .init = sdm_output_init,
+    .get_caps = sdm_output_get_caps,
+    .stage = sdm_output_stage,
+    .commit = sdm_output_commit,
+    .ctx = NULL,
+};
+
+/**
+ * @brief Sigma-delta driver instance for output registration
+ */
+const output_driver_t *sdm_output_driver(void)
+{
+    return &sdm_driver;
+}
@@ -0,0 +1,8 @@
+#ifndef SDM_H
+#define SDM_H
+
+#include "output_driver.h"
+
+const output_driver_t *sdm_output_driver(void);
+
+#endif
@@ -0,0 +1,55 @@
+/**
+ * @file sdm_map.c
+ * @brief Calibrated brightness to sigma-delta density mapping
+ *
+ * The sigma-delta modulator takes a signed 8-bit pulse density, where -128
+ * is constantly low and 127 almost constantly high. After an RC filter and
+ * a 0-10 V gain stage, or through an indicator LED, the response is offset
+ * and not quite linear, so each channel carries a small calibration curve:
+ * the density measured to give 0, 25, 50, 75 and 100% output. Duties
+ * between calibration points are interpolated linearly and rounded.
+ *
+ * Pure logic with no driver dependencies.
+ */
+
+#include "sdm_map.h"
+#include <string.h>
+
+#define SDM_MAP_SEGMENT               (65535 / (SDM_MAP_POINTS - 1))
+
+/**
+ * @brief Set up a mapping from measured calibration densities
+ *
+ * @param density SDM_MAP_POINTS densities, non-decreasing
+ * @param off_at_zero Force the output fully off at duty 0 (indicators;
+ *        0-10 V outputs keep their calibrated zero instead)
+ */
+void sdm_map_init(sdm_map_t *map, const int8_t *density, bool off_at_zero)
+{
+    memcpy(map->density, density, sizeof(map->density));
+    map->off_at_zero = off_at_zero;
+}
+
+/**
+ * @brief Pulse density for a 16-bit duty
+ */
+int8_t sdm_map_density(const sdm_map_t *map, uint16_t duty)
+{
+    if (duty == 0 && map->off_at_zero) {
+        return SDM_MAP_DENSITY_OFF;
+    }
+
+    uint32_t segment = duty / SDM_MAP_SEGMENT;
+    if (segment >= SDM_MAP_POINTS - 1) {
+        segment = SDM_MAP_POINTS - 2;
+    }
+
+    int32_t offset = (int32_t)duty - (int32_t)(segment * SDM_MAP_SEGMENT);
+    int32_t low = map->density[segment];
+    int32_t span = map->density[segment + 1] - low;
+    int32_t length = (segment == SDM_MAP_POINTS - 2) ? 65535 - (int32_t)(segment * SDM_MAP_SEGMENT)
+                                                     : SDM_MAP_SEGMENT;
+    int32_t rounding = (span >= 0) ? length / 2 : -(length / 2);
+
+    return (int8_t)(low + (span * offset + rounding) / length);
+}
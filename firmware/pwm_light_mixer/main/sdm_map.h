@@ -0,0 +1,19 @@
+#ifndef SDM_MAP_H
+#define SDM_MAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SDM_MAP_POINTS                5                  ///< Calibration points at 0, 25, .., 100%
+#define SDM_MAP_DENSITY_OFF           (-128)             ///< Output constantly low
+
+typedef struct {
+    int8_t density[SDM_MAP_POINTS]; ///< Measured density for each calibration point
+    bool off_at_zero;               ///< Duty 0 forces SDM_MAP_DENSITY_OFF
+} sdm_map_t;
+
+void sdm_map_init(sdm_map_t *map, const int8_t *density, bool off_at_zero);
+
+int8_t sdm_map_density(const sdm_map_t *map, uint16_t duty);
+
+#endif
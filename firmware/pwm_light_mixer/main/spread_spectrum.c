@@ -0,0 +1,79 @@
+/**
+ * @file spread_spectrum.c
+ * @brief Triangular PWM frequency sweep for spread-spectrum operation
+ *
+ * A fixed PWM carrier puts its conducted emissions in narrow lines at the
+ * carrier harmonics. Sweeping the carrier across center +/- span spreads
+ * each line over the band, lowering the peak a quasi-peak detector sees.
+ *
+ * The band is precomputed as evenly spaced frequencies and walked as a
+ * triangle (up, then back down, without repeating the end points), the
+ * classic spread-spectrum profile with a flat spectral density. Each step
+ * is a table lookup, so the retune callback has a fixed cost.
+ *
+ * Pure logic; output_ledc applies the frequencies to its timers.
+ */
+
+#include "spread_spectrum.h"
+#include <string.h>
+
+/**
+ * @brief Lower edge of the band, where the period is longest
+ */
+uint32_t spread_spectrum_min_hz(uint32_t center_hz, uint32_t span_permille)
+{
+    return (uint32_t)(((uint64_t)center_hz * (1000 - span_permille)) / 1000);
+}
+
+/**
+ * @brief Upper edge of the band
+ */
+uint32_t spread_spectrum_max_hz(uint32_t center_hz, uint32_t span_permille)
+{
+    return (uint32_t)(((uint64_t)center_hz * (1000 + span_permille)) / 1000);
+}
+
+/**
+ * @brief Build the frequency table for a band
+ *
+ * @param span_permille Half-width of the band, per mille of center_hz
+ * @param steps Frequencies in the band (2..SPREAD_SPECTRUM_MAX_STEPS)
+ * @return 0 on success, -1 on invalid parameters
+ */
+int spread_spectrum_init(spread_spectrum_t *sweep, uint32_t center_hz, uint32_t span_permille,
+                         uint32_t steps)
+{
+    memset(sweep, 0, sizeof(*sweep));
+
+    if (steps < 2 || steps > SPREAD_SPECTRUM_MAX_STEPS || span_permille >= 1000 ||
+        center_hz == 0) {
+        return -1;
+    }
+
+    uint32_t low_hz = spread_spectrum_min_hz(center_hz, span_permille);
+    uint32_t high_hz = spread_spectrum_max_hz(center_hz, span_permille);
+
+    for (uint32_t i = 0; i < steps; i++) {
+        sweep->freq_hz[i] = low_hz + (uint32_t)(((uint64_t)(high_hz - low_hz) * i) / (steps - 1));
+    }
+
+    sweep->steps = steps;
+    sweep->index = steps / 2;
+    sweep->direction = 1;
+    return 0;
+}
+
+/**
+ * @brief Advance one step and return the new frequency
+ */
+uint32_t spread_spectrum_next(spread_spectrum_t *sweep)
+{
+    if (sweep->index == sweep->steps - 1) {
+        sweep->direction = -1;
+    } else if (sweep->index == 0) {
+        sweep->direction = 1;
+    }
+
+    sweep->index += sweep->direction;
+    return sweep->freq_hz[sweep->index];
+}
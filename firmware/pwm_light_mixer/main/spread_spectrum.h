@@ -0,0 +1,24 @@
+#ifndef SPREAD_SPECTRUM_H
+#define SPREAD_SPECTRUM_H
+
+#include <stdint.h>
+
+#define SPREAD_SPECTRUM_MAX_STEPS     32
+
+typedef struct {
+    uint32_t freq_hz[SPREAD_SPECTRUM_MAX_STEPS];    ///< Band, lowest first
+    uint32_t steps;
+    uint32_t index;                 ///< Frequency last returned
+    int32_t direction;              ///< +1 sweeping up, -1 down
+} spread_spectrum_t;
+
+uint32_t spread_spectrum_min_hz(uint32_t center_hz, uint32_t span_permille);
+
+uint32_t spread_spectrum_max_hz(uint32_t center_hz, uint32_t span_permille);
+
+int spread_spectrum_init(spread_spectrum_t *sweep, uint32_t center_hz, uint32_t span_permille,
+                         uint32_t steps);
+
+uint32_t spread_spectrum_next(spread_spectrum_t *sweep);
+
+#endif
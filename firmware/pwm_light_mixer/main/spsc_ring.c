@@ -0,0 +1,92 @@
+/**
+ * @file spsc_ring.c
+ * @brief Lock-free single-producer, single-consumer ring
+ *
+ * Hands fixed-size items from one task to another, typically across
+ * cores, without a mutex. The producer only writes head and the consumer
+ * only writes tail; both are free-running counters, so head - tail is the
+ * fill level even after they wrap. An item is copied in before head is
+ * published (release) and read out before tail is published, and each
+ * side loads the other's counter with acquire ordering, so a slot is never
+ * read before it is written or overwritten before it is read.
+ *
+ * Exactly one task may push and exactly one task may pop; several
+ * producers must serialize among themselves (e.g. under a mutex they
+ * already hold). No dependencies on ESP-IDF, so the ring can be exercised
+ * on the host (tools/spsc_ring).
+ */
+
+#include "spsc_ring.h"
+#include <string.h>
+
+/**
+ * @brief Set up an empty ring over caller-provided storage
+ *
+ * @param storage   capacity * item_size bytes
+ * @param item_size Size of one item in bytes
+ * @param capacity  Number of items, a power of two
+ * @return 0 on success, -1 on invalid arguments
+ */
+int spsc_ring_init(spsc_ring_t *ring, void *storage, uint32_t item_size, uint32_t capacity)
+{
+    if (ring == NULL || storage == NULL || item_size == 0 ||
+        capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return -1;
+    }
+
+    ring->storage = storage;
+    ring->item_size = item_size;
+    ring->capacity = capacity;
+    ring->head = 0;
+    ring->tail = 0;
+    return 0;
+}
+
+/**
+ * @brief Copy an item into the ring (producer only)
+ *
+ * @return 0 on success, -1 if the ring is full
+ */
+int spsc_ring_push(spsc_ring_t *ring, const void *item)
+{
+    uint32_t head = ring->head;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    if (head - tail >= ring->capacity) {
+        return -1;
+    }
+
+    memcpy(&ring->storage[(head & (ring->capacity - 1)) * ring->item_size], item,
+           ring->item_size);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/**
+ * @brief Copy the oldest item out of the ring (consumer only)
+ *
+ * @return 0 on success, -1 if the ring is empty
+ */
+int spsc_ring_pop(spsc_ring_t *ring, void *item)
+{
+    uint32_t tail = ring->tail;
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    if (head == tail) {
+        return -1;
+    }
+
+    memcpy(item, &ring->storage[(tail & (ring->capacity - 1)) * ring->item_size],
+           ring->item_size);
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/**
+ * @brief Number of queued items (exact from either side, a snapshot otherwise)
+ */
+uint32_t spsc_ring_count(const spsc_ring_t *ring)
+{
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,23 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    uint8_t *storage;               ///< capacity * item_size bytes
+    uint32_t item_size;
+    uint32_t capacity;              ///< Power of two
+    uint32_t head;                  ///< Items pushed, written by the producer only
+    uint32_t tail;                  ///< Items popped, written by the consumer only
+} spsc_ring_t;
+
+int spsc_ring_init(spsc_ring_t *ring, void *storage, uint32_t item_size, uint32_t capacity);
+
+int spsc_ring_push(spsc_ring_t *ring, const void *item);
+
+int spsc_ring_pop(spsc_ring_t *ring, void *item);
+
+uint32_t spsc_ring_count(const spsc_ring_t *ring);
+
+#endif
@@ -0,0 +1,332 @@
+/**
+ * @file state_journal.c
+ * @brief Append-only LED state journal on a raw flash partition
+ *
+ * Stores fixed-size, sequence-numbered, CRC-protected records back to back
+ * in a dedicated data partition. Each save is a single aligned 32-byte
+ * write; sectors are erased round-robin only when the head wraps onto them,
+ * so wear is spread evenly over the whole partition.
+ *
+ * Layout: the partition is split into flash sectors, each holding
+ * JOURNAL_RECORDS_PER_SECTOR slots written strictly in order. The newest
+ * record is found at boot by reading the first slot of every sector (to pick
+ * the sector with the highest sequence) and binary-searching that sector for
+ * the boundary between written and erased slots.
+ */
+
+#include "state_journal.h"
+#include "config.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_log.h"
+#include <stddef.h>
+#include <string.h>
+
+static const char *TAG = "STATE_JOURNAL";
+
+/**
+ * ============================================================================
+ * RECORD FORMAT
+ * ============================================================================
+ */
+
+#define JOURNAL_RECORD_MAGIC          0x4C4A5253u        ///< "SRJL"
+#define JOURNAL_ERASED_WORD           0xFFFFFFFFu
+#define JOURNAL_SECTOR_SIZE           4096u
+#define JOURNAL_RECORD_SIZE           32u
+#define JOURNAL_RECORDS_PER_SECTOR    STATE_JOURNAL_RECORDS_PER_SECTOR
+
+typedef struct {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t pwm_value;
+    uint8_t pwm_enabled;
+    uint8_t reserved[15];
+    uint32_t crc32;                 ///< CRC over all preceding bytes
+} state_journal_record_t;
+
+_Static_assert(sizeof(state_journal_record_t) == JOURNAL_RECORD_SIZE,
+               "Journal record must be exactly one write unit");
+_Static_assert(JOURNAL_RECORDS_PER_SECTOR * JOURNAL_RECORD_SIZE == JOURNAL_SECTOR_SIZE,
+               "Records must tile a sector exactly");
+
+/**
+ * ============================================================================
+ * JOURNAL STATE
+ * ============================================================================
+ */
+
+static const esp_partition_t *journal_partition = NULL;
+static uint32_t sector_count = 0;
+
+// Next slot to be written
+static uint32_t head_sector = 0;
+static uint32_t head_slot = 0;
+static uint32_t next_sequence = 1;
+static bool head_sector_dirty = false;     ///< Head sector holds foreign data
+
+// Newest valid record found at boot or written since
+static state_journal_record_t latest_record;
+static bool latest_valid = false;
+
+/**
+ * @brief Compute the CRC of a record (excluding the CRC field itself)
+ */
+static uint32_t journal_record_crc(const state_journal_record_t *record)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)record,
+                            offsetof(state_journal_record_t, crc32));
+}
+
+/**
+ * @brief Check that a record carries the magic and a matching CRC
+ */
+static bool journal_record_is_valid(const state_journal_record_t *record)
+{
+    return record->magic == JOURNAL_RECORD_MAGIC &&
+           record->crc32 == journal_record_crc(record);
+}
+
+/**
+ * @brief Read one record slot from flash
+ */
+static int journal_read_slot(uint32_t sector, uint32_t slot, state_journal_record_t *record)
+{
+    size_t offset = (size_t)sector * JOURNAL_SECTOR_SIZE + (size_t)slot * JOURNAL_RECORD_SIZE;
+
+    if (esp_partition_read(journal_partition, offset, record, sizeof(*record)) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read sector %lu slot %lu", sector, slot);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Check whether a slot is still erased (never written)
+ *
+ * Torn or corrupted records count as written so the head never lands on a
+ * slot that cannot be programmed again without an erase.
+ */
+static bool journal_slot_is_erased(uint32_t sector, uint32_t slot)
+{
+    state_journal_record_t record;
+
+    if (journal_read_slot(sector, slot, &record) != 0) {
+        return false;
+    }
+
+    const uint32_t *words = (const uint32_t *)&record;
+    for (size_t i = 0; i < sizeof(record) / sizeof(uint32_t); i++) {
+        if (words[i] != JOURNAL_ERASED_WORD) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Binary-search the first erased slot of a sector
+ *
+ * Slots are programmed strictly in order, so the sector is a run of written
+ * slots followed by a run of erased ones.
+ *
+ * @return Number of written slots (0..JOURNAL_RECORDS_PER_SECTOR)
+ */
+static uint32_t journal_find_fill_level(uint32_t sector)
+{
+    uint32_t low = 0;
+    uint32_t high = JOURNAL_RECORDS_PER_SECTOR;
+
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (journal_slot_is_erased(sector, mid)) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Find the newest valid record in a sector, scanning back from a slot
+ *
+ * @return true if a valid record was found and stored in @p record
+ */
+static bool journal_find_latest_in_sector(uint32_t sector, uint32_t fill_level,
+                                          state_journal_record_t *record)
+{
+    for (uint32_t slot = fill_level; slot > 0; slot--) {
+        if (journal_read_slot(sector, slot - 1, record) == 0 &&
+            journal_record_is_valid(record)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Locate the journal head and newest record
+ */
+static void journal_scan(void)
+{
+    state_journal_record_t record;
+    bool found = false;
+    uint32_t newest_sector = 0;
+    uint32_t newest_sequence = 0;
+
+    // The first slot of each sector tells which sector was opened last
+    for (uint32_t sector = 0; sector < sector_count; sector++) {
+        if (journal_read_slot(sector, 0, &record) != 0 || !journal_record_is_valid(&record)) {
+            continue;
+        }
+        if (!found || record.sequence > newest_sequence) {
+            found = true;
+            newest_sector = sector;
+            newest_sequence = record.sequence;
+        }
+    }
+
+    if (!found) {
+        ESP_LOGW(TAG, "Journal empty, starting at sector 0");
+        head_sector = 0;
+        head_slot = 0;
+        next_sequence = 1;
+        head_sector_dirty = !journal_slot_is_erased(0, 0);
+        latest_valid = false;
+        return;
+    }
+
+    uint32_t fill_level = journal_find_fill_level(newest_sector);
+
+    // Slot 0 of this sector is valid, so the search always finds a record;
+    // it only skips torn writes at the end of the sector
+    latest_valid = journal_find_latest_in_sector(newest_sector, fill_level, &latest_record);
+
+    head_sector = newest_sector;
+    head_slot = fill_level;
+    head_sector_dirty = false;
+    next_sequence = latest_record.sequence + 1;
+
+    // Sequence numbers must stay ahead of every slot used in the head sector
+    if (next_sequence < newest_sequence + fill_level) {
+        next_sequence = newest_sequence + fill_level;
+    }
+
+    ESP_LOGI(TAG, "Journal head: sector %lu slot %lu, next seq %lu",
+             head_sector, head_slot, next_sequence);
+}
+
+/**
+ * @brief Initialize the state journal
+ *
+ * Locates the journal partition and scans it for the newest record. The
+ * journal is optional: if the partition is missing, callers fall back to
+ * regular NVS storage.
+ */
+int state_journal_init(void)
+{
+    journal_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                 ESP_PARTITION_SUBTYPE_ANY,
+                                                 CONFIG_JOURNAL_PARTITION_LABEL);
+    if (journal_partition == NULL) {
+        ESP_LOGW(TAG, "Partition '%s' not found", CONFIG_JOURNAL_PARTITION_LABEL);
+        return -1;
+    }
+
+    sector_count = journal_partition->size / JOURNAL_SECTOR_SIZE;
+    if (sector_count < 2) {
+        ESP_LOGE(TAG, "Partition too small: %lu bytes (need 2 sectors)",
+                 journal_partition->size);
+        journal_partition = NULL;
+        return -1;
+    }
+
+    journal_scan();
+
+    ESP_LOGI(TAG, "Journal ready: %lu sectors, %u records/sector",
+             sector_count, (unsigned)JOURNAL_RECORDS_PER_SECTOR);
+    return 0;
+}
+
+/**
+ * @brief Check whether the journal partition is usable
+ */
+bool state_journal_is_available(void)
+{
+    return journal_partition != NULL;
+}
+
+/**
+ * @brief Get the newest valid record
+ *
+ * @return 0 on success, -1 if the journal is unavailable or empty
+ */
+int state_journal_read_latest(nvs_led_state_t *state)
+{
+    if (state == NULL || !latest_valid) {
+        return -1;
+    }
+
+    state->pwm_enabled = latest_record.pwm_enabled != 0;
+    state->pwm_value = latest_record.pwm_value;
+    return 0;
+}
+
+/**
+ * @brief Append a new state record
+ *
+ * Costs a single 32-byte flash write, plus one sector erase every
+ * JOURNAL_RECORDS_PER_SECTOR appends.
+ */
+int state_journal_append(const nvs_led_state_t *state)
+{
+    if (state == NULL || journal_partition == NULL) {
+        return -1;
+    }
+
+    if (head_slot >= JOURNAL_RECORDS_PER_SECTOR) {
+        head_sector = (head_sector + 1) % sector_count;
+        head_slot = 0;
+        head_sector_dirty = true;
+    }
+
+    if (head_sector_dirty) {
+        esp_err_t ret = esp_partition_erase_range(journal_partition,
+                                                  (size_t)head_sector * JOURNAL_SECTOR_SIZE,
+                                                  JOURNAL_SECTOR_SIZE);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to erase sector %lu: 0x%x", head_sector, ret);
+            return -1;
+        }
+        head_sector_dirty = false;
+    }
+
+    state_journal_record_t record;
+    memset(&record, 0xFF, sizeof(record));
+    record.magic = JOURNAL_RECORD_MAGIC;
+    record.sequence = next_sequence;
+    record.pwm_value = state->pwm_value;
+    record.pwm_enabled = state->pwm_enabled ? 1 : 0;
+    record.crc32 = journal_record_crc(&record);
+
+    size_t offset = (size_t)head_sector * JOURNAL_SECTOR_SIZE +
+                    (size_t)head_slot * JOURNAL_RECORD_SIZE;
+
+    // Whatever happens, this slot has been programmed and cannot be reused
+    head_slot++;
+
+    esp_err_t ret = esp_partition_write(journal_partition, offset, &record, sizeof(record));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write record %lu: 0x%x", record.sequence, ret);
+        return -1;
+    }
+
+    next_sequence++;
+    latest_record = record;
+    latest_valid = true;
+
+    ESP_LOGD(TAG, "Appended seq %lu at sector %lu slot %lu",
+             record.sequence, head_sector, head_slot - 1);
+    return 0;
+}
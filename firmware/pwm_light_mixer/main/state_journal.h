@@ -0,0 +1,18 @@
+#ifndef STATE_JOURNAL_H
+#define STATE_JOURNAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "nvs_manager.h"
+
+#define STATE_JOURNAL_RECORDS_PER_SECTOR  128   ///< 32-byte records per 4 KB sector
+
+int state_journal_init(void);
+
+bool state_journal_is_available(void);
+
+int state_journal_read_latest(nvs_led_state_t *state);
+
+int state_journal_append(const nvs_led_state_t *state);
+
+#endif
@@ -0,0 +1,229 @@
+/**
+ * @file thermal.c
+ * @brief NTC temperature sensing and thermal derating of the LED output
+ *
+ * Samples an NTC divider through the ADC oneshot driver from a low-rate
+ * esp_timer (never on the input path), averages the readings, converts
+ * them through a lookup table built once at init, and feeds the result to
+ * the derating curve whose output scales the pwm_controller master level.
+ *
+ * Divider: series resistor from 3V3 to the ADC pin, NTC from the pin to GND.
+ */
+
+#include "thermal.h"
+#include "thermal_derate.h"
+#include "config.h"
+#include "pwm_controller.h"
+#include "energy.h"
+#include "adc_shared.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <math.h>
+#include <stdlib.h>
+
+static const char *TAG = "THERMAL";
+
+/**
+ * ============================================================================
+ * NTC LOOKUP TABLE
+ * ============================================================================
+ */
+
+#define THERMAL_ADC_MAX               4095
+#define THERMAL_LUT_SHIFT             6                  ///< 64 ADC codes per entry
+#define THERMAL_LUT_SIZE              ((THERMAL_ADC_MAX >> THERMAL_LUT_SHIFT) + 2)
+#define THERMAL_FAULT_MARGIN          16                 ///< Codes near the rails = open/short
+#define THERMAL_TEMP_MIN_DC           (-400)
+#define THERMAL_TEMP_MAX_DC           1500
+
+/** Temperature (0.1 °C) at ADC code i << THERMAL_LUT_SHIFT */
+static int16_t ntc_lut[THERMAL_LUT_SIZE];
+
+static adc_oneshot_unit_handle_t adc_handle = NULL;
+static esp_timer_handle_t thermal_timer = NULL;
+static thermal_derate_t derate;
+static thermal_status_t status = {0};
+static uint32_t last_logged_level = THERMAL_DERATE_UNITY_Q16;
+
+/**
+ * @brief Build the code-to-temperature table from the NTC Beta model
+ *
+ * Runs once at init; the sampling path only does integer interpolation.
+ */
+static void thermal_build_lut(void)
+{
+    const float t0_kelvin = 298.15f;
+
+    for (int i = 0; i < THERMAL_LUT_SIZE; i++) {
+        int code = i << THERMAL_LUT_SHIFT;
+        int32_t temp_dc;
+
+        if (code <= 0) {
+            temp_dc = THERMAL_TEMP_MAX_DC;
+        } else if (code >= THERMAL_ADC_MAX) {
+            temp_dc = THERMAL_TEMP_MIN_DC;
+        } else {
+            float r_ntc = (float)CONFIG_THERMAL_SERIES_R_OHM * code / (THERMAL_ADC_MAX - code);
+            float inv_t = 1.0f / t0_kelvin +
+                          logf(r_ntc / CONFIG_THERMAL_NTC_R25_OHM) / CONFIG_THERMAL_NTC_BETA;
+            temp_dc = (int32_t)lroundf((1.0f / inv_t - 273.15f) * 10.0f);
+        }
+
+        if (temp_dc > THERMAL_TEMP_MAX_DC) {
+            temp_dc = THERMAL_TEMP_MAX_DC;
+        } else if (temp_dc < THERMAL_TEMP_MIN_DC) {
+            temp_dc = THERMAL_TEMP_MIN_DC;
+        }
+        ntc_lut[i] = (int16_t)temp_dc;
+    }
+}
+
+/**
+ * @brief Convert an averaged ADC code to temperature by interpolation
+ */
+static int32_t thermal_code_to_dc(uint32_t code)
+{
+    uint32_t index = code >> THERMAL_LUT_SHIFT;
+    int32_t frac = (int32_t)(code & ((1u << THERMAL_LUT_SHIFT) - 1));
+    int32_t low = ntc_lut[index];
+    int32_t high = ntc_lut[index + 1];
+
+    return low + (((high - low) * frac) >> THERMAL_LUT_SHIFT);
+}
+
+/**
+ * ============================================================================
+ * SAMPLING
+ * ============================================================================
+ */
+
+/**
+ * @brief Read and average CONFIG_THERMAL_SAMPLES conversions
+ *
+ * @return 0 on success, -1 on ADC error
+ */
+static int thermal_read_average(uint32_t *code)
+{
+    uint32_t sum = 0;
+
+    for (int i = 0; i < CONFIG_THERMAL_SAMPLES; i++) {
+        int raw = 0;
+        if (adc_oneshot_read(adc_handle, CONFIG_THERMAL_ADC_CHANNEL, &raw) != ESP_OK) {
+            return -1;
+        }
+        sum += (uint32_t)raw;
+    }
+
+    *code = sum / CONFIG_THERMAL_SAMPLES;
+    return 0;
+}
+
+/**
+ * @brief Periodic sampling callback (esp_timer task)
+ *
+ * An open or shorted sensor holds the current level rather than guessing a
+ * temperature, and is counted in the status.
+ */
+static void thermal_timer_callback(void *arg)
+{
+    uint32_t code;
+
+    status.samples++;
+
+    if (thermal_read_average(&code) != 0 ||
+        code < THERMAL_FAULT_MARGIN || code > THERMAL_ADC_MAX - THERMAL_FAULT_MARGIN) {
+        if (status.sensor_faults++ == 0) {
+            ESP_LOGW(TAG, "NTC reading invalid, holding output level");
+        }
+        return;
+    }
+
+    status.temperature_dc = thermal_code_to_dc(code);
+    status.level_q16 = thermal_derate_update(&derate, status.temperature_dc);
+
+    if (CONFIG_ENABLE_ENERGY_METER) {
+        energy_note_temperature(status.temperature_dc);
+    }
+
+    pwm_controller_set_master_scale(PWM_SCALE_THERMAL, status.level_q16);
+
+    // Log once per percent of level change to keep the log quiet
+    uint32_t delta = (status.level_q16 > last_logged_level) ?
+                     status.level_q16 - last_logged_level : last_logged_level - status.level_q16;
+    if (delta >= THERMAL_DERATE_UNITY_Q16 / 100) {
+        last_logged_level = status.level_q16;
+        ESP_LOGI(TAG, "%ld.%ld C -> output %lu%%", status.temperature_dc / 10,
+                 labs(status.temperature_dc % 10),
+                 (status.level_q16 * 100) / THERMAL_DERATE_UNITY_Q16);
+    }
+}
+
+/**
+ * ============================================================================
+ * PUBLIC API
+ * ============================================================================
+ */
+
+/**
+ * @brief Initialize the NTC ADC channel and start periodic derating
+ */
+int thermal_init(void)
+{
+    ESP_LOGI(TAG, "Initializing thermal derating on ADC channel %d", CONFIG_THERMAL_ADC_CHANNEL);
+
+    thermal_build_lut();
+
+    const thermal_derate_config_t derate_config = {
+        .start_dc = CONFIG_THERMAL_START_DC,
+        .full_dc = CONFIG_THERMAL_FULL_DC,
+        .hysteresis_dc = CONFIG_THERMAL_HYSTERESIS_DC,
+        .min_level_q16 = (CONFIG_THERMAL_MIN_LEVEL_PCT * THERMAL_DERATE_UNITY_Q16) / 100,
+        .max_step_q16 = (CONFIG_THERMAL_MAX_STEP_PCT * THERMAL_DERATE_UNITY_Q16) / 100
+    };
+    thermal_derate_init(&derate, &derate_config);
+    status.level_q16 = THERMAL_DERATE_UNITY_Q16;
+
+    if (adc_shared_get_unit(CONFIG_THERMAL_ADC_UNIT, &adc_handle) != 0) {
+        ESP_LOGE(TAG, "Failed to get ADC unit");
+        return -1;
+    }
+
+    adc_oneshot_chan_cfg_t channel_config = {
+        .atten = ADC_ATTEN_DB_12,
+        .bitwidth = ADC_BITWIDTH_12,
+    };
+    if (adc_oneshot_config_channel(adc_handle, CONFIG_THERMAL_ADC_CHANNEL, &channel_config) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure ADC channel");
+        return -1;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = thermal_timer_callback,
+        .name = "thermal"
+    };
+    if (esp_timer_create(&timer_args, &thermal_timer) != ESP_OK ||
+        esp_timer_start_periodic(thermal_timer, CONFIG_THERMAL_PERIOD_MS * 1000ULL) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start thermal timer");
+        return -1;
+    }
+
+    ESP_LOGI(TAG, "Derating %d.%d-%d.%d C to %d%%, period %d ms",
+             CONFIG_THERMAL_START_DC / 10, CONFIG_THERMAL_START_DC % 10,
+             CONFIG_THERMAL_FULL_DC / 10, CONFIG_THERMAL_FULL_DC % 10,
+             CONFIG_THERMAL_MIN_LEVEL_PCT, CONFIG_THERMAL_PERIOD_MS);
+    return 0;
+}
+
+/**
+ * @brief Get the latest temperature and derating level
+ */
+int thermal_get_status(thermal_status_t *out)
+{
+    if (out == NULL) {
+        ESP_LOGE(TAG, "Invalid status pointer");
+        return -1;
+    }
+
+    *out = status;
+    return 0;
+}
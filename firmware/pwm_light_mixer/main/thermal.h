@@ -0,0 +1,18 @@
+#ifndef THERMAL_H
+#define THERMAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    int32_t temperature_dc;         ///< Filtered NTC temperature (0.1 °C)
+    uint32_t level_q16;             ///< Applied output scale (65536 = 100%)
+    uint32_t samples;               ///< Completed sampling periods
+    uint32_t sensor_faults;         ///< Periods with an open or shorted NTC
+} thermal_status_t;
+
+int thermal_init(void);
+
+int thermal_get_status(thermal_status_t *status);
+
+#endif
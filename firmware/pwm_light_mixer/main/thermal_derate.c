@@ -0,0 +1,76 @@
+/**
+ * @file thermal_derate.c
+ * @brief Temperature-to-output derating curve with hysteresis
+ *
+ * Maps a temperature to an output scale (Q16) along a linear curve between
+ * a start and a full-derating temperature. Derating follows the curve as
+ * soon as it gets hotter, while recovery uses the curve shifted by the
+ * hysteresis so the output does not hunt around a threshold. Every update
+ * is slew-limited so changes stay smooth.
+ *
+ * Pure integer logic, driven by the thermal module on target and by
+ * scripted temperature profiles on the host.
+ */
+
+#include "thermal_derate.h"
+
+/**
+ * @brief Initialize a derating instance at full output
+ */
+void thermal_derate_init(thermal_derate_t *derate, const thermal_derate_config_t *config)
+{
+    derate->config = *config;
+    if (derate->config.full_dc <= derate->config.start_dc) {
+        derate->config.full_dc = derate->config.start_dc + 1;
+    }
+    if (derate->config.max_step_q16 == 0) {
+        derate->config.max_step_q16 = THERMAL_DERATE_UNITY_Q16;
+    }
+    derate->level_q16 = THERMAL_DERATE_UNITY_Q16;
+}
+
+/**
+ * @brief Output scale for a temperature, without hysteresis or slew limit
+ */
+uint32_t thermal_derate_curve(const thermal_derate_config_t *config, int32_t temp_dc)
+{
+    if (temp_dc <= config->start_dc) {
+        return THERMAL_DERATE_UNITY_Q16;
+    }
+    if (temp_dc >= config->full_dc) {
+        return config->min_level_q16;
+    }
+
+    uint32_t span_q16 = THERMAL_DERATE_UNITY_Q16 - config->min_level_q16;
+    uint32_t over = (uint32_t)(temp_dc - config->start_dc);
+    uint32_t range = (uint32_t)(config->full_dc - config->start_dc);
+
+    return THERMAL_DERATE_UNITY_Q16 - (uint32_t)(((uint64_t)span_q16 * over) / range);
+}
+
+/**
+ * @brief Feed a new temperature and get the updated output scale
+ */
+uint32_t thermal_derate_update(thermal_derate_t *derate, int32_t temp_dc)
+{
+    const thermal_derate_config_t *config = &derate->config;
+    uint32_t level = derate->level_q16;
+    uint32_t hotter = thermal_derate_curve(config, temp_dc);
+    uint32_t cooler = thermal_derate_curve(config, temp_dc + config->hysteresis_dc);
+    uint32_t target = level;
+
+    if (hotter < level) {
+        target = hotter;
+    } else if (cooler > level) {
+        target = cooler;
+    }
+
+    if (target < level) {
+        level = (level - target > config->max_step_q16) ? level - config->max_step_q16 : target;
+    } else if (target > level) {
+        level = (target - level > config->max_step_q16) ? level + config->max_step_q16 : target;
+    }
+
+    derate->level_q16 = level;
+    return level;
+}
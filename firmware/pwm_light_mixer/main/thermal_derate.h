@@ -0,0 +1,27 @@
+#ifndef THERMAL_DERATE_H
+#define THERMAL_DERATE_H
+
+#include <stdint.h>
+
+#define THERMAL_DERATE_UNITY_Q16      65536u             ///< Full output
+
+typedef struct {
+    int32_t start_dc;               ///< Derating starts above this (0.1 °C)
+    int32_t full_dc;                ///< Minimum level reached at this (0.1 °C)
+    int32_t hysteresis_dc;          ///< Recovery lags derating by this much (0.1 °C)
+    uint32_t min_level_q16;         ///< Output floor at full derating
+    uint32_t max_step_q16;          ///< Largest level change per update
+} thermal_derate_config_t;
+
+typedef struct {
+    thermal_derate_config_t config;
+    uint32_t level_q16;             ///< Current output scale
+} thermal_derate_t;
+
+void thermal_derate_init(thermal_derate_t *derate, const thermal_derate_config_t *config);
+
+uint32_t thermal_derate_curve(const thermal_derate_config_t *config, int32_t temp_dc);
+
+uint32_t thermal_derate_update(thermal_derate_t *derate, int32_t temp_dc);
+
+#endif
@@ -1,10 +1,13 @@
 #include "touch_sensor.h"
 #include "config.h"
+#include "input_events.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "freertos/semphr.h"
 #include "driver/gpio.h"
+#include "esp_attr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "hal/gpio_ll.h"
+#include "soc/gpio_struct.h"
 
 static const char *TAG = "TOUCH_SENSOR";
 
@@ -19,83 +22,93 @@ static volatile bool sensor_touched = false;
 static volatile uint32_t touch_event_count = 0;
 static volatile bool last_sensor_state = false;
 
-// Mutex for thread-safe access
-static SemaphoreHandle_t touch_mutex = NULL;
+// Guards the state above; the sampling callback may run in the timer ISR
+static portMUX_TYPE touch_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+static esp_timer_handle_t sample_timer = NULL;
 
 /**
  * @brief Read current sensor state
  * @return true if sensor is high (touched), false otherwise
  */
-static bool touch_sensor_read(void)
+static IRAM_ATTR bool touch_sensor_read(void)
 {
-    return gpio_get_level(CONFIG_TOUCH_SENSOR_PIN) == 1;
+    return gpio_ll_get_level(&GPIO, CONFIG_TOUCH_SENSOR_PIN) == 1;
 }
 
 /**
- * @brief RTOS task for touch sensor reading with debouncing
+ * @brief Sampling timer callback with debouncing (timer ISR or esp_timer task)
  * 
- * Monitors sensor pin with debouncing logic to filter noise and
- * properly detect touch edges.
+ * Samples the sensor pin every CONFIG_TOUCH_POLL_INTERVAL with debouncing
+ * logic to filter noise and properly detect touch edges, posting an input
+ * event for every touch.
  * 
- * @param pvParameters Task parameters (unused)
+ * @param arg Timer argument (unused)
  */
-static void touch_sensor_task(void *pvParameters)
+static IRAM_ATTR void touch_sensor_sample_callback(void *arg)
 {
-    ESP_LOGI(TAG, "Touch sensor task started");
+    static uint32_t debounce_counter = 0;
+    
+    bool current_state = touch_sensor_read();
+    
+    // Debouncing logic
+    if (current_state == last_sensor_state) {
+        debounce_counter = 0;
+        return;
+    }
+    
+    // State confirmed after debounce threshold
+    if (++debounce_counter < CONFIG_TOUCH_DEBOUNCE_COUNT) {
+        return;
+    }
     
-    uint32_t debounce_counter = 0;
-    const uint32_t debounce_threshold = CONFIG_TOUCH_DEBOUNCE_COUNT;
+    bool touched = false;
+    uint32_t count;
+    
+    portENTER_CRITICAL_SAFE(&touch_spinlock);
+    if (current_state && !sensor_touched) {
+        // Touch detected (transition to touched)
+        sensor_touched = true;
+        touch_event_count++;
+        touched = true;
+    } else if (!current_state && sensor_touched) {
+        // Touch released
+        sensor_touched = false;
+    }
+    count = touch_event_count;
+    portEXIT_CRITICAL_SAFE(&touch_spinlock);
     
-    while (1) {
-        bool current_state = touch_sensor_read();
-        
-        // Debouncing logic
-        if (current_state == last_sensor_state) {
-            debounce_counter = 0;
-        } else {
-            debounce_counter++;
-            
-            // State confirmed after debounce threshold
-            if (debounce_counter >= debounce_threshold) {
-                // State has changed
-                xSemaphoreTake(touch_mutex, portMAX_DELAY);
-                
-                if (current_state && !sensor_touched) {
-                    // Touch detected (transition to touched)
-                    sensor_touched = true;
-                    touch_event_count++;
-                    ESP_LOGI(TAG, "Touch detected! Event count: %lu", touch_event_count);
-                } else if (!current_state && sensor_touched) {
-                    // Touch released
-                    sensor_touched = false;
-                    ESP_LOGI(TAG, "Touch released");
-                }
-                
-                last_sensor_state = current_state;
-                debounce_counter = 0;
-                
-                xSemaphoreGive(touch_mutex);
-            }
-        }
-        
-        vTaskDelay(CONFIG_TOUCH_POLL_INTERVAL / portTICK_PERIOD_MS);
+    last_sensor_state = current_state;
+    debounce_counter = 0;
+    
+    // No logging here, this may run in the timer ISR; the main loop logs
+    if (touched) {
+        input_events_post(INPUT_EVENT_TOUCH, (int32_t)count);
     }
 }
 
 /**
  * @brief Initialize the touch sensor
  * 
- * Configures GPIO pin and creates background task for debounced edge detection.
+ * Configures GPIO pin and starts the sampling timer for debounced edge
+ * detection.
+ *
+ * @return 0 on success, -1 on failure (the other touch functions must not
+ *         be called then)
  */
-void touch_sensor_init(void)
+int touch_sensor_init(void)
 {
     ESP_LOGI(TAG, "Initializing touch sensor on GPIO %d", CONFIG_TOUCH_SENSOR_PIN);
     
-    // Create mutex for thread-safe access
-    touch_mutex = xSemaphoreCreateMutex();
-    if (touch_mutex == NULL) {
-        ESP_LOGE(TAG, "Failed to create mutex");
-        return;
+    const esp_timer_create_args_t timer_args = {
+        .callback = touch_sensor_sample_callback,
+        .dispatch_method = INPUT_TIMER_DISPATCH,
+        .name = "touch_sample",
+        .skip_unhandled_events = true
+    };
+    if (esp_timer_create(&timer_args, &sample_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create sampling timer");
+        return -1;
     }
     
     // Configure GPIO for touch sensor input
@@ -113,17 +126,14 @@ void touch_sensor_init(void)
     
     ESP_LOGI(TAG, "Touch sensor initialized on GPIO %d", CONFIG_TOUCH_SENSOR_PIN);
     
-    // Create and start the touch sensor task
-    xTaskCreate(
-        touch_sensor_task,           // Task function
-        "touch_sensor_task",         // Task name
-        CONFIG_TOUCH_TASK_STACK,     // Stack size
-        NULL,                        // Task parameters
-        CONFIG_TOUCH_TASK_PRIORITY,  // Priority
-        NULL                         // Task handle
-    );
+    // Start sampling
+    if (esp_timer_start_periodic(sample_timer, CONFIG_TOUCH_POLL_INTERVAL * 1000) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start sampling timer");
+        return -1;
+    }
     
-    ESP_LOGI(TAG, "Touch sensor RTOS task created");
+    ESP_LOGI(TAG, "Touch sensor sampling started");
+    return 0;
 }
 
 /**
@@ -132,9 +142,9 @@ void touch_sensor_init(void)
 bool touch_sensor_is_touched(void)
 {
     bool touched;
-    xSemaphoreTake(touch_mutex, portMAX_DELAY);
+    portENTER_CRITICAL(&touch_spinlock);
     touched = sensor_touched;
-    xSemaphoreGive(touch_mutex);
+    portEXIT_CRITICAL(&touch_spinlock);
     return touched;
 }
 
@@ -144,9 +154,9 @@ bool touch_sensor_is_touched(void)
 uint32_t touch_sensor_get_touch_count(void)
 {
     uint32_t count;
-    xSemaphoreTake(touch_mutex, portMAX_DELAY);
+    portENTER_CRITICAL(&touch_spinlock);
     count = touch_event_count;
-    xSemaphoreGive(touch_mutex);
+    portEXIT_CRITICAL(&touch_spinlock);
     return count;
 }
 
@@ -155,10 +165,10 @@ uint32_t touch_sensor_get_touch_count(void)
  */
 void touch_sensor_reset_touch_count(void)
 {
-    xSemaphoreTake(touch_mutex, portMAX_DELAY);
+    portENTER_CRITICAL(&touch_spinlock);
     touch_event_count = 0;
+    portEXIT_CRITICAL(&touch_spinlock);
     ESP_LOGI(TAG, "Touch event count reset");
-    xSemaphoreGive(touch_mutex);
 }
 
 /**
@@ -166,8 +176,8 @@ void touch_sensor_reset_touch_count(void)
  */
 void touch_sensor_get_state(touch_sensor_state_t *state)
 {
-    xSemaphoreTake(touch_mutex, portMAX_DELAY);
+    portENTER_CRITICAL(&touch_spinlock);
     state->is_touched = sensor_touched;
     state->touch_count = touch_event_count;
-    xSemaphoreGive(touch_mutex);
+    portEXIT_CRITICAL(&touch_spinlock);
 }
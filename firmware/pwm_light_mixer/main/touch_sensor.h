@@ -9,7 +9,7 @@ typedef struct {
     uint32_t touch_count;
 } touch_sensor_state_t;
 
-void touch_sensor_init(void);
+int touch_sensor_init(void);
 
 bool touch_sensor_is_touched(void);
 
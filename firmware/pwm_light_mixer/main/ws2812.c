@@ -0,0 +1,314 @@
+/**
+ * @file ws2812.c
+ * @brief Addressable LED (WS2812/SK6812) output backend on the RMT
+ *
+ * Exposes the strip with the same channel-indexed API as pwm_controller:
+ * channel = pixel x components + component, in R, G, B(, W) order, duty
+ * 0..CONFIG_PWM_MAX_DUTY. Components are stored in wire order (GRB / GRBW)
+ * so encoding is a straight pass over the pixel buffer.
+ *
+ * Frames are encoded with the precomputed symbol table into one of two
+ * symbol buffers and sent with the RMT copy encoder. While one buffer is
+ * on the wire the next frame is encoded into the other, so encoding
+ * overlaps transmission; if both buffers are busy the commit is deferred
+ * and the newest pixels go out with the next one.
+ *
+ * RMT DMA is used where the SoC has it (ESP32-S3); the original ESP32
+ * refills the RMT memory block from its ISR instead.
+ */
+
+#include "ws2812.h"
+#include "ws2812_encoder.h"
+#include "config.h"
+#include "driver/rmt_tx.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char *TAG = "WS2812";
+
+#define WS2812_COMPONENTS             CONFIG_WS2812_BYTES_PER_PIXEL
+#define WS2812_CHANNEL_COUNT          (CONFIG_WS2812_PIXEL_COUNT * WS2812_COMPONENTS)
+#define WS2812_FRAME_BYTES            WS2812_CHANNEL_COUNT
+#define WS2812_FRAME_SYMBOLS          (WS2812_FRAME_BYTES * WS2812_SYMBOLS_PER_BYTE + 1)
+
+_Static_assert(sizeof(rmt_symbol_word_t) == sizeof(ws2812_symbol_t),
+               "Encoder symbols must match the RMT symbol layout");
+_Static_assert(WS2812_COMPONENTS == 3 || WS2812_COMPONENTS == 4,
+               "WS2812 is RGB (3 bytes), SK6812 RGBW is 4 bytes");
+
+/** Wire position of each API component (R, G, B, W) */
+static const uint8_t WIRE_ORDER[4] = { 1, 0, 2, 3 };
+
+/**
+ * ============================================================================
+ * STATE
+ * ============================================================================
+ */
+
+static rmt_channel_handle_t tx_channel = NULL;
+static rmt_encoder_handle_t copy_encoder = NULL;
+static ws2812_encoder_t symbol_encoder;
+
+static uint8_t pixels[WS2812_FRAME_BYTES];
+static bool pixels_dirty = true;
+
+// Double buffer: frames alternate between the two, and finish in order
+static ws2812_symbol_t symbols[2][WS2812_FRAME_SYMBOLS];
+static volatile bool buffer_busy[2] = { false, false };
+static uint32_t next_buffer = 0;
+static uint32_t done_buffer = 0;
+
+static ws2812_stats_t stats = {0};
+static SemaphoreHandle_t ws2812_mutex = NULL;
+static StaticSemaphore_t ws2812_mutex_buffer;
+
+/**
+ * @brief Transmission complete callback (RMT ISR context)
+ */
+static bool IRAM_ATTR ws2812_trans_done(rmt_channel_handle_t channel,
+                                        const rmt_tx_done_event_data_t *event, void *arg)
+{
+    buffer_busy[done_buffer] = false;
+    done_buffer ^= 1;
+    return false;
+}
+
+/**
+ * @brief Store one component in wire order (mutex must be held)
+ */
+static void ws2812_stage_component(uint32_t channel, uint8_t value)
+{
+    uint32_t index = (channel / WS2812_COMPONENTS) * WS2812_COMPONENTS +
+                     WIRE_ORDER[channel % WS2812_COMPONENTS];
+    if (pixels[index] != value) {
+        pixels[index] = value;
+        pixels_dirty = true;
+    }
+}
+
+/**
+ * ============================================================================
+ * PUBLIC API
+ * ============================================================================
+ */
+
+/**
+ * @brief Initialize the RMT channel, symbol table and an all-off frame
+ */
+int ws2812_init(void)
+{
+    ESP_LOGI(TAG, "Initializing %d pixels x %d bytes on GPIO %d",
+             CONFIG_WS2812_PIXEL_COUNT, WS2812_COMPONENTS, CONFIG_WS2812_PIN);
+
+    ws2812_mutex = xSemaphoreCreateMutexStatic(&ws2812_mutex_buffer);
+    if (ws2812_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex");
+        return -1;
+    }
+
+    const ws2812_timing_t timing = {
+        .resolution_hz = CONFIG_WS2812_RESOLUTION_HZ,
+        .t0h_ns = CONFIG_WS2812_T0H_NS,
+        .t0l_ns = CONFIG_WS2812_T0L_NS,
+        .t1h_ns = CONFIG_WS2812_T1H_NS,
+        .t1l_ns = CONFIG_WS2812_T1L_NS,
+        .reset_us = CONFIG_WS2812_RESET_US,
+    };
+    ws2812_encoder_init(&symbol_encoder, &timing);
+
+    rmt_tx_channel_config_t channel_config = {
+        .gpio_num = CONFIG_WS2812_PIN,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = CONFIG_WS2812_RESOLUTION_HZ,
+        .mem_block_symbols = CONFIG_WS2812_MEM_BLOCK_SYMBOLS,
+        .trans_queue_depth = 2,
+        .flags.with_dma = CONFIG_WS2812_USE_DMA,
+    };
+    if (rmt_new_tx_channel(&channel_config, &tx_channel) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create RMT channel");
+        return -1;
+    }
+
+    rmt_copy_encoder_config_t encoder_config = {};
+    if (rmt_new_copy_encoder(&encoder_config, &copy_encoder) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create copy encoder");
+        return -1;
+    }
+
+    rmt_tx_event_callbacks_t callbacks = {
+        .on_trans_done = ws2812_trans_done,
+    };
+    if (rmt_tx_register_event_callbacks(tx_channel, &callbacks, NULL) != ESP_OK ||
+        rmt_enable(tx_channel) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to enable RMT channel");
+        return -1;
+    }
+
+    return (ws2812_commit() < 0) ? -1 : 0;
+}
+
+/**
+ * @brief Number of channels (pixels x components)
+ */
+uint32_t ws2812_channel_count(void)
+{
+    return WS2812_CHANNEL_COUNT;
+}
+
+/**
+ * @brief Stage one pixel component (0..CONFIG_PWM_MAX_DUTY)
+ *
+ * Takes effect on the next ws2812_commit().
+ */
+int ws2812_set_channel(uint32_t channel, uint32_t duty)
+{
+    if (channel >= WS2812_CHANNEL_COUNT) {
+        ESP_LOGE(TAG, "Invalid channel %lu", channel);
+        return -1;
+    }
+    if (duty > CONFIG_PWM_MAX_DUTY) {
+        duty = CONFIG_PWM_MAX_DUTY;
+    }
+
+    xSemaphoreTake(ws2812_mutex, portMAX_DELAY);
+    ws2812_stage_component(channel, (uint8_t)((duty * 255) / CONFIG_PWM_MAX_DUTY));
+    xSemaphoreGive(ws2812_mutex);
+
+    return 0;
+}
+
+/**
+ * @brief Get one staged pixel component (0..CONFIG_PWM_MAX_DUTY)
+ */
+uint32_t ws2812_get_channel(uint32_t channel)
+{
+    if (channel >= WS2812_CHANNEL_COUNT) {
+        return 0;
+    }
+
+    uint32_t index = (channel / WS2812_COMPONENTS) * WS2812_COMPONENTS +
+                     WIRE_ORDER[channel % WS2812_COMPONENTS];
+    return ((uint32_t)pixels[index] * CONFIG_PWM_MAX_DUTY) / 255;
+}
+
+/**
+ * @brief Encode the staged pixels and queue them without blocking
+ *
+ * @return 0 on success, OUTPUT_COMMIT_PENDING if both buffers are still
+ *         busy, -1 on a queueing error
+ */
+int ws2812_commit(void)
+{
+    xSemaphoreTake(ws2812_mutex, portMAX_DELAY);
+
+    if (!pixels_dirty) {
+        xSemaphoreGive(ws2812_mutex);
+        return 0;
+    }
+
+    uint32_t buffer = next_buffer;
+    if (buffer_busy[buffer]) {
+        // Previous frame in this buffer has not gone out yet
+        stats.coalesced++;
+        xSemaphoreGive(ws2812_mutex);
+        return OUTPUT_COMMIT_PENDING;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    size_t count = ws2812_encoder_encode(&symbol_encoder, pixels, WS2812_FRAME_BYTES,
+                                         symbols[buffer]);
+    stats.encode_us = (uint32_t)(esp_timer_get_time() - start_us);
+    if (stats.encode_us > stats.encode_us_max) {
+        stats.encode_us_max = stats.encode_us;
+    }
+    pixels_dirty = false;
+
+    rmt_transmit_config_t transmit_config = {
+        .loop_count = 0,
+    };
+    buffer_busy[buffer] = true;
+    if (rmt_transmit(tx_channel, copy_encoder, symbols[buffer],
+                     count * sizeof(ws2812_symbol_t), &transmit_config) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to queue frame");
+        buffer_busy[buffer] = false;
+        pixels_dirty = true;
+        xSemaphoreGive(ws2812_mutex);
+        return -1;
+    }
+
+    next_buffer ^= 1;
+    stats.frames++;
+
+    xSemaphoreGive(ws2812_mutex);
+    return 0;
+}
+
+/**
+ * @brief Get frame and encode timing counters
+ */
+int ws2812_get_stats(ws2812_stats_t *out)
+{
+    if (out == NULL) {
+        ESP_LOGE(TAG, "Invalid stats pointer");
+        return -1;
+    }
+
+    *out = stats;
+    return 0;
+}
+
+/**
+ * ============================================================================
+ * OUTPUT DRIVER
+ * ============================================================================
+ */
+
+static int ws2812_output_init(void *ctx)
+{
+    return ws2812_init();
+}
+
+static void ws2812_output_get_caps(void *ctx, output_caps_t *caps)
+{
+    caps->channel_count = WS2812_CHANNEL_COUNT;
+    caps->resolution_bits = 8;
+    caps->max_refresh_hz = CONFIG_WS2812_REFRESH_HZ;
+}
+
+static int ws2812_output_stage(void *ctx, const uint16_t *duty, uint32_t count)
+{
+    xSemaphoreTake(ws2812_mutex, portMAX_DELAY);
+    for (uint32_t i = 0; i < count && i < WS2812_CHANNEL_COUNT; i++) {
+        ws2812_stage_component(i, (uint8_t)(((uint32_t)duty[i] * 255 + OUTPUT_DUTY_MAX / 2) /
+                                            OUTPUT_DUTY_MAX));
+    }
+    xSemaphoreGive(ws2812_mutex);
+
+    return 0;
+}
+
+static int ws2812_output_commit(void *ctx)
+{
+    return ws2812_commit();
+}
+
+static const output_driver_t ws2812_driver = {
+    .name = "ws2812",
+    .init = ws2812_output_init,
+    .get_caps = ws2812_output_get_caps,
+    .stage = ws2812_output_stage,
+    .commit = ws2812_output_commit,
+    .ctx = NULL,
+};
+
+/**
+ * @brief Strip driver instance for output registration
+ */
+const output_driver_t *ws2812_output_driver(void)
+{
+    return &ws2812_driver;
+}
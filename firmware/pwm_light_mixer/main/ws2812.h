@@ -0,0 +1,29 @@
+#ifndef WS2812_H
+#define WS2812_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "output_driver.h"
+
+typedef struct {
+    uint32_t frames;                ///< Frames handed to the RMT
+    uint32_t coalesced;             ///< Commits deferred because both buffers were busy
+    uint32_t encode_us;             ///< Encode time of the last frame
+    uint32_t encode_us_max;         ///< Worst encode time so far
+} ws2812_stats_t;
+
+int ws2812_init(void);
+
+uint32_t ws2812_channel_count(void);
+
+int ws2812_set_channel(uint32_t channel, uint32_t duty);
+
+uint32_t ws2812_get_channel(uint32_t channel);
+
+int ws2812_commit(void);
+
+int ws2812_get_stats(ws2812_stats_t *stats);
+
+const output_driver_t *ws2812_output_driver(void);
+
+#endif
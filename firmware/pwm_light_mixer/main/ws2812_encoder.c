@@ -0,0 +1,81 @@
+/**
+ * @file ws2812_encoder.c
+ * @brief Precomputed bit-symbol encoder for WS2812/SK6812 pixels
+ *
+ * Every data bit on the wire is one RMT symbol (a high and a low phase).
+ * Rather than testing bits one by one for every frame, the symbols of all
+ * 256 byte values are computed once at init; encoding a frame is then one
+ * 32-byte table copy per byte, with a final reset symbol to latch it.
+ *
+ * Pure logic producing rmt_symbol_word_t-compatible words, shared by the
+ * RMT backend and the host benchmark.
+ */
+
+#include "ws2812_encoder.h"
+#include <string.h>
+
+#define WS2812_DURATION_MAX           0x7FFF             ///< 15-bit symbol field
+
+/**
+ * @brief Convert nanoseconds to RMT ticks, rounded to nearest
+ */
+static uint32_t ws2812_ticks(const ws2812_timing_t *timing, uint64_t ns)
+{
+    uint64_t ticks = (ns * timing->resolution_hz + 500000000u) / 1000000000u;
+
+    if (ticks == 0) {
+        ticks = 1;
+    }
+    return ticks > WS2812_DURATION_MAX ? WS2812_DURATION_MAX : (uint32_t)ticks;
+}
+
+/**
+ * @brief Pack one symbol in rmt_symbol_word_t layout
+ */
+ws2812_symbol_t ws2812_symbol(uint32_t level0, uint32_t duration0, uint32_t level1, uint32_t duration1)
+{
+    return (duration0 & WS2812_DURATION_MAX) | ((level0 & 1u) << 15) |
+           ((duration1 & WS2812_DURATION_MAX) << 16) | ((level1 & 1u) << 31);
+}
+
+/**
+ * @brief Build the byte-to-symbols table for a pixel timing
+ */
+void ws2812_encoder_init(ws2812_encoder_t *encoder, const ws2812_timing_t *timing)
+{
+    ws2812_symbol_t zero = ws2812_symbol(1, ws2812_ticks(timing, timing->t0h_ns),
+                                         0, ws2812_ticks(timing, timing->t0l_ns));
+    ws2812_symbol_t one = ws2812_symbol(1, ws2812_ticks(timing, timing->t1h_ns),
+                                        0, ws2812_ticks(timing, timing->t1l_ns));
+
+    for (uint32_t value = 0; value < 256; value++) {
+        for (uint32_t bit = 0; bit < WS2812_SYMBOLS_PER_BYTE; bit++) {
+            encoder->lut[value][bit] = (value & (0x80u >> bit)) ? one : zero;
+        }
+    }
+
+    // Split the latch time over both halves of one symbol
+    uint32_t half = ws2812_ticks(timing, (uint64_t)timing->reset_us * 1000u / 2);
+    encoder->reset = ws2812_symbol(0, half, 0, half);
+}
+
+/**
+ * @brief Encode pixel bytes (wire order) followed by the reset symbol
+ *
+ * @p symbols must hold count * 8 + 1 entries.
+ *
+ * @return Number of symbols written
+ */
+size_t ws2812_encoder_encode(const ws2812_encoder_t *encoder, const uint8_t *bytes, size_t count,
+                             ws2812_symbol_t *symbols)
+{
+    ws2812_symbol_t *out = symbols;
+
+    for (size_t i = 0; i < count; i++) {
+        memcpy(out, encoder->lut[bytes[i]], sizeof(encoder->lut[0]));
+        out += WS2812_SYMBOLS_PER_BYTE;
+    }
+    *out++ = encoder->reset;
+
+    return (size_t)(out - symbols);
+}
@@ -0,0 +1,33 @@
+#ifndef WS2812_ENCODER_H
+#define WS2812_ENCODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** Same layout as rmt_symbol_word_t: duration0:15, level0:1, duration1:15, level1:1 */
+typedef uint32_t ws2812_symbol_t;
+
+#define WS2812_SYMBOLS_PER_BYTE       8
+
+typedef struct {
+    uint32_t resolution_hz;         ///< RMT tick rate
+    uint32_t t0h_ns;                ///< High time of a 0 bit
+    uint32_t t0l_ns;                ///< Low time of a 0 bit
+    uint32_t t1h_ns;                ///< High time of a 1 bit
+    uint32_t t1l_ns;                ///< Low time of a 1 bit
+    uint32_t reset_us;              ///< Low time that latches the frame
+} ws2812_timing_t;
+
+typedef struct {
+    ws2812_symbol_t lut[256][WS2812_SYMBOLS_PER_BYTE];  ///< Byte -> 8 bit symbols, MSB first
+    ws2812_symbol_t reset;
+} ws2812_encoder_t;
+
+ws2812_symbol_t ws2812_symbol(uint32_t level0, uint32_t duration0, uint32_t level1, uint32_t duration1);
+
+void ws2812_encoder_init(ws2812_encoder_t *encoder, const ws2812_timing_t *timing);
+
+size_t ws2812_encoder_encode(const ws2812_encoder_t *encoder, const uint8_t *bytes, size_t count,
+                             ws2812_symbol_t *symbols);
+
+#endif
@@ -0,0 +1,169 @@
+/**
+ * @file bam_bench.c
+ * @brief Host-side BAM bit-plane packing benchmark
+ *
+ * Times the firmware packing kernel (main/bam_planes.c) against a
+ * straightforward per-sample, per-channel reference for 8, 16 and 32
+ * channels at 8, 10 and 12 bits, and checks every rebuilt period against
+ * the reference bit for bit.
+ *
+ * Three update patterns are measured: every channel fading (all planes
+ * change), one channel nudged by one code (incremental rebuild) and a
+ * duty change below the plane resolution (nothing to rewrite).
+ *
+ * Build and run from this directory:
+ * @code
+ * cc -O2 -Wall -I../../main bam_bench.c ../../main/bam_planes.c -o bam_bench
+ * ./bam_bench
+ * @endcode
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "bam_planes.h"
+
+#define BENCH_FRAMES                  2000
+#define BENCH_MAX_PERIOD_BYTES        ((1u << BAM_PLANES_MAX_BITS) * 4)
+
+typedef enum {
+    PATTERN_FADE,
+    PATTERN_NUDGE,
+    PATTERN_SUBCODE,
+    PATTERN_COUNT
+} bench_pattern_t;
+
+static const char *PATTERN_NAMES[PATTERN_COUNT] = { "fade", "nudge", "subcode" };
+
+static double bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * @brief Reference: compute every sample from the duty codes directly
+ */
+static void bench_reference(const bam_planes_t *layout, const uint16_t *duty, void *period)
+{
+    uint32_t max_code = (1u << layout->bits) - 1;
+    uint32_t samples = 1u << layout->bits;
+
+    for (uint32_t s = 0; s < samples; s++) {
+        uint32_t value = 0;
+
+        if (s != 1) {
+            uint32_t plane = (s == 0) ? 0 : 31 - __builtin_clz(s);
+            for (uint32_t ch = 0; ch < layout->channels; ch++) {
+                uint32_t code = ((uint32_t)duty[ch] * max_code + 32767u) / 65535u;
+                value |= ((code >> plane) & 1u) << ch;
+            }
+        }
+
+        if (layout->sample_bytes == 1) {
+            ((uint8_t *)period)[s] = (uint8_t)value;
+        } else if (layout->sample_bytes == 2) {
+            ((uint16_t *)period)[s] = (uint16_t)value;
+        } else {
+            ((uint32_t *)period)[s] = value;
+        }
+    }
+}
+
+/**
+ * @brief Next frame of duties for a pattern
+ */
+static void bench_step(bench_pattern_t pattern, uint32_t frame, uint32_t bits,
+                       uint32_t channels, uint16_t *duty)
+{
+    uint32_t code_step = 65535u / ((1u << bits) - 1);
+
+    switch (pattern) {
+    case PATTERN_FADE:
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            duty[ch] = (uint16_t)((frame * 97u + ch * 4099u) & 0xFFFF);
+        }
+        break;
+    case PATTERN_NUDGE:
+        duty[frame % channels] = (uint16_t)(duty[frame % channels] + ((frame & 1) ? code_step : 0));
+        break;
+    case PATTERN_SUBCODE:
+        duty[0] = (uint16_t)(32768u + (frame & 1) * (code_step / 4));
+        break;
+    default:
+        break;
+    }
+}
+
+int main(void)
+{
+    static uint32_t period[BENCH_MAX_PERIOD_BYTES / 4];
+    static uint32_t expected[BENCH_MAX_PERIOD_BYTES / 4];
+    const uint32_t channel_counts[] = { 8, 16, 32 };
+    const uint32_t bit_counts[] = { 8, 10, 12 };
+    int failures = 0;
+
+    printf("%4s %4s %8s %8s %14s %14s %14s %8s\n", "ch", "bits", "bytes", "pattern",
+           "reference[ns]", "full[ns]", "incr[ns]", "planes");
+
+    for (size_t c = 0; c < sizeof(channel_counts) / sizeof(channel_counts[0]); c++) {
+        for (size_t b = 0; b < sizeof(bit_counts) / sizeof(bit_counts[0]); b++) {
+            for (int p = 0; p < PATTERN_COUNT; p++) {
+                uint32_t channels = channel_counts[c];
+                uint32_t bits = bit_counts[b];
+                uint16_t duty[BAM_PLANES_MAX_CHANNELS] = {0};
+                uint32_t planes[BAM_PLANES_MAX_BITS];
+                bam_planes_t layout;
+                bam_planes_t full;
+
+                bam_planes_init(&layout, channels, bits);
+                bam_planes_init(&full, channels, bits);
+                size_t bytes = bam_planes_period_bytes(&layout);
+
+                double reference_ns = 0, full_ns = 0, incremental_ns = 0;
+                uint64_t rewritten = 0;
+
+                for (uint32_t frame = 0; frame < BENCH_FRAMES; frame++) {
+                    bench_step((bench_pattern_t)p, frame, bits, channels, duty);
+
+                    double t0 = bench_now_ns();
+                    bench_reference(&layout, duty, expected);
+                    double t1 = bench_now_ns();
+                    full.valid = false;
+                    bam_planes_pack(&full, duty, planes);
+                    bam_planes_fill(&full, planes, period);
+                    double t2 = bench_now_ns();
+                    bam_planes_pack(&layout, duty, planes);
+                    rewritten += bam_planes_fill(&layout, planes, period);
+                    double t3 = bench_now_ns();
+
+                    reference_ns += t1 - t0;
+                    full_ns += t2 - t1;
+                    incremental_ns += t3 - t2;
+
+                    if (memcmp(period, expected, bytes) != 0) {
+                        printf("MISMATCH ch=%u bits=%u pattern=%s frame=%u\n",
+                               channels, bits, PATTERN_NAMES[p], frame);
+                        failures++;
+                        break;
+                    }
+                }
+
+                printf("%4u %4u %8zu %8s %14.0f %14.0f %14.0f %8.2f\n", channels, bits, bytes,
+                       PATTERN_NAMES[p], reference_ns / BENCH_FRAMES, full_ns / BENCH_FRAMES,
+                       incremental_ns / BENCH_FRAMES, (double)rewritten / BENCH_FRAMES);
+            }
+        }
+    }
+
+    if (failures) {
+        printf("\n%d mismatching configurations\n", failures);
+        return 1;
+    }
+    printf("\nAll periods match the reference\n");
+    return 0;
+}
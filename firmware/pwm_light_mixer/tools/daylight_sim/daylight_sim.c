@@ -0,0 +1,194 @@
+/**
+ * @file daylight_sim.c
+ * @brief Host-side daylight harvesting simulation
+ *
+ * Closes the loop of the firmware PI controller (main/daylight_pi.c)
+ * around a simple room model: the sensor sees daylight plus the fixture's
+ * own contribution, which is proportional to the output trim. One update
+ * per simulated control period; prints daylight, trim and sensor lux, and
+ * summarizes energy saved, tracking error and the largest trim step.
+ *
+ * Build and run from this directory:
+ * @code
+ * cc -O2 -Wall -I../../main daylight_sim.c ../../main/daylight_pi.c -o daylight_sim
+ * ./daylight_sim [profile.txt]
+ * @endcode
+ *
+ * A profile file holds "<seconds> <daylight lux>" keyframes, one per line;
+ * daylight is linearly interpolated between keyframes. Without a file, a
+ * built-in working day with passing clouds is used.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "daylight_pi.h"
+
+/**
+ * ============================================================================
+ * SIMULATION PARAMETERS (mirror main/config.h)
+ * ============================================================================
+ */
+
+#define SIM_PERIOD_S                  1          ///< CONFIG_DAYLIGHT_PERIOD_MS
+#define SIM_PRINT_EVERY_S             900
+#define SIM_MAX_KEYFRAMES             256
+#define SIM_FIXTURE_LUX               550        ///< Fixture contribution at the user set point
+#define SIM_NOISE_LUX                 8          ///< Peak sensor noise
+
+typedef struct {
+    uint32_t time_s;
+    int32_t lux;
+} sim_keyframe_t;
+
+static const sim_keyframe_t DEFAULT_PROFILE[] = {
+    {     0,    0 },    // 07:00, lights on before sunrise
+    {  1800,   20 },
+    {  5400,  300 },    // Morning
+    { 10800,  700 },
+    { 14400,  900 },    // Late morning, fully daylit
+    { 18000,  950 },
+    { 18060,  250 },    // Cloud passes in one minute
+    { 18300,  250 },
+    { 18420,  950 },
+    { 21600,  800 },    // Afternoon
+    { 23400,  820 },
+    { 23430,  350 },    // Fast shadow
+    { 23460,  820 },
+    { 28800,  450 },
+    { 32400,  150 },    // Dusk
+    { 36000,    0 },    // 17:00
+};
+
+static sim_keyframe_t profile[SIM_MAX_KEYFRAMES];
+static uint32_t profile_count;
+
+static void sim_load_profile(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot open profile %s\n", path);
+        exit(1);
+    }
+
+    unsigned long time_s;
+    long lux;
+    while (profile_count < SIM_MAX_KEYFRAMES && fscanf(file, "%lu %ld", &time_s, &lux) == 2) {
+        profile[profile_count].time_s = (uint32_t)time_s;
+        profile[profile_count].lux = (int32_t)lux;
+        profile_count++;
+    }
+    fclose(file);
+}
+
+/**
+ * @brief Daylight at a time, interpolated between keyframes
+ */
+static int32_t sim_daylight_at(uint32_t time_s)
+{
+    for (uint32_t i = 1; i < profile_count; i++) {
+        if (time_s <= profile[i].time_s) {
+            const sim_keyframe_t *a = &profile[i - 1];
+            const sim_keyframe_t *b = &profile[i];
+            int32_t span = (int32_t)(b->time_s - a->time_s);
+            if (span == 0) {
+                return b->lux;
+            }
+            return a->lux + (b->lux - a->lux) * (int32_t)(time_s - a->time_s) / span;
+        }
+    }
+    return profile[profile_count - 1].lux;
+}
+
+/**
+ * @brief Deterministic sensor noise in [-SIM_NOISE_LUX, SIM_NOISE_LUX]
+ */
+static int32_t sim_noise(void)
+{
+    static uint32_t seed = 12345u;
+    seed = seed * 1103515245u + 12345u;
+    return (int32_t)((seed >> 16) % (2 * SIM_NOISE_LUX + 1)) - SIM_NOISE_LUX;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        sim_load_profile(argv[1]);
+    } else {
+        for (size_t i = 0; i < sizeof(DEFAULT_PROFILE) / sizeof(DEFAULT_PROFILE[0]); i++) {
+            profile[profile_count++] = DEFAULT_PROFILE[i];
+        }
+    }
+
+    if (profile_count == 0) {
+        fprintf(stderr, "Empty profile\n");
+        return 1;
+    }
+
+    // Firmware defaults from config.h
+    const daylight_pi_config_t config = {
+        .target_lux = 500,
+        .deadband_lux = 10,
+        .filter_shift = 3,
+        .kp_q16 = 24,
+        .ki_q16 = 4,
+        .min_level_q16 = (10 * DAYLIGHT_PI_UNITY_Q16) / 100,
+        .max_step_q16 = 328,
+    };
+
+    daylight_pi_t pi;
+    daylight_pi_init(&pi, &config);
+
+    uint32_t end_s = profile[profile_count - 1].time_s;
+    uint64_t level_sum = 0;
+    uint32_t periods = 0;
+    uint32_t max_step = 0;
+    uint32_t underlit_s = 0;
+    uint32_t overlit_s = 0;
+    uint32_t previous = pi.level_q16;
+
+    printf("%8s %10s %8s %10s\n", "time[s]", "daylight", "trim[%]", "sensor");
+
+    for (uint32_t t = 0; t <= end_s; t += SIM_PERIOD_S) {
+        int32_t daylight = sim_daylight_at(t);
+        int32_t fixture = (int32_t)(((uint64_t)SIM_FIXTURE_LUX * pi.level_q16) >> 16);
+        int32_t sensor = daylight + fixture + sim_noise();
+        if (sensor < 0) {
+            sensor = 0;
+        }
+
+        uint32_t level = daylight_pi_update(&pi, (uint32_t)sensor);
+
+        uint32_t step = (level > previous) ? level - previous : previous - level;
+        if (step > max_step) {
+            max_step = step;
+        }
+        previous = level;
+        level_sum += level;
+        periods++;
+
+        // Tracking only counts where the target is reachable at all
+        int32_t lit = daylight + fixture;
+        bool trim_free = level > config.min_level_q16 && level < DAYLIGHT_PI_UNITY_Q16;
+        if (trim_free && lit < (int32_t)config.target_lux * 9 / 10) {
+            underlit_s += SIM_PERIOD_S;
+        } else if (trim_free && lit > (int32_t)config.target_lux * 11 / 10) {
+            overlit_s += SIM_PERIOD_S;
+        }
+
+        if (t % SIM_PRINT_EVERY_S == 0) {
+            printf("%8u %10d %8.1f %10d\n", t, daylight,
+                   level * 100.0 / DAYLIGHT_PI_UNITY_Q16, sensor);
+        }
+    }
+
+    double mean_level = (double)level_sum / periods / DAYLIGHT_PI_UNITY_Q16;
+    printf("\nEnergy %.1f%% of the untrimmed fixture (%.1f%% saved)\n",
+           mean_level * 100.0, (1.0 - mean_level) * 100.0);
+    printf("Outside +/-10%% of target while trimming: %u s under, %u s over\n",
+           underlit_s, overlit_s);
+    printf("Largest trim step %.2f%% per %d s period\n",
+           max_step * 100.0 / DAYLIGHT_PI_UNITY_Q16, SIM_PERIOD_S);
+    return 0;
+}
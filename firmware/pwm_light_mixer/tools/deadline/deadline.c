@@ -0,0 +1,227 @@
+/**
+ * @file deadline.c
+ * @brief Host-side checks of the deadline accounting
+ *
+ * Drives main/deadline.c with scripted timestamps and checks:
+ *
+ * - register: the table and a zero budget are refused
+ * - late start: a periodic job starting more than its budget after its
+ *   period is recorded with the start delay, blamed on blocking reported
+ *   between runs, and fails its run even when the run itself is short;
+ *   aperiodic jobs have no start deadline
+ * - consecutive: late or long runs count up, one run on time resets it
+ * - worst offender: the job over budget by the largest factor wins, not
+ *   the one with the longest absolute overrun
+ * - history: after more than DEADLINE_HISTORY overruns the newest are kept
+ *   in order and older ages return NULL
+ *
+ * Build and run from this directory:
+ * @code
+ * cc -O2 -Wall -I../../main deadline.c ../../main/deadline.c -o deadline
+ * ./deadline
+ * @endcode
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "deadline.h"
+
+#define SIM_PERIOD_US                 50000      ///< Main loop period
+#define SIM_BUDGET_US                 25000      ///< Main loop budget and start slack
+
+static int sim_check(const char *name, bool ok, const char *detail)
+{
+    printf("%-14s %-5s %s\n", name, ok ? "ok" : "FAIL", detail);
+    return ok ? 0 : 1;
+}
+
+/** One run from start_us lasting run_us */
+static bool sim_run(deadline_t *deadline, uint32_t job, int64_t start_us, uint32_t run_us)
+{
+    deadline_begin(deadline, job, start_us);
+    return deadline_end(deadline, job, start_us + run_us);
+}
+
+static int sim_register(void)
+{
+    deadline_t deadline;
+    int zero;
+    int last = -1;
+    int full;
+
+    deadline_init(&deadline);
+    zero = deadline_register(&deadline, "zero", 0, 0);
+    for (int i = 0; i < DEADLINE_MAX_JOBS; i++) {
+        last = deadline_register(&deadline, "job", 0, 1000);
+    }
+    full = deadline_register(&deadline, "extra", 0, 1000);
+
+    char detail[96];
+    snprintf(detail, sizeof(detail), "zero budget %d, last %d, full table %d", zero, last, full);
+    return sim_check("register", zero == -1 && last == DEADLINE_MAX_JOBS - 1 && full == -1,
+                     detail);
+}
+
+static int sim_late_start(void)
+{
+    deadline_t deadline;
+    deadline_init(&deadline);
+    int job = deadline_register(&deadline, "loop", SIM_PERIOD_US, SIM_BUDGET_US);
+    int event = deadline_register(&deadline, "event", 0, SIM_BUDGET_US);
+
+    // First run has no previous start; the second starts at the very edge of the slack
+    bool first = sim_run(&deadline, job, 1000, 1000);
+    int64_t start_us = 1000 + SIM_PERIOD_US + SIM_BUDGET_US;
+    bool edge = sim_run(&deadline, job, start_us, 1000);
+    uint32_t edge_overruns = deadline.jobs[job].stats.overruns;
+
+    // A flash commit holds the loop up between runs: 10 ms late, short run
+    deadline_note_block(&deadline, job, DEADLINE_CAUSE_FLASH, 30000);
+    deadline_note_block(&deadline, job, DEADLINE_CAUSE_LOG, 2000);
+    start_us += SIM_PERIOD_US + SIM_BUDGET_US + 10000;
+    bool late = sim_run(&deadline, job, start_us, 1000);
+    const deadline_overrun_t *overrun = deadline_get_overrun(&deadline, 0);
+
+    // Aperiodic jobs may start whenever
+    bool aperiodic = sim_run(&deadline, event, 0, 1000) &&
+                     sim_run(&deadline, event, 10 * SIM_PERIOD_US, 1000);
+
+    char detail[128];
+    snprintf(detail, sizeof(detail), "delay %lu us, cause %s, blocked %lu us, overruns %lu",
+             overrun ? (unsigned long)overrun->elapsed_us : 0UL,
+             overrun ? deadline_cause_name(overrun->cause) : "-",
+             overrun ? (unsigned long)overrun->blocked_us : 0UL,
+             (unsigned long)deadline.jobs[job].stats.overruns);
+    return sim_check("late start", first && edge && edge_overruns == 0 && !late &&
+                     overrun != NULL && overrun->late_start &&
+                     overrun->job == (uint32_t)job &&
+                     overrun->elapsed_us == SIM_BUDGET_US + 10000 &&
+                     overrun->time_us == start_us &&
+                     overrun->cause == DEADLINE_CAUSE_FLASH && overrun->blocked_us == 30000 &&
+                     deadline.jobs[job].stats.overruns == 1 &&
+                     deadline.jobs[job].stats.consecutive == 1 &&
+                     aperiodic && deadline.jobs[event].stats.overruns == 0, detail);
+}
+
+static int sim_consecutive(void)
+{
+    deadline_t deadline;
+    deadline_init(&deadline);
+    int job = deadline_register(&deadline, "loop", SIM_PERIOD_US, SIM_BUDGET_US);
+    int64_t start_us = 0;
+    uint32_t peak;
+
+    // Three long runs, then a late start with a short run
+    for (int i = 0; i < 3; i++) {
+        sim_run(&deadline, job, start_us, SIM_BUDGET_US + 1);
+        start_us += SIM_PERIOD_US;
+    }
+    start_us += SIM_BUDGET_US + 1;
+    sim_run(&deadline, job, start_us, 1000);
+    peak = deadline.jobs[job].stats.consecutive;
+
+    // One run on time clears the streak, the next overrun starts over
+    start_us += SIM_PERIOD_US;
+    bool on_time = sim_run(&deadline, job, start_us, 1000);
+    uint32_t cleared = deadline.jobs[job].stats.consecutive;
+    start_us += SIM_PERIOD_US;
+    sim_run(&deadline, job, start_us, SIM_BUDGET_US + 1);
+
+    char detail[96];
+    snprintf(detail, sizeof(detail), "peak %lu, after on time %lu, then %lu, runs %lu",
+             (unsigned long)peak, (unsigned long)cleared,
+             (unsigned long)deadline.jobs[job].stats.consecutive,
+             (unsigned long)deadline.jobs[job].stats.runs);
+    return sim_check("consecutive", peak == 4 && on_time && cleared == 0 &&
+                     deadline.jobs[job].stats.consecutive == 1 &&
+                     deadline.jobs[job].stats.runs == 6 &&
+                     deadline.jobs[job].stats.overruns == 5, detail);
+}
+
+static int sim_worst_offender(void)
+{
+    deadline_t deadline;
+    deadline_init(&deadline);
+    int idle = deadline_register(&deadline, "idle", 0, 1000);
+    int slow = deadline_register(&deadline, "slow", 0, 100000);
+    int tight = deadline_register(&deadline, "tight", 0, 3);
+    int none = deadline_worst_offender(&deadline);
+
+    sim_run(&deadline, idle, 0, 500);
+
+    // slow: 150 ms over a 100 ms budget (1.5x, longest absolute overrun)
+    sim_run(&deadline, slow, 0, 150000);
+    int only_slow = deadline_worst_offender(&deadline);
+
+    // tight: 4 us over 3 us (1.33x) loses, 5 us (1.67x) wins
+    sim_run(&deadline, tight, 0, 4);
+    int below = deadline_worst_offender(&deadline);
+    sim_run(&deadline, tight, 0, 5);
+    int above = deadline_worst_offender(&deadline);
+
+    // A shorter later overrun does not lower the worst ratio
+    sim_run(&deadline, tight, 0, 4);
+    int kept = deadline_worst_offender(&deadline);
+
+    char detail[96];
+    snprintf(detail, sizeof(detail), "none %d, slow only %d, 1.33x %d, 1.67x %d, kept %d",
+             none, only_slow, below, above, kept);
+    return sim_check("worst offender", none == -1 && only_slow == slow && below == slow &&
+                     above == tight && kept == tight &&
+                     deadline.jobs[tight].stats.worst_us == 5, detail);
+}
+
+static int sim_history(void)
+{
+    deadline_t deadline;
+    deadline_init(&deadline);
+    int job = deadline_register(&deadline, "commit", 0, 100);
+    const uint32_t total = DEADLINE_HISTORY + 3;
+    bool few_ok;
+    bool ordered = true;
+
+    // Overrun n lasts 100 + n us, so its age can be read back from elapsed_us
+    for (uint32_t n = 1; n <= 3; n++) {
+        sim_run(&deadline, job, n * 1000, 100 + n);
+    }
+    few_ok = deadline_get_overrun(&deadline, 2) != NULL &&
+             deadline_get_overrun(&deadline, 2)->elapsed_us == 101 &&
+             deadline_get_overrun(&deadline, 3) == NULL;
+
+    for (uint32_t n = 4; n <= total; n++) {
+        sim_run(&deadline, job, n * 1000, 100 + n);
+    }
+    for (uint32_t age = 0; age < DEADLINE_HISTORY; age++) {
+        const deadline_overrun_t *overrun = deadline_get_overrun(&deadline, age);
+        if (overrun == NULL || overrun->elapsed_us != 100 + total - age ||
+            overrun->time_us != (int64_t)(total - age) * 1000 + 100 + total - age ||
+            overrun->late_start || overrun->budget_us != 100) {
+            ordered = false;
+        }
+    }
+    bool beyond = deadline_get_overrun(&deadline, DEADLINE_HISTORY) == NULL;
+
+    char detail[96];
+    snprintf(detail, sizeof(detail), "%lu overruns, newest %lu us, oldest kept %lu us",
+             (unsigned long)deadline.overruns,
+             (unsigned long)deadline_get_overrun(&deadline, 0)->elapsed_us,
+             (unsigned long)deadline_get_overrun(&deadline, DEADLINE_HISTORY - 1)->elapsed_us);
+    return sim_check("history", few_ok && ordered && beyond && deadline.overruns == total,
+                     detail);
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    failures += sim_register();
+    failures += sim_late_start();
+    failures += sim_consecutive();
+    failures += sim_worst_offender();
+    failures += sim_history();
+
+    return failures ? 1 : 0;
+}
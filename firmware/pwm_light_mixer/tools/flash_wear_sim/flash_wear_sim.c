@@ -0,0 +1,433 @@
+/**
+ * @file flash_wear_sim.c
+ * @brief Host-side flash wear and write-amplification benchmark
+ *
+ * Replays multi-year usage profiles through the firmware commit policies
+ * (the real main/nvs_policy.c plus the legacy fixed debounce) against
+ * simulated persistence backends, and reports bytes written, sector erases,
+ * worst sector wear and projected flash lifetime for every combination.
+ *
+ * Backends:
+ * - nvs:     two NVS key/value entries per commit (pwm_en + pwm_val) in a
+ *            ring of 4 KB pages, 126 entries per page, plus entry state
+ *            bitmap updates for superseded entries
+ * - journal: one 32-byte record per commit, 128 per sector, sectors erased
+ *            round-robin (main/state_journal.c)
+ *
+ * Build and run from this directory:
+ * @code
+ * cc -O2 -Wall -I../../main flash_wear_sim.c ../../main/nvs_policy.c -o flash_wear_sim
+ * ./flash_wear_sim [years] [profile.txt]
+ * @endcode
+ *
+ * A recorded profile is a text file with one change timestamp per line, in
+ * milliseconds since midnight; it is replayed every simulated day.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "nvs_policy.h"
+
+/**
+ * ============================================================================
+ * SIMULATION PARAMETERS (mirror main/config.h and partitions.csv)
+ * ============================================================================
+ */
+
+#define SIM_TICK_MS                   200        ///< CONFIG_NVS_CHECK_INTERVAL
+#define SIM_FLASH_ENDURANCE           100000u    ///< Erase cycles per sector
+#define SIM_SECTOR_SIZE               4096u
+#define SIM_PAYLOAD_BYTES             5u         ///< bool + uint32 of state
+
+#define SIM_NVS_PAGES                 6u         ///< 0x6000 nvs partition
+#define SIM_NVS_ENTRY_SIZE            32u
+#define SIM_NVS_ENTRIES_PER_PAGE      126u
+#define SIM_NVS_BITMAP_WRITE          4u         ///< Entry state word update
+
+#define SIM_JOURNAL_SECTORS           4u         ///< 0x4000 journal partition
+#define SIM_JOURNAL_RECORD_SIZE       32u
+#define SIM_JOURNAL_RECORDS           128u
+
+#define SIM_MAX_SECTORS               8u
+#define SIM_MAX_EVENTS_PER_DAY        20000u
+
+/**
+ * ============================================================================
+ * SIMULATED BACKENDS
+ * ============================================================================
+ */
+
+typedef enum {
+    BACKEND_NVS,
+    BACKEND_JOURNAL,
+} sim_backend_kind_t;
+
+typedef struct {
+    sim_backend_kind_t kind;
+    const char *name;
+    uint32_t sector_count;
+    uint32_t erase_count[SIM_MAX_SECTORS];
+    uint32_t head_sector;
+    uint32_t head_used;
+    uint64_t bytes_written;
+    uint64_t commits;
+} sim_backend_t;
+
+static void sim_backend_init(sim_backend_t *backend, sim_backend_kind_t kind)
+{
+    memset(backend, 0, sizeof(*backend));
+    backend->kind = kind;
+    backend->name = (kind == BACKEND_NVS) ? "nvs" : "journal";
+    backend->sector_count = (kind == BACKEND_NVS) ? SIM_NVS_PAGES : SIM_JOURNAL_SECTORS;
+}
+
+/**
+ * @brief Advance to the next sector, erasing it
+ */
+static void sim_backend_next_sector(sim_backend_t *backend)
+{
+    backend->head_sector = (backend->head_sector + 1) % backend->sector_count;
+    backend->head_used = 0;
+    backend->erase_count[backend->head_sector]++;
+}
+
+/**
+ * @brief Account for one state commit
+ */
+static void sim_backend_commit(sim_backend_t *backend)
+{
+    backend->commits++;
+
+    if (backend->kind == BACKEND_JOURNAL) {
+        if (backend->head_used >= SIM_JOURNAL_RECORDS) {
+            sim_backend_next_sector(backend);
+        }
+        backend->head_used++;
+        backend->bytes_written += SIM_JOURNAL_RECORD_SIZE;
+        return;
+    }
+
+    // NVS: each key is a fresh entry; the old one gets its bitmap state flipped.
+    // The only live data are the two newest entries, so page reclaim never
+    // has to copy anything and reduces to erasing the next page in the ring.
+    for (int key = 0; key < 2; key++) {
+        if (backend->head_used >= SIM_NVS_ENTRIES_PER_PAGE) {
+            sim_backend_next_sector(backend);
+        }
+        backend->head_used++;
+        backend->bytes_written += SIM_NVS_ENTRY_SIZE + SIM_NVS_BITMAP_WRITE;
+        if (backend->commits > 1) {
+            backend->bytes_written += SIM_NVS_BITMAP_WRITE;
+        }
+    }
+}
+
+/**
+ * ============================================================================
+ * COMMIT POLICIES
+ * ============================================================================
+ */
+
+typedef enum {
+    POLICY_LEGACY_DEBOUNCE,         ///< Fixed 5 s debounce restarted on every change
+    POLICY_ADAPTIVE,                ///< nvs_policy with firmware defaults
+    POLICY_ADAPTIVE_FAST,           ///< nvs_policy tuned for quick saves
+} sim_policy_kind_t;
+
+typedef struct {
+    sim_policy_kind_t kind;
+    const char *name;
+    nvs_policy_t policy;
+    bool pending;
+    uint32_t last_change_ms;
+} sim_policy_t;
+
+static void sim_policy_init(sim_policy_t *sim, sim_policy_kind_t kind, uint32_t commits_per_erase)
+{
+    memset(sim, 0, sizeof(*sim));
+    sim->kind = kind;
+
+    nvs_policy_config_t config = {
+        .idle_ms = 5000,
+        .max_staleness_ms = 60000,
+        .daily_write_budget = 500,
+        .commits_per_erase = commits_per_erase,
+    };
+
+    switch (kind) {
+    case POLICY_LEGACY_DEBOUNCE:
+        sim->name = "debounce-5s";
+        break;
+    case POLICY_ADAPTIVE:
+        sim->name = "adaptive";
+        break;
+    case POLICY_ADAPTIVE_FAST:
+        sim->name = "adaptive-1s";
+        config.idle_ms = 1000;
+        config.max_staleness_ms = 10000;
+        config.daily_write_budget = 2000;
+        break;
+    }
+
+    nvs_policy_init(&sim->policy, &config, 0);
+}
+
+static void sim_policy_note_change(sim_policy_t *sim, uint32_t now_ms)
+{
+    sim->pending = true;
+    sim->last_change_ms = now_ms;
+    nvs_policy_note_change(&sim->policy, now_ms);
+}
+
+static bool sim_policy_poll(sim_policy_t *sim, uint32_t now_ms)
+{
+    if (!sim->pending) {
+        return false;
+    }
+
+    bool commit;
+    if (sim->kind == POLICY_LEGACY_DEBOUNCE) {
+        commit = (now_ms - sim->last_change_ms) >= 5000;
+    } else {
+        commit = nvs_policy_should_commit(&sim->policy, now_ms);
+    }
+
+    if (commit) {
+        sim->pending = false;
+        nvs_policy_note_commit(&sim->policy, now_ms);
+    }
+    return commit;
+}
+
+/**
+ * ============================================================================
+ * USAGE PROFILES
+ * ============================================================================
+ */
+
+typedef struct {
+    const char *name;
+    uint32_t sessions_per_day;      ///< Times per day someone touches the dimmer
+    uint32_t changes_per_session;   ///< Encoder detents per session
+    uint32_t change_spacing_ms;     ///< Typical time between detents
+    uint32_t pause_every;           ///< Pause after this many detents (0 = never)
+    uint32_t pause_ms;              ///< Pause length inside a session
+} sim_profile_t;
+
+static const sim_profile_t SYNTHETIC_PROFILES[] = {
+    { "home",      6,   20, 120,  0,   0 },
+    { "office",   30,   15, 150,  5, 3000 },
+    { "fidget",  200,   40, 100, 10, 7000 },
+};
+
+#define SIM_NUM_SYNTHETIC (sizeof(SYNTHETIC_PROFILES) / sizeof(SYNTHETIC_PROFILES[0]))
+
+static uint32_t sim_rng_state = 0x12345678u;
+
+static uint32_t sim_rand(void)
+{
+    sim_rng_state = sim_rng_state * 1664525u + 1013904223u;
+    return sim_rng_state >> 8;
+}
+
+static int sim_compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Generate one day of change timestamps (ms since midnight)
+ */
+static uint32_t sim_generate_day(const sim_profile_t *profile, uint32_t *events)
+{
+    uint32_t count = 0;
+
+    for (uint32_t s = 0; s < profile->sessions_per_day; s++) {
+        uint32_t t = sim_rand() % (NVS_POLICY_DAY_MS - 600000u);
+        for (uint32_t c = 0; c < profile->changes_per_session && count < SIM_MAX_EVENTS_PER_DAY; c++) {
+            events[count++] = t;
+            t += profile->change_spacing_ms / 2 + sim_rand() % profile->change_spacing_ms;
+            if (profile->pause_every && (c + 1) % profile->pause_every == 0) {
+                t += profile->pause_ms / 2 + sim_rand() % profile->pause_ms;
+            }
+        }
+    }
+
+    qsort(events, count, sizeof(uint32_t), sim_compare_u32);
+    return count;
+}
+
+/**
+ * @brief Load a recorded day profile
+ */
+static uint32_t sim_load_day(const char *path, uint32_t *events)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot open profile %s\n", path);
+        exit(1);
+    }
+
+    uint32_t count = 0;
+    unsigned long value;
+    while (count < SIM_MAX_EVENTS_PER_DAY && fscanf(file, "%lu", &value) == 1) {
+        events[count++] = (uint32_t)(value % NVS_POLICY_DAY_MS);
+    }
+    fclose(file);
+
+    qsort(events, count, sizeof(uint32_t), sim_compare_u32);
+    return count;
+}
+
+/**
+ * ============================================================================
+ * SIMULATION RUN
+ * ============================================================================
+ */
+
+typedef struct {
+    const char *policy_name;
+    const char *backend_name;
+    uint64_t commits;
+    uint64_t changes;
+    uint64_t bytes_written;
+    uint64_t total_erases;
+    uint32_t worst_sector_erases;
+    double lifetime_years;
+} sim_result_t;
+
+/**
+ * @brief Run one profile through one policy/backend combination
+ *
+ * The policy is only polled on SIM_TICK_MS boundaries while a change is
+ * pending, exactly like the firmware main loop; idle stretches are skipped.
+ */
+static void sim_run(const sim_profile_t *profile, const char *recorded, uint32_t days,
+                    sim_policy_kind_t policy_kind, sim_backend_kind_t backend_kind,
+                    sim_result_t *result)
+{
+    static uint32_t events[SIM_MAX_EVENTS_PER_DAY];
+    sim_backend_t backend;
+    sim_policy_t policy;
+
+    sim_backend_init(&backend, backend_kind);
+    sim_policy_init(&policy, policy_kind,
+                    backend_kind == BACKEND_JOURNAL ? SIM_JOURNAL_RECORDS
+                                                    : SIM_NVS_ENTRIES_PER_PAGE / 2);
+    sim_rng_state = 0x12345678u;
+
+    uint32_t recorded_count = recorded ? sim_load_day(recorded, events) : 0;
+    memset(result, 0, sizeof(*result));
+
+    // Policy time is a wrapping 32-bit millisecond counter, as on target
+    uint32_t clock_ms = 0;
+
+    for (uint32_t day = 0; day < days; day++) {
+        uint32_t count = recorded ? recorded_count : sim_generate_day(profile, events);
+        uint32_t day_start = clock_ms;
+        uint32_t tick = day_start;
+
+        for (uint32_t i = 0; i <= count; i++) {
+            uint32_t next = (i < count) ? day_start + events[i] : day_start + NVS_POLICY_DAY_MS;
+
+            // Poll pending writes up to the next event
+            while (policy.pending && (int32_t)(next - tick) > 0) {
+                if (sim_policy_poll(&policy, tick)) {
+                    sim_backend_commit(&backend);
+                }
+                tick += SIM_TICK_MS;
+            }
+            // Nothing pending: skip ahead to the first check tick at or after the event
+            if ((int32_t)(next - tick) > 0) {
+                tick = next + (SIM_TICK_MS - (next - day_start) % SIM_TICK_MS) % SIM_TICK_MS;
+            }
+
+            if (i < count) {
+                sim_policy_note_change(&policy, next);
+                result->changes++;
+            }
+        }
+
+        clock_ms = day_start + NVS_POLICY_DAY_MS;
+    }
+
+    result->policy_name = policy.name;
+    result->backend_name = backend.name;
+    result->commits = backend.commits;
+    result->bytes_written = backend.bytes_written;
+    for (uint32_t s = 0; s < backend.sector_count; s++) {
+        result->total_erases += backend.erase_count[s];
+        if (backend.erase_count[s] > result->worst_sector_erases) {
+            result->worst_sector_erases = backend.erase_count[s];
+        }
+    }
+
+    double years = days / 365.0;
+    double worst_per_year = result->worst_sector_erases / years;
+    result->lifetime_years = worst_per_year > 0.0 ? SIM_FLASH_ENDURANCE / worst_per_year : 1e9;
+}
+
+static void sim_print_header(void)
+{
+    printf("%-10s %-12s %-8s %10s %10s %12s %8s %10s %10s %12s\n",
+           "profile", "policy", "backend", "changes", "commits", "bytes", "WA",
+           "erases", "worst", "life[years]");
+}
+
+static void sim_print_result(const char *profile, const char *policy, const char *backend,
+                             const sim_result_t *result)
+{
+    double wa = result->commits ?
+                (double)result->bytes_written / (double)(result->commits * SIM_PAYLOAD_BYTES) : 0.0;
+
+    printf("%-10s %-12s %-8s %10llu %10llu %12llu %8.1f %10llu %10u %12.0f\n",
+           profile, policy, backend,
+           (unsigned long long)result->changes, (unsigned long long)result->commits,
+           (unsigned long long)result->bytes_written, wa,
+           (unsigned long long)result->total_erases, result->worst_sector_erases,
+           result->lifetime_years);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t years = (argc > 1) ? (uint32_t)atoi(argv[1]) : 5;
+    const char *recorded = (argc > 2) ? argv[2] : NULL;
+    uint32_t days = years * 365;
+
+    if (days == 0) {
+        fprintf(stderr, "usage: %s [years] [profile.txt]\n", argv[0]);
+        return 1;
+    }
+
+    printf("Flash wear simulation: %u years, %u erase cycles/sector endurance\n\n",
+           years, SIM_FLASH_ENDURANCE);
+    sim_print_header();
+
+    const sim_policy_kind_t policies[] = {
+        POLICY_LEGACY_DEBOUNCE, POLICY_ADAPTIVE, POLICY_ADAPTIVE_FAST
+    };
+    const sim_backend_kind_t backends[] = { BACKEND_NVS, BACKEND_JOURNAL };
+    uint32_t profile_count = recorded ? 1 : SIM_NUM_SYNTHETIC;
+
+    for (uint32_t p = 0; p < profile_count; p++) {
+        const sim_profile_t *profile = recorded ? NULL : &SYNTHETIC_PROFILES[p];
+        const char *profile_name = recorded ? "recorded" : profile->name;
+
+        for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); i++) {
+            for (size_t j = 0; j < sizeof(backends) / sizeof(backends[0]); j++) {
+                sim_result_t result;
+
+                sim_run(profile, recorded, days, policies[i], backends[j], &result);
+                sim_print_result(profile_name, result.policy_name, result.backend_name, &result);
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,233 @@
+/**
+ * @file ledc_alloc.c
+ * @brief Host-side checks of the LEDC timer and channel planner
+ *
+ * Runs main/ledc_alloc.c on the ESP32 clock list and checks:
+ *
+ * - shared: groups at one frequency share a timer, with consecutive channels
+ * - packing: timers go onto both speed modes, largest first, filling all
+ *   sixteen channels
+ * - timers: eight frequencies use all eight timers; a fifth frequency on
+ *   high speed clocks only is reported as LEDC_ALLOC_NO_TIMER
+ * - channels: nine channels at one frequency, or a group too large for the
+ *   space left in either mode, are reported as LEDC_ALLOC_NO_CHANNEL
+ * - resolution: a minimum resolution above what the fastest clock gives,
+ *   or a frequency above half of it, is reported as
+ *   LEDC_ALLOC_NO_RESOLUTION without taking a timer or channels
+ * - limits: more than LEDC_ALLOC_MAX_GROUPS groups are refused
+ *
+ * Build and run from this directory:
+ * @code
+ * cc -O2 -Wall -I../../main ledc_alloc.c ../../main/ledc_alloc.c -o ledc_alloc
+ * ./ledc_alloc
+ * @endcode
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "ledc_alloc.h"
+
+/** Same clock list as main/output_ledc.c */
+static const ledc_alloc_clock_t CLOCKS[] = {
+    { "APB",      80000000, 0x3 },
+    { "RC_FAST",  8000000,  0x2 },
+    { "REF_TICK", 1000000,  0x3 },
+};
+
+/** APB and REF_TICK restricted to high speed mode */
+static const ledc_alloc_clock_t HIGH_SPEED_CLOCKS[] = {
+    { "APB",      80000000, 0x1 },
+    { "REF_TICK", 1000000,  0x1 },
+};
+
+#define CLOCK_COUNT                   (sizeof(CLOCKS) / sizeof(CLOCKS[0]))
+#define HIGH_SPEED_CLOCK_COUNT        (sizeof(HIGH_SPEED_CLOCKS) / sizeof(HIGH_SPEED_CLOCKS[0]))
+
+static int sim_check(const char *name, bool ok, const char *detail)
+{
+    printf("%-11s %-5s %s\n", name, ok ? "ok" : "FAIL", detail);
+    return ok ? 0 : 1;
+}
+
+/** Placement of every group as "mode/timer/first channel" or its status */
+static void sim_describe(const ledc_alloc_group_t *groups, uint32_t count, char *out, size_t size)
+{
+    size_t used = 0;
+
+    out[0] = '\0';
+    for (uint32_t i = 0; i < count && used < size; i++) {
+        if (groups[i].status == LEDC_ALLOC_OK) {
+            used += snprintf(out + used, size - used, "%s%lu/%lu/%lu", i ? " " : "",
+                             (unsigned long)groups[i].mode, (unsigned long)groups[i].timer,
+                             (unsigned long)groups[i].first_channel);
+        } else {
+            used += snprintf(out + used, size - used, "%s[%s]", i ? " " : "",
+                             ledc_alloc_status_name(groups[i].status));
+        }
+    }
+}
+
+/** Whether a group was placed in mode on timer from first_channel */
+static bool sim_placed(const ledc_alloc_group_t *group, uint32_t mode, uint32_t timer,
+                       uint32_t first_channel)
+{
+    return group->status == LEDC_ALLOC_OK && group->mode == mode && group->timer == timer &&
+           group->first_channel == first_channel;
+}
+
+static int sim_shared(void)
+{
+    const ledc_alloc_request_t requests[] = {
+        { 5000, 13, 3 },
+        { 25000, 11, 1 },
+        { 5000, 10, 2 },
+    };
+    ledc_alloc_group_t groups[3];
+    int result = ledc_alloc_plan(CLOCKS, CLOCK_COUNT, requests, 3, groups);
+
+    char detail[160];
+    sim_describe(groups, 3, detail, sizeof(detail));
+    return sim_check("shared", result == 0 && sim_placed(&groups[0], 0, 0, 0) &&
+                     sim_placed(&groups[2], 0, 0, 3) && sim_placed(&groups[1], 0, 1, 5) &&
+                     groups[0].bits == 13 && groups[0].actual_hz == 5000 &&
+                     groups[1].bits == 11, detail);
+}
+
+static int sim_packing(void)
+{
+    const ledc_alloc_request_t requests[] = {
+        { 3000, 8, 2 },
+        { 1000, 8, 6 },
+        { 4000, 8, 2 },
+        { 2000, 8, 6 },
+    };
+    ledc_alloc_group_t groups[4];
+    int result = ledc_alloc_plan(CLOCKS, CLOCK_COUNT, requests, 4, groups);
+
+    // 6 @ 1 kHz, then 6 @ 2 kHz no longer fits high speed, then the pairs fill up
+    char detail[160];
+    sim_describe(groups, 4, detail, sizeof(detail));
+    return sim_check("packing", result == 0 && sim_placed(&groups[1], 0, 0, 0) &&
+                     sim_placed(&groups[3], 1, 0, 0) && sim_placed(&groups[0], 0, 1, 6) &&
+                     sim_placed(&groups[2], 1, 1, 6), detail);
+}
+
+static int sim_timers(void)
+{
+    ledc_alloc_request_t requests[LEDC_ALLOC_MAX_GROUPS];
+    ledc_alloc_group_t groups[LEDC_ALLOC_MAX_GROUPS];
+    bool all_placed = true;
+    uint32_t timer_mask[LEDC_ALLOC_MODES] = {0};
+
+    for (uint32_t i = 0; i < LEDC_ALLOC_MAX_GROUPS; i++) {
+        requests[i] = (ledc_alloc_request_t){ 1000 * (i + 1), 8, 1 };
+    }
+    int result = ledc_alloc_plan(CLOCKS, CLOCK_COUNT, requests, LEDC_ALLOC_MAX_GROUPS, groups);
+    for (uint32_t i = 0; i < LEDC_ALLOC_MAX_GROUPS; i++) {
+        if (groups[i].status != LEDC_ALLOC_OK) {
+            all_placed = false;
+            continue;
+        }
+        timer_mask[groups[i].mode] |= 1u << groups[i].timer;
+    }
+    bool all_timers = timer_mask[0] == 0xF && timer_mask[1] == 0xF;
+
+    // Only four high speed timers: the fifth frequency is left without one
+    ledc_alloc_group_t high[5];
+    int high_result = ledc_alloc_plan(HIGH_SPEED_CLOCKS, HIGH_SPEED_CLOCK_COUNT, requests, 5,
+                                      high);
+
+    char detail[160];
+    sim_describe(high, 5, detail, sizeof(detail));
+    return sim_check("timers", result == 0 && all_placed && all_timers && high_result == -1 &&
+                     sim_placed(&high[3], 0, 3, 3) && high[4].status == LEDC_ALLOC_NO_TIMER,
+                     detail);
+}
+
+static int sim_channels(void)
+{
+    const ledc_alloc_request_t nine[] = {
+        { 5000, 10, 5 },
+        { 5000, 10, 4 },
+    };
+    ledc_alloc_group_t nine_groups[2];
+    int nine_result = ledc_alloc_plan(CLOCKS, CLOCK_COUNT, nine, 2, nine_groups);
+
+    // 5 + 5 fill both modes to 5, then 4 fits in neither
+    const ledc_alloc_request_t left[] = {
+        { 1000, 8, 5 },
+        { 2000, 8, 5 },
+        { 3000, 8, 4 },
+        { 4000, 8, 3 },
+    };
+    ledc_alloc_group_t left_groups[4];
+    int left_result = ledc_alloc_plan(CLOCKS, CLOCK_COUNT, left, 4, left_groups);
+
+    char detail[160];
+    char placed[96];
+    sim_describe(left_groups, 4, placed, sizeof(placed));
+    snprintf(detail, sizeof(detail), "9 @ 5 kHz: %s / %s; %s",
+             ledc_alloc_status_name(nine_groups[0].status),
+             ledc_alloc_status_name(nine_groups[1].status), placed);
+    return sim_check("channels", nine_result == -1 &&
+                     nine_groups[0].status == LEDC_ALLOC_NO_CHANNEL &&
+                     nine_groups[1].status == LEDC_ALLOC_NO_CHANNEL && left_result == -1 &&
+                     sim_placed(&left_groups[0], 0, 0, 0) &&
+                     sim_placed(&left_groups[1], 1, 0, 0) &&
+                     left_groups[2].status == LEDC_ALLOC_NO_CHANNEL &&
+                     sim_placed(&left_groups[3], 0, 1, 5), detail);
+}
+
+static int sim_resolution(void)
+{
+    const ledc_alloc_request_t requests[] = {
+        { 25000, 12, 2 },           // APB gives 11 bits at 25 kHz
+        { 50000000, 1, 1 },         // Above half the fastest clock
+        { 5000, 13, 2 },
+    };
+    ledc_alloc_group_t groups[3];
+    int result = ledc_alloc_plan(CLOCKS, CLOCK_COUNT, requests, 3, groups);
+
+    // The failed groups leave timer 0 and channel 0 to the one that fits
+    char detail[160];
+    sim_describe(groups, 3, detail, sizeof(detail));
+    return sim_check("resolution", result == -1 &&
+                     groups[0].status == LEDC_ALLOC_NO_RESOLUTION &&
+                     groups[1].status == LEDC_ALLOC_NO_RESOLUTION &&
+                     sim_placed(&groups[2], 0, 0, 0) &&
+                     ledc_alloc_max_bits(80000000, 25000, NULL) == 11, detail);
+}
+
+static int sim_limits(void)
+{
+    ledc_alloc_request_t requests[LEDC_ALLOC_MAX_GROUPS + 1];
+    ledc_alloc_group_t groups[LEDC_ALLOC_MAX_GROUPS + 1];
+
+    for (uint32_t i = 0; i <= LEDC_ALLOC_MAX_GROUPS; i++) {
+        requests[i] = (ledc_alloc_request_t){ 5000, 8, 1 };
+    }
+    int result = ledc_alloc_plan(CLOCKS, CLOCK_COUNT, requests, LEDC_ALLOC_MAX_GROUPS + 1,
+                                 groups);
+
+    char detail[64];
+    snprintf(detail, sizeof(detail), "%d groups: %d", LEDC_ALLOC_MAX_GROUPS + 1, result);
+    return sim_check("limits", result == -1, detail);
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    failures += sim_shared();
+    failures += sim_packing();
+    failures += sim_timers();
+    failures += sim_channels();
+    failures += sim_resolution();
+    failures += sim_limits();
+
+    return failures ? 1 : 0;
+}
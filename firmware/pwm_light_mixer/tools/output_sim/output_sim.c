@@ -0,0 +1,384 @@
+/**
+ * @file output_sim.c
+ * @brief Host-side output scheduler simulation
+ *
+ * Registers recording drivers (main/output_recording.c) that stand in for
+ * the LEDC, PCA9685 and WS2812 outputs with the firmware scheduler
+ * (main/output_scheduler.c), stages a scripted brightness sequence and
+ * services deferred commits exactly when the scheduler asks for them, the
+ * way the one-shot esp_timer in main/output.c does.
+ *
+ * The bus-bound outputs report some commits as still pending, as the real
+ * backends do while their bus is busy, so the scheduler's retry is part of
+ * the run.
+ *
+ * Reports per output how many frames were committed, how many staged
+ * frames were replaced before reaching the bus, how many commits were
+ * deferred, the worst stage-to-commit latency and the shortest commit
+ * interval, and checks that every output ends on the last staged frame.
+ *
+ * The LEDC commits are then replayed into the LEDC model
+ * (main/ledc_model.c) for the light waveform of each channel, quantized to
+ * the timer resolution and latched at timer overflow, and scored with
+ * main/flicker_metrics.c: percent flicker, flicker index, SVM and visible
+ * fade steps.
+ *
+ * Finally a slow, dim soft-start fade under a daylight trim is built the
+ * way pwm_controller builds frames, once truncated to 8-bit duties before
+ * the 16-bit frame (as it used to) and once at 16 bits throughout, and the
+ * fade steps of both light outputs are compared.
+ *
+ * Build and run from this directory:
+ * @code
+ * cc -O2 -Wall -I../../main output_sim.c ../../main/output_scheduler.c \
+ *     ../../main/output_recording.c ../../main/flicker_metrics.c \
+ *     ../../main/ledc_model.c -lm -o output_sim
+ * ./output_sim [stage interval in us]
+ * @endcode
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "output_scheduler.h"
+#include "output_recording.h"
+#include "flicker_metrics.h"
+#include "ledc_model.h"
+
+/**
+ * ============================================================================
+ * SIMULATION PARAMETERS (mirror main/config.h)
+ * ============================================================================
+ */
+
+#define SIM_DEFAULT_INTERVAL_US       2000       ///< Fast encoder spin
+#define SIM_RAMP_STEPS                256        ///< One full-range sweep
+#define SIM_IDLE_US                   50000      ///< Quiet time after the sweep
+#define SIM_CHANNELS                  2
+#define SIM_PWM_HZ                    5000       ///< CONFIG_LEDC_FREQUENCY
+#define SIM_PWM_BITS                  13         ///< LEDC resolution at 5 kHz
+#define SIM_LEDC_CLOCK_HZ             80000000   ///< APB clock
+#define SIM_LEDC_DIVIDER_Q8           500        ///< 80 MHz / (1.953 x 8192) = 5 kHz
+#define SIM_MAX_LEDC_COMMITS          4096
+#define SIM_SVM_LIMIT                 1.0        ///< Just visible
+#define SIM_FADE_FROM                 10         ///< Fade start, 0..255 API duty
+#define SIM_FADE_TO                   40         ///< Fade end
+#define SIM_FADE_MS                   1500       ///< CONFIG_SOFTSTART_RAMP_MS
+#define SIM_FADE_STEP_MS              10         ///< CONFIG_SOFTSTART_STEP_MS
+#define SIM_FADE_SCALE_Q16            52429      ///< 80 % master scale (daylight trim)
+
+static int64_t sim_now_us;
+
+static int64_t sim_clock(void *arg)
+{
+    return sim_now_us;
+}
+
+typedef struct {
+    const char *name;
+    output_caps_t caps;
+    uint32_t defer_every;           ///< Every Nth commit finds the bus busy
+} sim_output_t;
+
+static const sim_output_t SIM_OUTPUTS[] = {
+    { "ledc",    { .channel_count = 2,  .resolution_bits = SIM_PWM_BITS, .max_refresh_hz = 0 }, 0 },
+    { "pca9685", { .channel_count = 32, .resolution_bits = 12, .max_refresh_hz = 200 }, 2 },
+    { "ws2812",  { .channel_count = 180, .resolution_bits = 8, .max_refresh_hz = 100 }, 3 },
+};
+
+#define SIM_OUTPUT_COUNT              (sizeof(SIM_OUTPUTS) / sizeof(SIM_OUTPUTS[0]))
+
+// Every LEDC commit, for rebuilding the light waveform
+static output_record_t ledc_commits[SIM_MAX_LEDC_COMMITS];
+static uint32_t ledc_commit_count;
+
+static void sim_ledc_listener(void *arg, const output_record_t *record)
+{
+    if (ledc_commit_count < SIM_MAX_LEDC_COMMITS) {
+        ledc_commits[ledc_commit_count++] = *record;
+    }
+}
+
+typedef struct {
+    flicker_edge_t *edges;
+    uint32_t count;
+    uint32_t capacity;
+} sim_waveform_t;
+
+static void sim_waveform_sink(void *arg, int64_t time_ps, bool level)
+{
+    sim_waveform_t *waveform = arg;
+
+    if (waveform->count < waveform->capacity) {
+        waveform->edges[waveform->count++] =
+            (flicker_edge_t){ time_ps / 1000, level ? 1.0f : 0.0f };
+    }
+}
+
+/**
+ * @brief Light waveform of each LEDC channel, replaying its commits into the LEDC model
+ *
+ * Each commit writes the duty to the shadow registers and requests an update,
+ * as output_ledc does, so it takes effect at the next timer overflow.
+ */
+static int sim_ledc_waveform(sim_waveform_t *waveforms, int64_t end_ns)
+{
+    static ledc_model_t model;
+    const uint32_t counts = 1u << SIM_PWM_BITS;
+
+    ledc_model_init(&model);
+    for (uint32_t ch = 0; ch < SIM_CHANNELS; ch++) {
+        // Dark until the first commit
+        waveforms[ch].edges[0] = (flicker_edge_t){ 0, 0.0f };
+        waveforms[ch].count = 1;
+        ledc_model_channel_config(&model, 0, ch, 0, 0, 0, sim_waveform_sink, &waveforms[ch]);
+    }
+    if (ledc_model_timer_config(&model, 0, 0, SIM_LEDC_CLOCK_HZ, SIM_LEDC_DIVIDER_Q8,
+                                SIM_PWM_BITS) != 0) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < ledc_commit_count; i++) {
+        ledc_model_run(&model, ledc_commits[i].time_us * 1000000);
+        for (uint32_t ch = 0; ch < SIM_CHANNELS; ch++) {
+            uint32_t duty = (uint32_t)(((uint64_t)ledc_commits[i].duty[ch] * (counts - 1) +
+                                        32767) / 65535);
+            ledc_model_set_duty(&model, 0, ch, 0, duty << LEDC_MODEL_FRACTION_BITS);
+            ledc_model_update(&model, 0, ch);
+        }
+    }
+    ledc_model_run(&model, end_ns * 1000);
+
+    return 0;
+}
+
+/**
+ * @brief Allocate edge buffers for every LEDC channel up to end_ns
+ */
+static int sim_waveform_alloc(sim_waveform_t *waveforms, int64_t end_ns)
+{
+    const int64_t period_ns = 1000000000 / SIM_PWM_HZ;
+
+    for (uint32_t ch = 0; ch < SIM_CHANNELS; ch++) {
+        waveforms[ch].capacity = (uint32_t)(2 * (end_ns / period_ns) + 4);
+        waveforms[ch].edges = malloc(waveforms[ch].capacity * sizeof(flicker_edge_t));
+        if (waveforms[ch].edges == NULL) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void sim_waveform_free(sim_waveform_t *waveforms)
+{
+    for (uint32_t ch = 0; ch < SIM_CHANNELS; ch++) {
+        free(waveforms[ch].edges);
+    }
+}
+
+/**
+ * @brief Fade steps of the soft-start fade, frames built as pwm_controller does
+ *
+ * @param wide false to truncate to 8-bit duties before the frame (the old
+ *             path), true to keep requests, ramp and scale at 16 bits
+ */
+static int sim_fade(bool wide, flicker_result_t *result)
+{
+    const uint32_t steps = SIM_FADE_MS / SIM_FADE_STEP_MS;
+    const int64_t period_ns = 1000000000 / SIM_PWM_HZ;
+
+    ledc_commit_count = 0;
+    for (uint32_t step = 0; step <= steps; step++) {
+        output_record_t *record = &ledc_commits[ledc_commit_count++];
+        uint32_t level;
+
+        if (wide) {
+            uint32_t from = SIM_FADE_FROM * 257u;
+            uint32_t to = SIM_FADE_TO * 257u;
+            uint32_t requested = from + (to - from) * step / steps;
+            level = (uint32_t)(((uint64_t)requested * SIM_FADE_SCALE_Q16) >> 16);
+        } else {
+            uint32_t requested = SIM_FADE_FROM + (SIM_FADE_TO - SIM_FADE_FROM) * step / steps;
+            uint32_t duty = (uint32_t)(((uint64_t)requested * SIM_FADE_SCALE_Q16) >> 16);
+            level = (duty * 65535u) / 255;
+        }
+
+        memset(record, 0, sizeof(*record));
+        record->time_us = (int64_t)step * SIM_FADE_STEP_MS * 1000;
+        for (uint32_t ch = 0; ch < SIM_CHANNELS; ch++) {
+            record->duty[ch] = (uint16_t)level;
+        }
+    }
+
+    int64_t end_ns = ((int64_t)(SIM_FADE_MS + SIM_FADE_STEP_MS) * 1000000 / period_ns) * period_ns;
+    sim_waveform_t waveforms[SIM_CHANNELS];
+    flicker_config_t config;
+    int ret = -1;
+
+    flicker_metrics_default_config(&config);
+    if (sim_waveform_alloc(waveforms, end_ns) == 0 && sim_ledc_waveform(waveforms, end_ns) == 0 &&
+        flicker_metrics_analyze(waveforms[0].edges, waveforms[0].count, end_ns, &config,
+                                result) == 0) {
+        ret = 0;
+    }
+    sim_waveform_free(waveforms);
+    return ret;
+}
+
+/**
+ * @brief Run deferred commits due up to a time, advancing the clock
+ */
+static void sim_run_until(output_scheduler_t *scheduler, int64_t *next_us, int64_t until_us)
+{
+    while (*next_us <= until_us) {
+        sim_now_us = *next_us;
+        output_scheduler_service(scheduler, sim_now_us, next_us);
+    }
+    sim_now_us = until_us;
+}
+
+int main(int argc, char **argv)
+{
+    int64_t interval_us = (argc > 1) ? atol(argv[1]) : SIM_DEFAULT_INTERVAL_US;
+    if (interval_us <= 0) {
+        fprintf(stderr, "Invalid interval\n");
+        return 1;
+    }
+
+    static output_recording_t recordings[SIM_OUTPUT_COUNT];
+    output_scheduler_t scheduler;
+    output_scheduler_init(&scheduler);
+
+    for (uint32_t i = 0; i < SIM_OUTPUT_COUNT; i++) {
+        output_recording_init(&recordings[i], SIM_OUTPUTS[i].name, &SIM_OUTPUTS[i].caps,
+                              sim_clock, NULL);
+        if (i == 0) {
+            output_recording_set_listener(&recordings[i], sim_ledc_listener, NULL);
+        }
+        output_recording_set_defer(&recordings[i], SIM_OUTPUTS[i].defer_every);
+        if (output_scheduler_register(&scheduler, &recordings[i].driver, 0) < 0) {
+            fprintf(stderr, "Failed to register %s\n", SIM_OUTPUTS[i].name);
+            return 1;
+        }
+    }
+
+    // Sweep both channels in opposite directions, one frame per interval
+    uint16_t frame[SIM_CHANNELS] = {0};
+    int64_t next_us = OUTPUT_SCHEDULER_IDLE;
+
+    for (uint32_t step = 0; step < SIM_RAMP_STEPS; step++) {
+        sim_run_until(&scheduler, &next_us, (int64_t)step * interval_us);
+
+        frame[0] = (uint16_t)((step * 65535u) / (SIM_RAMP_STEPS - 1));
+        frame[1] = (uint16_t)(65535u - frame[0]);
+        output_scheduler_stage(&scheduler, frame, SIM_CHANNELS, sim_now_us, &next_us);
+    }
+
+    sim_run_until(&scheduler, &next_us, sim_now_us + SIM_IDLE_US);
+
+    printf("%u frames staged, one every %lld us\n\n", SIM_RAMP_STEPS, (long long)interval_us);
+    printf("%-8s %7s %7s %7s %8s %12s %14s %6s\n", "output", "rate", "frames", "skipped",
+           "deferred", "latency[us]", "min gap[us]", "final");
+
+    int failures = 0;
+    for (uint32_t i = 0; i < SIM_OUTPUT_COUNT; i++) {
+        const output_slot_t *slot = &scheduler.slots[i];
+        const output_recording_t *recording = &recordings[i];
+        const output_record_t *last = output_recording_get(recording, 0);
+        bool final_ok = (last != NULL && last->duty[0] == frame[0] && last->duty[1] == frame[1]);
+
+        int64_t min_gap_us = INT64_MAX;
+        for (uint32_t age = 0; age + 1 < OUTPUT_RECORDING_DEPTH; age++) {
+            const output_record_t *newer = output_recording_get(recording, age);
+            const output_record_t *older = output_recording_get(recording, age + 1);
+            if (older == NULL) {
+                break;
+            }
+            if (newer->time_us - older->time_us < min_gap_us) {
+                min_gap_us = newer->time_us - older->time_us;
+            }
+        }
+
+        char rate[16];
+        if (slot->caps.max_refresh_hz == 0) {
+            snprintf(rate, sizeof(rate), "now");
+        } else {
+            snprintf(rate, sizeof(rate), "%luHz", (unsigned long)slot->caps.max_refresh_hz);
+        }
+
+        printf("%-8s %7s %7lu %7lu %8lu %12lu %14lld %6s\n", slot->driver->name, rate,
+               (unsigned long)slot->stats.frames, (unsigned long)slot->stats.skipped,
+               (unsigned long)slot->stats.deferred, (unsigned long)slot->stats.max_latency_us,
+               (long long)((min_gap_us == INT64_MAX) ? 0 : min_gap_us),
+               final_ok ? "ok" : "STALE");
+        if (!final_ok || (slot->period_us > 0 && min_gap_us < slot->period_us)) {
+            failures++;
+        }
+    }
+
+    // Flicker of the LEDC light output over the whole run
+    flicker_config_t flicker_config;
+    flicker_metrics_default_config(&flicker_config);
+
+    printf("\nledc light output, %u Hz %u-bit, %u ms step windows\n", SIM_PWM_HZ, SIM_PWM_BITS,
+           flicker_config.step_window_us / 1000);
+    printf("%-8s %6s %9s %7s %7s %7s %8s %9s\n", "channel", "mean", "flicker%", "index", "svm",
+           "steps", "visible", "max step");
+
+    const int64_t period_ns = 1000000000 / SIM_PWM_HZ;
+    int64_t end_ns = ((sim_now_us * 1000) / period_ns) * period_ns;
+    sim_waveform_t waveforms[SIM_CHANNELS];
+    if (sim_waveform_alloc(waveforms, end_ns) != 0) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    if (sim_ledc_waveform(waveforms, end_ns) != 0) {
+        fprintf(stderr, "Invalid LEDC timer\n");
+        return 1;
+    }
+
+    for (uint32_t ch = 0; ch < SIM_CHANNELS; ch++) {
+        flicker_result_t flicker;
+
+        if (flicker_metrics_analyze(waveforms[ch].edges, waveforms[ch].count, end_ns,
+                                    &flicker_config, &flicker) != 0) {
+            printf("%-8u %s\n", ch, "analysis failed");
+            failures++;
+            continue;
+        }
+
+        printf("%-8u %6.3f %9.1f %7.3f %7.3f %7lu %8lu %8.1f%%\n", ch, flicker.mean_level,
+               flicker.percent_flicker, flicker.flicker_index, flicker.svm,
+               (unsigned long)flicker.steps, (unsigned long)flicker.visible_steps,
+               100.0 * flicker.max_step);
+        if (flicker.svm >= SIM_SVM_LIMIT) {
+            failures++;
+        }
+    }
+
+    sim_waveform_free(waveforms);
+
+    // Soft-start fade at 8 and 16 bits through the output stages
+    printf("\nfade %u->%u of 255 over %u ms at %u%% scale\n", SIM_FADE_FROM, SIM_FADE_TO,
+           SIM_FADE_MS, (unsigned)((SIM_FADE_SCALE_Q16 * 100u + 32768u) >> 16));
+    printf("%-8s %7s %8s %9s\n", "frames", "steps", "visible", "max step");
+
+    flicker_result_t fades[2];
+    for (int wide = 0; wide <= 1; wide++) {
+        if (sim_fade(wide, &fades[wide]) != 0) {
+            fprintf(stderr, "Fade analysis failed\n");
+            return 1;
+        }
+        printf("%-8s %7lu %8lu %8.1f%%\n", wide ? "16-bit" : "8-bit",
+               (unsigned long)fades[wide].steps, (unsigned long)fades[wide].visible_steps,
+               100.0 * fades[wide].max_step);
+    }
+    if (fades[1].max_step >= fades[0].max_step) {
+        failures++;
+    }
+
+    return failures ? 1 : 0;
+}
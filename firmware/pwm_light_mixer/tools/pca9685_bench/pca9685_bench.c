@@ -0,0 +1,286 @@
+/**
+ * @file pca9685_bench.c
+ * @brief Host-side PCA9685 frame rate benchmark on a mock I2C bus
+ *
+ * Packs frames with the firmware packer (main/pca9685_frame.c) and sends
+ * them to a mock bus that models I2C timing (9 bit times per byte plus
+ * start/stop, and a fixed driver cost per transaction) and the chips'
+ * auto-increment register file. Every frame is decoded back from the mock
+ * registers and checked against the staged duties.
+ *
+ * Reports frames per second against channel count for three update
+ * patterns (all channels fading, 25% of channels changing, one channel)
+ * and three write strategies (one transaction per channel, bursts, bursts
+ * bridging gaps of up to 2 clean channels), at 400 kHz and 1 MHz.
+ *
+ * First checks bus error recovery as main/pca9685.c does it: after a frame
+ * is lost and the chips are left with garbage, marking every channel dirty
+ * must bring the register file back to the newest staged duties.
+ *
+ * Build and run from this directory:
+ * @code
+ * cc -O2 -Wall -I../../main pca9685_bench.c ../../main/pca9685_frame.c -o pca9685_bench
+ * ./pca9685_bench [transaction overhead in us]
+ * @endcode
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "pca9685_frame.h"
+
+/**
+ * ============================================================================
+ * MOCK BUS
+ * ============================================================================
+ */
+
+#define BENCH_FRAMES                  200
+#define BENCH_START_STOP_BITS         2
+#define BENCH_DEFAULT_OVERHEAD_US     25.0       ///< Async queue + ISR cost per transaction
+
+typedef struct {
+    uint32_t scl_hz;
+    double overhead_us;
+    double busy_us;                 ///< Accumulated bus + driver time
+    uint32_t transactions;
+    uint8_t regs[PCA9685_MAX_CHIPS][256];
+} mock_bus_t;
+
+/**
+ * @brief Account one write transaction and apply it to the register file
+ */
+static void mock_bus_write(mock_bus_t *bus, uint8_t chip, const uint8_t *data, uint32_t length)
+{
+    uint32_t bits = BENCH_START_STOP_BITS + 9 * (1 + length);   // address byte + payload
+
+    bus->busy_us += bits * 1e6 / bus->scl_hz + bus->overhead_us;
+    bus->transactions++;
+
+    // MODE1.AI: pointer advances after every data byte
+    uint8_t pointer = data[0];
+    for (uint32_t i = 1; i < length; i++) {
+        bus->regs[chip][pointer++] = data[i];
+    }
+}
+
+/**
+ * @brief Decode a channel's duty from the mock register file
+ */
+static uint16_t mock_bus_duty(const mock_bus_t *bus, uint32_t channel)
+{
+    const uint8_t *reg = &bus->regs[channel / PCA9685_CHANNELS_PER_CHIP]
+                                   [PCA9685_REG_LED0_ON_L + 4 * (channel % PCA9685_CHANNELS_PER_CHIP)];
+
+    if (reg[3] & 0x10) {
+        return 0;
+    }
+    if (reg[1] & 0x10) {
+        return PCA9685_DUTY_MAX;
+    }
+    uint32_t on = reg[0] | ((reg[1] & 0x0F) << 8);
+    uint32_t off = reg[2] | ((reg[3] & 0x0F) << 8);
+    return (uint16_t)((off - on) & 0x0FFF);
+}
+
+/**
+ * ============================================================================
+ * SCENARIOS
+ * ============================================================================
+ */
+
+typedef enum {
+    PATTERN_FADE,                   ///< Every channel changes every frame
+    PATTERN_SPARSE,                 ///< A random quarter of the channels change
+    PATTERN_SINGLE,                 ///< One channel changes
+    PATTERN_COUNT
+} bench_pattern_t;
+
+static const char *PATTERN_NAMES[PATTERN_COUNT] = { "fade", "sparse", "single" };
+
+typedef enum {
+    STRATEGY_PER_CHANNEL,
+    STRATEGY_BURST,
+    STRATEGY_BURST_GAP2,
+    STRATEGY_COUNT
+} bench_strategy_t;
+
+static const char *STRATEGY_NAMES[STRATEGY_COUNT] = { "per-chan", "burst", "burst+gap2" };
+
+static uint32_t bench_random(void)
+{
+    static uint32_t seed = 1;
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+static void bench_stage(pca9685_frame_t *frame, bench_pattern_t pattern, uint32_t step)
+{
+    uint32_t count = frame->channel_count;
+
+    switch (pattern) {
+    case PATTERN_FADE:
+        for (uint32_t ch = 0; ch < count; ch++) {
+            pca9685_frame_set(frame, ch, (uint16_t)((step * 37 + ch * 11) % (PCA9685_DUTY_MAX + 1)));
+        }
+        break;
+    case PATTERN_SPARSE:
+        for (uint32_t i = 0; i < count / 4; i++) {
+            uint32_t ch = bench_random() % count;
+            pca9685_frame_set(frame, ch, (uint16_t)(bench_random() % (PCA9685_DUTY_MAX + 1)));
+        }
+        break;
+    default:
+        pca9685_frame_set(frame, step % count, (uint16_t)((step * 97) % (PCA9685_DUTY_MAX + 1)));
+        break;
+    }
+}
+
+/**
+ * @brief Run one scenario and return frames per second (0 on a mismatch)
+ */
+static double bench_run(uint32_t channels, bench_pattern_t pattern, bench_strategy_t strategy,
+                        uint32_t scl_hz, double overhead_us, double *pack_ns)
+{
+    static mock_bus_t bus;
+    static pca9685_frame_t frame;
+    static pca9685_burst_t bursts[PCA9685_MAX_CHANNELS];
+
+    memset(&bus, 0, sizeof(bus));
+    bus.scl_hz = scl_hz;
+    bus.overhead_us = overhead_us;
+
+    pca9685_frame_init(&frame, channels, strategy == STRATEGY_BURST_GAP2 ? 2 : 0);
+    uint32_t count = pca9685_frame_build(&frame, bursts, PCA9685_MAX_CHANNELS);
+    for (uint32_t i = 0; i < count; i++) {
+        mock_bus_write(&bus, bursts[i].chip, bursts[i].data, bursts[i].length);
+    }
+    bus.busy_us = 0;
+
+    struct timespec start, end;
+    double packing_ns = 0;
+
+    for (uint32_t step = 1; step <= BENCH_FRAMES; step++) {
+        bench_stage(&frame, pattern, step);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        count = pca9685_frame_build(&frame, bursts, PCA9685_MAX_CHANNELS);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        packing_ns += (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+
+        for (uint32_t i = 0; i < count; i++) {
+            if (strategy != STRATEGY_PER_CHANNEL) {
+                mock_bus_write(&bus, bursts[i].chip, bursts[i].data, bursts[i].length);
+                continue;
+            }
+            // Split the burst into single-channel register writes
+            for (uint32_t offset = 1; offset < bursts[i].length; offset += 4) {
+                uint8_t single[5];
+                single[0] = (uint8_t)(bursts[i].data[0] + offset - 1);
+                memcpy(&single[1], &bursts[i].data[offset], 4);
+                mock_bus_write(&bus, bursts[i].chip, single, sizeof(single));
+            }
+        }
+
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            if (mock_bus_duty(&bus, ch) != frame.duty[ch]) {
+                fprintf(stderr, "Mismatch: %s/%s ch %u\n",
+                        PATTERN_NAMES[pattern], STRATEGY_NAMES[strategy], ch);
+                return 0;
+            }
+        }
+    }
+
+    *pack_ns = packing_ns / BENCH_FRAMES;
+    return bus.busy_us > 0 ? BENCH_FRAMES * 1e6 / bus.busy_us : 0;
+}
+
+/**
+ * @brief Lose a frame on the bus, recover, and compare the register file
+ *
+ * @return 0 if every channel holds its staged duty after recovery
+ */
+static int bench_bus_error(uint32_t channels)
+{
+    static mock_bus_t bus;
+    static pca9685_frame_t frame;
+    static pca9685_burst_t bursts[PCA9685_MAX_CHANNELS];
+    uint32_t count;
+    uint32_t wrong = 0;
+
+    memset(&bus, 0, sizeof(bus));
+    bus.scl_hz = 400000;
+    pca9685_frame_init(&frame, channels, 0);
+
+    bench_stage(&frame, PATTERN_FADE, 1);
+    count = pca9685_frame_build(&frame, bursts, PCA9685_MAX_CHANNELS);
+    for (uint32_t i = 0; i < count; i++) {
+        mock_bus_write(&bus, bursts[i].chip, bursts[i].data, bursts[i].length);
+    }
+
+    // The next frame is built (dirty bits cleared) but never arrives, and
+    // the chips are left in an unknown state
+    bench_stage(&frame, PATTERN_FADE, 2);
+    pca9685_frame_build(&frame, bursts, PCA9685_MAX_CHANNELS);
+    memset(bus.regs, 0xA5, sizeof(bus.regs));
+
+    // Recovery, with no new duty staged since the error
+    pca9685_frame_mark_all_dirty(&frame);
+    count = pca9685_frame_build(&frame, bursts, PCA9685_MAX_CHANNELS);
+    for (uint32_t i = 0; i < count; i++) {
+        mock_bus_write(&bus, bursts[i].chip, bursts[i].data, bursts[i].length);
+    }
+
+    for (uint32_t ch = 0; ch < channels; ch++) {
+        if (mock_bus_duty(&bus, ch) != frame.duty[ch] || frame.duty[ch] == 0) {
+            wrong++;
+        }
+    }
+
+    printf("Bus error recovery, %u channels: %u bursts, %u channels wrong: %s\n",
+           channels, count, wrong, wrong ? "FAIL" : "ok");
+    return wrong ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const uint32_t CHANNEL_COUNTS[] = { 16, 32, 64, 128 };
+    static const uint32_t SCL_RATES[] = { 400000, 1000000 };
+    double overhead_us = (argc > 1) ? atof(argv[1]) : BENCH_DEFAULT_OVERHEAD_US;
+
+    if (bench_bus_error(32) != 0) {
+        return 1;
+    }
+
+    printf("\nFrames per second on a mock bus, %.0f us driver cost per transaction\n", overhead_us);
+
+    for (size_t r = 0; r < sizeof(SCL_RATES) / sizeof(SCL_RATES[0]); r++) {
+        printf("\nSCL %u kHz\n", SCL_RATES[r] / 1000);
+        printf("%-8s %5s", "pattern", "chan");
+        for (int s = 0; s < STRATEGY_COUNT; s++) {
+            printf(" %11s", STRATEGY_NAMES[s]);
+        }
+        printf(" %10s\n", "pack[ns]");
+
+        for (int p = 0; p < PATTERN_COUNT; p++) {
+            for (size_t c = 0; c < sizeof(CHANNEL_COUNTS) / sizeof(CHANNEL_COUNTS[0]); c++) {
+                double pack_ns = 0;
+                printf("%-8s %5u", PATTERN_NAMES[p], CHANNEL_COUNTS[c]);
+                for (int s = 0; s < STRATEGY_COUNT; s++) {
+                    double fps = bench_run(CHANNEL_COUNTS[c], (bench_pattern_t)p,
+                                           (bench_strategy_t)s, SCL_RATES[r], overhead_us,
+                                           &pack_ns);
+                    if (fps == 0) {
+                        return 1;
+                    }
+                    printf(" %11.0f", fps);
+                }
+                printf(" %10.0f\n", pack_ns);
+            }
+        }
+    }
+    return 0;
+}
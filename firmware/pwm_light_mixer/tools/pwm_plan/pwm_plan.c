@@ -0,0 +1,95 @@
+/**
+ * @file pwm_plan.c
+ * @brief Host-side PWM frequency / resolution trade-off table
+ *
+ * Prints, for LEDC frequencies from 1 kHz to 100 kHz and each ESP32 clock
+ * source, the timer resolution, the frequency actually produced, the clock
+ * divider (and whether it is an integer, i.e. jitter-free), and the dither
+ * bits main/pwm_plan.c adds to reach the target effective resolution with
+ * the rate of the resulting dither pattern. Frequencies of 20 kHz and up
+ * are marked camera-safe.
+ *
+ * Ends with the best camera-safe plan (20 kHz to 40 kHz) in each speed
+ * mode.
+ *
+ * Build and run from this directory:
+ * @code
+ * cc -O2 -Wall -I../../main pwm_plan.c ../../main/pwm_plan.c ../../main/ledc_alloc.c -o pwm_plan
+ * ./pwm_plan [target_bits] [min_dither_hz]
+ * @endcode
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "pwm_plan.h"
+
+#define PLAN_DEFAULT_TARGET_BITS      12
+#define PLAN_DEFAULT_MIN_DITHER_HZ    2000
+#define PLAN_CAMERA_SAFE_MAX_HZ       40000
+
+/** Same clock list as main/output_ledc.c */
+static const ledc_alloc_clock_t CLOCKS[] = {
+    { "APB",      80000000, 0x3 },
+    { "RC_FAST",  8000000,  0x2 },
+    { "REF_TICK", 1000000,  0x3 },
+};
+
+#define CLOCK_COUNT                   (sizeof(CLOCKS) / sizeof(CLOCKS[0]))
+
+static const uint32_t FREQUENCIES[] = {
+    1000, 2000, 5000, 10000, 15000, 19531, 20000, 25000, 30000, 39062, 40000, 50000, 78125, 100000,
+};
+
+static void print_row(const ledc_alloc_clock_t *clock, uint32_t freq_hz, uint32_t target_bits,
+                      uint32_t min_dither_hz)
+{
+    // Plan against this clock alone (low speed mode accepts every clock)
+    pwm_plan_t plan;
+    if (pwm_plan_make(clock, 1, 1, freq_hz, target_bits, min_dither_hz, &plan) != 0) {
+        printf("%8u  %-8s  %s\n", freq_hz, clock->name, "unreachable");
+        return;
+    }
+
+    printf("%8u  %-8s  %7u  %4u  %9.3f  %-3s  %6u  %9u  %4u  %-3s  %s\n",
+           freq_hz, clock->name, plan.actual_hz, plan.hw_bits, plan.divider_q8 / 256.0,
+           (plan.divider_q8 & 0xFF) ? "no" : "yes", plan.dither_bits, plan.dither_hz,
+           plan.effective_bits, plan.meets_target ? "yes" : "no",
+           (plan.actual_hz >= PWM_PLAN_CAMERA_SAFE_HZ) ? "camera-safe" : "");
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t target_bits = (argc > 1) ? (uint32_t)atoi(argv[1]) : PLAN_DEFAULT_TARGET_BITS;
+    uint32_t min_dither_hz = (argc > 2) ? (uint32_t)atoi(argv[2]) : PLAN_DEFAULT_MIN_DITHER_HZ;
+
+    printf("Target %u effective bits, dither pattern >= %u Hz\n\n", target_bits, min_dither_hz);
+    printf("%8s  %-8s  %7s  %4s  %9s  %-3s  %6s  %9s  %4s  %-3s\n",
+           "freq_hz", "clock", "actual", "bits", "divider", "int", "dither", "dither_hz",
+           "eff", "ok");
+
+    for (size_t f = 0; f < sizeof(FREQUENCIES) / sizeof(FREQUENCIES[0]); f++) {
+        for (size_t c = 0; c < CLOCK_COUNT; c++) {
+            print_row(&CLOCKS[c], FREQUENCIES[f], target_bits, min_dither_hz);
+        }
+    }
+
+    printf("\nBest camera-safe plan (%u..%u Hz):\n", PWM_PLAN_CAMERA_SAFE_HZ,
+           PLAN_CAMERA_SAFE_MAX_HZ);
+    for (uint32_t mode = 0; mode < LEDC_ALLOC_MODES; mode++) {
+        pwm_plan_t plan;
+        if (pwm_plan_best(CLOCKS, CLOCK_COUNT, mode, PWM_PLAN_CAMERA_SAFE_HZ,
+                          PLAN_CAMERA_SAFE_MAX_HZ, target_bits, min_dither_hz, &plan) != 0) {
+            printf("  %s speed: none\n", (mode == 0) ? "high" : "low");
+            continue;
+        }
+
+        printf("  %s speed: %u Hz on %s, %u-bit + %u dithered = %u bits, dither %u Hz%s\n",
+               (mode == 0) ? "high" : "low", plan.actual_hz, CLOCKS[plan.clock].name,
+               plan.hw_bits, plan.dither_bits, plan.effective_bits, plan.dither_hz,
+               plan.meets_target ? "" : " (below target)");
+    }
+
+    return 0;
+}
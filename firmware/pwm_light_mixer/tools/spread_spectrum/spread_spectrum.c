@@ -0,0 +1,210 @@
+/**
+ * @file spread_spectrum.c
+ * @brief Host-side checks of the spread-spectrum frequency sweep
+ *
+ * Drives main/spread_spectrum.c for the default 5 kHz and camera-safe
+ * 25 kHz carriers and checks:
+ *
+ * - band: lowest first, edges at spread_spectrum_min_hz/max_hz, evenly spaced
+ * - invalid: too few or too many steps, a span of 100% or more and a zero
+ *   center are refused
+ * - triangle: one index per step, turning at the edges without repeating
+ *   them, back to the start after 2 x (steps - 1) steps with the edges
+ *   visited once and every other frequency twice
+ * - phase: with the sampling rule of main/current_sense.c (offsets from the
+ *   nominal period, windows widened by twice the drift at the bottom of the
+ *   band), every sampled point stays half the minimum window away from the
+ *   real phase edges at every frequency of the band; at 25 kHz the period
+ *   itself is shorter than the window, so nothing is sampled
+ *
+ * Build and run from this directory:
+ * @code
+ * cc -O2 -Wall -I../../main spread_spectrum.c ../../main/spread_spectrum.c -o spread_spectrum
+ * ./spread_spectrum
+ * @endcode
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "spread_spectrum.h"
+
+#define SIM_SPAN_PERMILLE             50         ///< CONFIG_LEDC_SPREAD_PERMILLE
+#define SIM_STEPS                     16         ///< CONFIG_LEDC_SPREAD_STEPS
+#define SIM_MIN_WINDOW_US             40         ///< CONFIG_SENSE_MIN_WINDOW_US
+#define SIM_DUTY_MAX                  65535      ///< OUTPUT_DUTY_MAX
+
+static const uint32_t SIM_CENTERS[] = { 5000, 25000 };
+
+static int sim_check(const char *name, bool ok, const char *detail)
+{
+    printf("%-10s %-5s %s\n", name, ok ? "ok" : "FAIL", detail);
+    return ok ? 0 : 1;
+}
+
+static int sim_band(uint32_t center_hz)
+{
+    spread_spectrum_t sweep;
+    uint32_t low_hz = spread_spectrum_min_hz(center_hz, SIM_SPAN_PERMILLE);
+    uint32_t high_hz = spread_spectrum_max_hz(center_hz, SIM_SPAN_PERMILLE);
+    bool ok = spread_spectrum_init(&sweep, center_hz, SIM_SPAN_PERMILLE, SIM_STEPS) == 0 &&
+              sweep.steps == SIM_STEPS && sweep.freq_hz[0] == low_hz &&
+              sweep.freq_hz[SIM_STEPS - 1] == high_hz;
+    uint32_t min_gap = UINT32_MAX;
+    uint32_t max_gap = 0;
+
+    for (uint32_t i = 1; ok && i < sweep.steps; i++) {
+        if (sweep.freq_hz[i] <= sweep.freq_hz[i - 1]) {
+            ok = false;
+            break;
+        }
+        uint32_t gap = sweep.freq_hz[i] - sweep.freq_hz[i - 1];
+        min_gap = (gap < min_gap) ? gap : min_gap;
+        max_gap = (gap > max_gap) ? gap : max_gap;
+    }
+
+    char detail[96];
+    snprintf(detail, sizeof(detail), "%lu Hz: %lu..%lu Hz, steps %lu..%lu Hz apart",
+             (unsigned long)center_hz, (unsigned long)low_hz, (unsigned long)high_hz,
+             (unsigned long)min_gap, (unsigned long)max_gap);
+    return sim_check("band", ok && max_gap - min_gap <= 1, detail);
+}
+
+static int sim_invalid(void)
+{
+    spread_spectrum_t sweep;
+    int few = spread_spectrum_init(&sweep, 5000, SIM_SPAN_PERMILLE, 1);
+    int many = spread_spectrum_init(&sweep, 5000, SIM_SPAN_PERMILLE,
+                                    SPREAD_SPECTRUM_MAX_STEPS + 1);
+    int span = spread_spectrum_init(&sweep, 5000, 1000, SIM_STEPS);
+    int zero = spread_spectrum_init(&sweep, 0, SIM_SPAN_PERMILLE, SIM_STEPS);
+    int two = spread_spectrum_init(&sweep, 5000, SIM_SPAN_PERMILLE, 2);
+
+    char detail[96];
+    snprintf(detail, sizeof(detail), "1 step %d, %d steps %d, 100%% span %d, 0 Hz %d, 2 steps %d",
+             few, SPREAD_SPECTRUM_MAX_STEPS + 1, many, span, zero, two);
+    return sim_check("invalid", few == -1 && many == -1 && span == -1 && zero == -1 &&
+                     two == 0, detail);
+}
+
+static int sim_triangle(uint32_t steps)
+{
+    spread_spectrum_t sweep;
+    uint32_t visits[SPREAD_SPECTRUM_MAX_STEPS] = {0};
+    uint32_t cycle = 2 * (steps - 1);
+    bool ok = spread_spectrum_init(&sweep, 5000, SIM_SPAN_PERMILLE, steps) == 0;
+    uint32_t start = sweep.index;
+    uint32_t previous = start;
+
+    for (uint32_t n = 0; ok && n < cycle; n++) {
+        uint32_t freq_hz = spread_spectrum_next(&sweep);
+        uint32_t index = sweep.index;
+        uint32_t distance = (index > previous) ? index - previous : previous - index;
+        if (index >= steps || distance != 1 || freq_hz != sweep.freq_hz[index]) {
+            ok = false;
+        }
+        visits[index]++;
+        previous = index;
+    }
+    ok = ok && sweep.index == start && sweep.direction == 1;
+
+    for (uint32_t i = 0; ok && i < steps; i++) {
+        if (visits[i] != ((i == 0 || i == steps - 1) ? 1u : 2u)) {
+            ok = false;
+        }
+    }
+
+    char detail[96];
+    snprintf(detail, sizeof(detail), "%lu steps: cycle of %lu, edges %lu/%lu visits, middle %lu",
+             (unsigned long)steps, (unsigned long)cycle, (unsigned long)visits[0],
+             (unsigned long)visits[steps - 1], (unsigned long)visits[steps / 2]);
+    return sim_check("triangle", ok, detail);
+}
+
+/** Distance of a point from the nearer of two edges, negative if outside */
+static int64_t sim_margin(int64_t point, int64_t start, int64_t end)
+{
+    int64_t before = point - start;
+    int64_t after = end - point;
+    return (before < after) ? before : after;
+}
+
+static int sim_phase(uint32_t center_hz)
+{
+    spread_spectrum_t sweep;
+    spread_spectrum_init(&sweep, center_hz, SIM_SPAN_PERMILLE, SIM_STEPS);
+
+    // As in current_sense_init() and current_sense_measure()
+    uint32_t period_us = 1000000 / center_hz;
+    uint32_t low_hz = spread_spectrum_min_hz(center_hz, SIM_SPAN_PERMILLE);
+    uint32_t drift_us = (1000000 + low_hz - 1) / low_hz - period_us;
+    uint32_t min_window_us = SIM_MIN_WINDOW_US + 2 * drift_us;
+
+    double worst_us = 0;
+    uint32_t sampled = 0;
+    uint32_t skipped = 0;
+    uint32_t unsafe = 0;
+
+    for (uint32_t duty = 0; duty <= SIM_DUTY_MAX; duty += 7) {
+        uint32_t on_us = (uint32_t)(((uint64_t)period_us * duty) / (SIM_DUTY_MAX + 1));
+        uint32_t off_us = period_us - on_us;
+
+        for (int phase = 0; phase < 2; phase++) {
+            uint32_t window_us = (phase == 0) ? on_us : off_us;
+            if (window_us < min_window_us) {
+                skipped++;
+                continue;
+            }
+            sampled++;
+
+            // Offset from the nominal period, edges from the real one (in ns)
+            int64_t offset_ns = 1000LL * ((phase == 0) ? on_us / 2 : on_us + off_us / 2);
+            for (uint32_t i = 0; i < sweep.steps; i++) {
+                int64_t real_ns = 1000000000LL / sweep.freq_hz[i];
+                int64_t edge_ns = real_ns * duty / (SIM_DUTY_MAX + 1);
+                int64_t margin_ns = (phase == 0) ? sim_margin(offset_ns, 0, edge_ns) :
+                                                   sim_margin(offset_ns, edge_ns, real_ns);
+                if ((sampled == 1 && i == 0) || margin_ns / 1000.0 < worst_us) {
+                    worst_us = margin_ns / 1000.0;
+                }
+                if (margin_ns < 1000LL * SIM_MIN_WINDOW_US / 2) {
+                    unsafe++;
+                }
+            }
+        }
+    }
+
+    char closest[32] = "-";
+    if (sampled > 0) {
+        snprintf(closest, sizeof(closest), "%.1f us", worst_us);
+    }
+
+    char detail[128];
+    snprintf(detail, sizeof(detail),
+             "%lu Hz: drift %lu us, window >= %lu us, %lu sampled, %lu skipped, closest edge %s",
+             (unsigned long)center_hz, (unsigned long)drift_us, (unsigned long)min_window_us,
+             (unsigned long)sampled, (unsigned long)skipped, closest);
+    // A carrier whose whole period is below the window is never sampled
+    return sim_check("phase", unsafe == 0 && (sampled > 0 || period_us < min_window_us),
+                     detail);
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    for (size_t i = 0; i < sizeof(SIM_CENTERS) / sizeof(SIM_CENTERS[0]); i++) {
+        failures += sim_band(SIM_CENTERS[i]);
+    }
+    failures += sim_invalid();
+    failures += sim_triangle(2);
+    failures += sim_triangle(SIM_STEPS);
+    failures += sim_triangle(SPREAD_SPECTRUM_MAX_STEPS);
+    for (size_t i = 0; i < sizeof(SIM_CENTERS) / sizeof(SIM_CENTERS[0]); i++) {
+        failures += sim_phase(SIM_CENTERS[i]);
+    }
+
+    return failures ? 1 : 0;
+}
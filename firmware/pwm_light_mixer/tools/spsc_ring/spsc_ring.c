@@ -0,0 +1,327 @@
+/**
+ * @file spsc_ring.c
+ * @brief Host-side check and latency comparison of the cross-core frame handoff
+ *
+ * First streams sequence-numbered items through main/spsc_ring.c between
+ * two threads pinned to different CPUs and checks that none is lost,
+ * duplicated or reordered.
+ *
+ * Then replays the output path of main/output.c both ways, with busy
+ * threads loading every CPU the way Wi-Fi or DMX traffic would load the
+ * input core:
+ * - inline: the producer (the main loop on the input core) stages and
+ *   commits the frame itself under the output mutex, competing with
+ *   deferred commits from a second thread
+ * - ring: the producer copies the frame into the ring and wakes the
+ *   output thread (the output task on the output core), which stages the
+ *   newest frame and commits
+ *
+ * Reports per mode how long the producer was held up and the delay from
+ * staging to the end of the commit (mean, 99th percentile, worst).
+ *
+ * Build and run from this directory:
+ * @code
+ * cc -O2 -Wall -pthread -I../../main spsc_ring.c ../../main/spsc_ring.c -o spsc_ring
+ * ./spsc_ring [load threads] [commit time in us]
+ * @endcode
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <unistd.h>
+
+#include "spsc_ring.h"
+
+#define CHECK_ITEMS                   1000000
+#define CHECK_DEPTH                   64
+#define RUN_FRAMES                    4000
+#define RUN_FRAME_INTERVAL_US         500        ///< Fast encoder spin
+#define RUN_DEFERRED_INTERVAL_US      5000       ///< 200 Hz deferred output (PCA9685)
+#define RUN_RING_DEPTH                8          ///< CONFIG_OUTPUT_RING_DEPTH
+#define DEFAULT_COMMIT_US             150        ///< One frame on the I2C bus
+#define INPUT_CPU                     0
+#define OUTPUT_CPU                    1
+
+typedef struct {
+    int64_t staged_ns;
+    uint32_t seq;
+    uint16_t duty[8];
+} frame_t;
+
+static volatile bool running;
+static uint32_t commit_us = DEFAULT_COMMIT_US;
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void spin_us(uint32_t us)
+{
+    int64_t end = now_ns() + (int64_t)us * 1000;
+    while (now_ns() < end) {
+    }
+}
+
+static void pin(int cpu)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % sysconf(_SC_NPROCESSORS_ONLN), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+/**
+ * ============================================================================
+ * ORDERING CHECK
+ * ============================================================================
+ */
+
+static spsc_ring_t check_ring;
+static uint32_t check_storage[CHECK_DEPTH];
+
+static void *check_producer(void *arg)
+{
+    pin(INPUT_CPU);
+    for (uint32_t seq = 0; seq < CHECK_ITEMS; ) {
+        if (spsc_ring_push(&check_ring, &seq) == 0) {
+            seq++;
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static int run_check(void)
+{
+    pthread_t producer;
+    uint32_t expected = 0;
+    uint32_t errors = 0;
+    uint32_t item;
+
+    spsc_ring_init(&check_ring, check_storage, sizeof(uint32_t), CHECK_DEPTH);
+    pin(OUTPUT_CPU);
+    pthread_create(&producer, NULL, check_producer, NULL);
+
+    while (expected < CHECK_ITEMS) {
+        if (spsc_ring_pop(&check_ring, &item) != 0) {
+            sched_yield();
+            continue;
+        }
+        if (item != expected) {
+            errors++;
+        }
+        expected = item + 1;
+    }
+    pthread_join(producer, NULL);
+
+    printf("ordering: %u items through a %u-slot ring, %u out of sequence: %s\n\n",
+           CHECK_ITEMS, CHECK_DEPTH, errors, errors ? "FAIL" : "ok");
+    return errors ? -1 : 0;
+}
+
+/**
+ * ============================================================================
+ * HANDOFF LATENCY
+ * ============================================================================
+ */
+
+typedef struct {
+    uint32_t stage_us[RUN_FRAMES];
+    uint32_t latency_us[RUN_FRAMES];
+    uint32_t frames;
+    uint32_t committed;
+    uint32_t coalesced;
+    uint32_t overflows;
+} run_stats_t;
+
+static pthread_mutex_t output_mutex = PTHREAD_MUTEX_INITIALIZER;
+static spsc_ring_t frame_ring;
+static frame_t frame_storage[RUN_RING_DEPTH];
+static sem_t output_wake;
+static run_stats_t stats;
+
+static void commit(const frame_t *frame)
+{
+    spin_us(commit_us);
+    if (frame != NULL && frame->seq < RUN_FRAMES) {
+        stats.latency_us[frame->seq] = (uint32_t)((now_ns() - frame->staged_ns) / 1000);
+        stats.committed++;
+    }
+}
+
+static void *load_thread(void *arg)
+{
+    pin((int)(intptr_t)arg);
+    while (running) {
+        sched_yield();
+    }
+    return NULL;
+}
+
+/** Deferred commits of the slow outputs, from the commit timer */
+static void *deferred_thread(void *arg)
+{
+    pin(INPUT_CPU);
+    while (running) {
+        usleep(RUN_DEFERRED_INTERVAL_US);
+        pthread_mutex_lock(&output_mutex);
+        commit(NULL);
+        pthread_mutex_unlock(&output_mutex);
+    }
+    return NULL;
+}
+
+/** Output task: stage the newest queued frame and commit */
+static void *output_thread(void *arg)
+{
+    frame_t frame;
+    frame_t newest;
+
+    pin(OUTPUT_CPU);
+    while (running) {
+        sem_wait(&output_wake);
+
+        uint32_t popped = 0;
+        while (spsc_ring_pop(&frame_ring, &frame) == 0) {
+            newest = frame;
+            popped++;
+        }
+        if (popped > 0) {
+            stats.coalesced += popped - 1;
+            commit(&newest);
+        }
+    }
+    return NULL;
+}
+
+static void run_mode(bool use_ring, uint32_t load_threads)
+{
+    pthread_t loads[64];
+    pthread_t deferred;
+    pthread_t output;
+
+    memset(&stats, 0, sizeof(stats));
+    spsc_ring_init(&frame_ring, frame_storage, sizeof(frame_t), RUN_RING_DEPTH);
+    sem_init(&output_wake, 0, 0);
+    running = true;
+
+    for (uint32_t i = 0; i < load_threads; i++) {
+        pthread_create(&loads[i], NULL, load_thread, (void *)(intptr_t)i);
+    }
+    if (use_ring) {
+        pthread_create(&output, NULL, output_thread, NULL);
+    } else {
+        pthread_create(&deferred, NULL, deferred_thread, NULL);
+    }
+
+    pin(INPUT_CPU);
+    for (uint32_t seq = 0; seq < RUN_FRAMES; seq++) {
+        frame_t frame = { .seq = seq };
+        int64_t start_ns = now_ns();
+        frame.staged_ns = start_ns;
+
+        if (use_ring) {
+            if (spsc_ring_push(&frame_ring, &frame) != 0) {
+                stats.overflows++;
+            }
+            sem_post(&output_wake);
+        } else {
+            pthread_mutex_lock(&output_mutex);
+            commit(&frame);
+            pthread_mutex_unlock(&output_mutex);
+        }
+
+        stats.stage_us[stats.frames++] = (uint32_t)((now_ns() - start_ns) / 1000);
+        usleep(RUN_FRAME_INTERVAL_US);
+    }
+
+    running = false;
+    if (use_ring) {
+        sem_post(&output_wake);
+        pthread_join(output, NULL);
+    } else {
+        pthread_join(deferred, NULL);
+    }
+    for (uint32_t i = 0; i < load_threads; i++) {
+        pthread_join(loads[i], NULL);
+    }
+    sem_destroy(&output_wake);
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Mean, 99th percentile and worst of the non-zero samples
+ */
+static void print_distribution(const char *label, uint32_t *values, uint32_t count)
+{
+    uint32_t n = 0;
+    uint64_t sum = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (values[i] > 0) {
+            values[n++] = values[i];
+            sum += values[i];
+        }
+    }
+    if (n == 0) {
+        printf("  %-18s %8s\n", label, "-");
+        return;
+    }
+
+    qsort(values, n, sizeof(uint32_t), compare_u32);
+    printf("  %-18s %8.1f %8u %8u\n", label, (double)sum / n, values[(n * 99) / 100],
+           values[n - 1]);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t load_threads = (argc > 1) ? (uint32_t)atoi(argv[1])
+                                       : (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    if (argc > 2) {
+        commit_us = (uint32_t)atoi(argv[2]);
+    }
+    if (load_threads > 64) {
+        load_threads = 64;
+    }
+
+    if (run_check() != 0) {
+        return 1;
+    }
+
+    printf("%u frames every %u us, %u us per commit, %u load threads\n\n", RUN_FRAMES,
+           RUN_FRAME_INTERVAL_US, commit_us, load_threads);
+    printf("  %-18s %8s %8s %8s\n", "[us]", "mean", "p99", "max");
+
+    for (int mode = 0; mode < 2; mode++) {
+        bool use_ring = (mode == 1);
+
+        run_mode(use_ring, load_threads);
+        printf("%s\n", use_ring ? "ring (output core)" : "inline (input core)");
+        print_distribution("producer held", stats.stage_us, stats.frames);
+        print_distribution("stage to commit", stats.latency_us, RUN_FRAMES);
+        if (use_ring) {
+            printf("  %u committed, %u coalesced, %u overflows\n", stats.committed,
+                   stats.coalesced, stats.overflows);
+        }
+    }
+
+    return 0;
+}
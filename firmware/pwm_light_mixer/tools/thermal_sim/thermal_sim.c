@@ -0,0 +1,152 @@
+/**
+ * @file thermal_sim.c
+ * @brief Host-side thermal derating simulation
+ *
+ * Drives the firmware derating curve (main/thermal_derate.c) with a
+ * scripted temperature profile, one update per simulated sampling period,
+ * and prints temperature and output level. Used to tune the curve,
+ * hysteresis and slew limit without heating a fixture.
+ *
+ * Build and run from this directory:
+ * @code
+ * cc -O2 -Wall -I../../main thermal_sim.c ../../main/thermal_derate.c -o thermal_sim
+ * ./thermal_sim [profile.txt]
+ * @endcode
+ *
+ * A profile file holds "<seconds> <temperature in 0.1 C>" keyframes, one
+ * per line; temperature is linearly interpolated between keyframes. Without
+ * a file, a built-in warm-up / overheat / cool-down cycle is used.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "thermal_derate.h"
+
+/**
+ * ============================================================================
+ * SIMULATION PARAMETERS (mirror main/config.h)
+ * ============================================================================
+ */
+
+#define SIM_PERIOD_S                  1          ///< CONFIG_THERMAL_PERIOD_MS
+#define SIM_PRINT_EVERY_S             30
+#define SIM_MAX_KEYFRAMES             256
+
+typedef struct {
+    uint32_t time_s;
+    int32_t temp_dc;
+} sim_keyframe_t;
+
+static const sim_keyframe_t DEFAULT_PROFILE[] = {
+    {    0, 250 },      // Cold start
+    {  900, 600 },      // Warm-up under full output
+    { 1500, 820 },      // Summer afternoon overheat
+    { 2400, 840 },
+    { 3000, 680 },      // Cooling, around the hysteresis band
+    { 3300, 640 },
+    { 3600, 690 },
+    { 4500, 400 },      // Evening
+};
+
+static sim_keyframe_t profile[SIM_MAX_KEYFRAMES];
+static uint32_t profile_count;
+
+static void sim_load_profile(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot open profile %s\n", path);
+        exit(1);
+    }
+
+    unsigned long time_s;
+    long temp_dc;
+    while (profile_count < SIM_MAX_KEYFRAMES && fscanf(file, "%lu %ld", &time_s, &temp_dc) == 2) {
+        profile[profile_count].time_s = (uint32_t)time_s;
+        profile[profile_count].temp_dc = (int32_t)temp_dc;
+        profile_count++;
+    }
+    fclose(file);
+}
+
+/**
+ * @brief Temperature at a time, interpolated between keyframes
+ */
+static int32_t sim_temperature_at(uint32_t time_s)
+{
+    for (uint32_t i = 1; i < profile_count; i++) {
+        if (time_s <= profile[i].time_s) {
+            const sim_keyframe_t *a = &profile[i - 1];
+            const sim_keyframe_t *b = &profile[i];
+            int32_t span = (int32_t)(b->time_s - a->time_s);
+            if (span == 0) {
+                return b->temp_dc;
+            }
+            return a->temp_dc + (b->temp_dc - a->temp_dc) * (int32_t)(time_s - a->time_s) / span;
+        }
+    }
+    return profile[profile_count - 1].temp_dc;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        sim_load_profile(argv[1]);
+    } else {
+        for (size_t i = 0; i < sizeof(DEFAULT_PROFILE) / sizeof(DEFAULT_PROFILE[0]); i++) {
+            profile[profile_count++] = DEFAULT_PROFILE[i];
+        }
+    }
+
+    if (profile_count == 0) {
+        fprintf(stderr, "Empty profile\n");
+        return 1;
+    }
+
+    // Firmware defaults from config.h
+    const thermal_derate_config_t config = {
+        .start_dc = 650,
+        .full_dc = 850,
+        .hysteresis_dc = 50,
+        .min_level_q16 = (30 * THERMAL_DERATE_UNITY_Q16) / 100,
+        .max_step_q16 = (2 * THERMAL_DERATE_UNITY_Q16) / 100,
+    };
+
+    thermal_derate_t derate;
+    thermal_derate_init(&derate, &config);
+
+    uint32_t end_s = profile[profile_count - 1].time_s;
+    uint32_t min_level = THERMAL_DERATE_UNITY_Q16;
+    uint32_t direction_changes = 0;
+    int last_direction = 0;
+    uint32_t previous = derate.level_q16;
+
+    printf("%8s %8s %8s\n", "time[s]", "temp[C]", "level[%]");
+
+    for (uint32_t t = 0; t <= end_s; t += SIM_PERIOD_S) {
+        int32_t temp = sim_temperature_at(t);
+        uint32_t level = thermal_derate_update(&derate, temp);
+
+        int direction = (level > previous) - (level < previous);
+        if (direction != 0 && last_direction != 0 && direction != last_direction) {
+            direction_changes++;
+        }
+        if (direction != 0) {
+            last_direction = direction;
+        }
+        previous = level;
+        if (level < min_level) {
+            min_level = level;
+        }
+
+        if (t % SIM_PRINT_EVERY_S == 0) {
+            printf("%8u %8.1f %8.1f\n", t, temp / 10.0, level * 100.0 / THERMAL_DERATE_UNITY_Q16);
+        }
+    }
+
+    printf("\nMinimum level %.1f%%, level direction reversals %u\n",
+           min_level * 100.0 / THERMAL_DERATE_UNITY_Q16, direction_changes);
+    return 0;
+}
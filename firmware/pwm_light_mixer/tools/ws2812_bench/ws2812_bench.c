@@ -0,0 +1,136 @@
+/**
+ * @file ws2812_bench.c
+ * @brief Host-side WS2812 frame time benchmark
+ *
+ * Times the firmware symbol encoder (main/ws2812_encoder.c) against a
+ * straightforward bit-by-bit encoder for 60 to 600 pixels, checks that
+ * both produce identical symbols, and combines the encode time with the
+ * wire time of a frame to show the frame rate reachable with one symbol
+ * buffer (encode, then send) and with two (encode while sending).
+ *
+ * Build and run from this directory:
+ * @code
+ * cc -O2 -Wall -I../../main ws2812_bench.c ../../main/ws2812_encoder.c -o ws2812_bench
+ * ./ws2812_bench [cpu scale]
+ * @endcode
+ *
+ * Encode times are measured on the host; the optional cpu scale factor
+ * multiplies them to approximate a slower target (e.g. 8 for an ESP32 at
+ * 240 MHz against a desktop core).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "ws2812_encoder.h"
+
+/**
+ * ============================================================================
+ * BENCHMARK PARAMETERS (mirror main/config.h)
+ * ============================================================================
+ */
+
+#define BENCH_BYTES_PER_PIXEL         3
+#define BENCH_MAX_PIXELS              600
+#define BENCH_MAX_SYMBOLS             (BENCH_MAX_PIXELS * BENCH_BYTES_PER_PIXEL * WS2812_SYMBOLS_PER_BYTE + 1)
+#define BENCH_ITERATIONS              2000
+
+static const ws2812_timing_t TIMING = {
+    .resolution_hz = 10000000,
+    .t0h_ns = 400,
+    .t0l_ns = 850,
+    .t1h_ns = 800,
+    .t1l_ns = 450,
+    .reset_us = 300,
+};
+
+static ws2812_encoder_t encoder;
+static uint8_t pixels[BENCH_MAX_PIXELS * BENCH_BYTES_PER_PIXEL];
+static ws2812_symbol_t lut_symbols[BENCH_MAX_SYMBOLS];
+static ws2812_symbol_t bit_symbols[BENCH_MAX_SYMBOLS];
+
+/**
+ * @brief Reference encoder: test every bit of every byte
+ */
+static size_t bench_encode_bitwise(const uint8_t *bytes, size_t count, ws2812_symbol_t *out)
+{
+    ws2812_symbol_t zero = encoder.lut[0][0];
+    ws2812_symbol_t one = encoder.lut[0xFF][0];
+    size_t n = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        for (int bit = 7; bit >= 0; bit--) {
+            out[n++] = (bytes[i] >> bit) & 1 ? one : zero;
+        }
+    }
+    out[n++] = encoder.reset;
+    return n;
+}
+
+static double bench_now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+    static const uint32_t PIXEL_COUNTS[] = { 60, 120, 300, 600 };
+    double cpu_scale = (argc > 1) ? atof(argv[1]) : 1.0;
+    volatile ws2812_symbol_t sink = 0;
+
+    ws2812_encoder_init(&encoder, &TIMING);
+
+    for (size_t i = 0; i < sizeof(pixels); i++) {
+        pixels[i] = (uint8_t)(i * 37 + 11);
+    }
+
+    double bit_period_us = (TIMING.t0h_ns + TIMING.t0l_ns) / 1000.0;
+
+    printf("Frame time per strip length (encode times x%.1f)\n\n", cpu_scale);
+    printf("%6s %10s %10s %10s %10s %10s %10s\n", "pixels", "bitwise", "table",
+           "wire", "fps 1-buf", "fps 2-buf", "buffer");
+    printf("%6s %10s %10s %10s %10s %10s %10s\n", "", "[us]", "[us]", "[us]", "", "", "[bytes]");
+
+    for (size_t p = 0; p < sizeof(PIXEL_COUNTS) / sizeof(PIXEL_COUNTS[0]); p++) {
+        size_t bytes = PIXEL_COUNTS[p] * BENCH_BYTES_PER_PIXEL;
+
+        double start = bench_now_ns();
+        for (int i = 0; i < BENCH_ITERATIONS; i++) {
+            pixels[0] = (uint8_t)i;
+            bench_encode_bitwise(pixels, bytes, bit_symbols);
+            sink ^= bit_symbols[i % bytes];
+        }
+        double bitwise_us = (bench_now_ns() - start) / BENCH_ITERATIONS / 1000.0 * cpu_scale;
+
+        start = bench_now_ns();
+        size_t count = 0;
+        for (int i = 0; i < BENCH_ITERATIONS; i++) {
+            pixels[0] = (uint8_t)i;
+            count = ws2812_encoder_encode(&encoder, pixels, bytes, lut_symbols);
+            sink ^= lut_symbols[i % bytes];
+        }
+        double table_us = (bench_now_ns() - start) / BENCH_ITERATIONS / 1000.0 * cpu_scale;
+
+        if (count != bench_encode_bitwise(pixels, bytes, bit_symbols) ||
+            memcmp(lut_symbols, bit_symbols, count * sizeof(ws2812_symbol_t)) != 0) {
+            fprintf(stderr, "Encoder mismatch at %u pixels\n", PIXEL_COUNTS[p]);
+            return 1;
+        }
+
+        double wire_us = bytes * 8 * bit_period_us + TIMING.reset_us;
+        double single_fps = 1e6 / (wire_us + table_us);
+        double double_fps = 1e6 / (wire_us > table_us ? wire_us : table_us);
+
+        printf("%6u %10.1f %10.1f %10.0f %10.1f %10.1f %10zu\n", PIXEL_COUNTS[p],
+               bitwise_us, table_us, wire_us, single_fps, double_fps,
+               count * sizeof(ws2812_symbol_t));
+    }
+
+    printf("\nSymbol table: %zu bytes\n", sizeof(encoder.lut));
+    return sink == 0xFFFFFFFFu;
+}